@@ -0,0 +1,86 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+#include <string>
+#include <vector>
+
+#include "pink/include/redis_parser.h"
+#include "pink/src/resp_scan.h"
+
+using namespace pink;
+
+static const char* kKernelNames[] = {"scalar", "sse4.2", "avx2"};
+
+static uint64_t NowMicros() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return static_cast<uint64_t>(tv.tv_sec) * 1000000 + tv.tv_usec;
+}
+
+static int CountCommands(RedisParser* parser,
+                         const std::vector<RedisCmdArgsViewType>& argvs) {
+  *static_cast<size_t*>(parser->data) += argvs.size();
+  return 0;
+}
+
+// A pipelined batch of SETs with values of value_len bytes
+static std::string MultiBulkInput(int commands, int value_len) {
+  std::string value(value_len, 'v');
+  std::string input;
+  for (int i = 0; i < commands; i++) {
+    std::string key = "key:" + std::to_string(i);
+    input += "*3\r\n$3\r\nSET\r\n$" + std::to_string(key.size()) + "\r\n" +
+             key + "\r\n$" + std::to_string(value.size()) + "\r\n" + value +
+             "\r\n";
+  }
+  return input;
+}
+
+static std::string InlineInput(int commands, int value_len) {
+  std::string value(value_len, 'v');
+  std::string input;
+  for (int i = 0; i < commands; i++) {
+    input += "SET key:" + std::to_string(i) + " " + value + "\r\n";
+  }
+  return input;
+}
+
+static void Run(const char* name, const std::string& input, int rounds) {
+  for (int kernel = kRespScanScalar; kernel <= kRespScanAVX2; kernel++) {
+    if (SetRespScanKernel(static_cast<RespScanKernel>(kernel)) != kernel) {
+      continue;
+    }
+    RedisParserSettings settings;
+    settings.CompleteView = CountCommands;
+    RedisParser parser;
+    parser.RedisParserInit(REDIS_PARSER_REQUEST, settings);
+    size_t commands = 0;
+    parser.data = &commands;
+
+    uint64_t start = NowMicros();
+    for (int i = 0; i < rounds; i++) {
+      int parsed_len = 0;
+      parser.ProcessInputBufferInPlace(input.data(), input.size(),
+                                       &parsed_len);
+    }
+    uint64_t micros = NowMicros() - start;
+    if (micros == 0) {
+      micros = 1;
+    }
+    double mb = static_cast<double>(input.size()) * rounds / (1024 * 1024);
+    printf("%-24s %-8s %8.1f MB/s %8.2f Mcmd/s\n", name, kKernelNames[kernel],
+           mb * 1000000 / micros,
+           static_cast<double>(commands) / micros);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  int rounds = argc > 1 ? atoi(argv[1]) : 200;
+
+  Run("multibulk 16B values", MultiBulkInput(10000, 16), rounds);
+  Run("multibulk 1KB values", MultiBulkInput(1000, 1024), rounds);
+  Run("inline 16B values", InlineInput(10000, 16), rounds);
+  Run("inline 1KB values", InlineInput(1000, 1024), rounds);
+  return 0;
+}
@@ -80,6 +80,19 @@ class PinkConn : public std::enable_shared_from_this<PinkConn> {
     return is_reply_;
   }
 
+  /*
+   * Set while another thread produces the replies of the last requests,
+   * see RedisConn::NotifyEpoll(). The worker thread does not poll the
+   * connection until it is notified.
+   */
+  void set_is_awaiting_reply(const bool is_awaiting_reply) {
+    is_awaiting_reply_ = is_awaiting_reply;
+  }
+
+  bool is_awaiting_reply() const {
+    return is_awaiting_reply_;
+  }
+
   bool IsClose() { return close_; }
   // This can be used by the application
   void SetClose(bool close) { close_ = close; }
@@ -118,6 +131,7 @@ class PinkConn : public std::enable_shared_from_this<PinkConn> {
   int fd_;
   std::string ip_port_;
   bool is_reply_;
+  bool is_awaiting_reply_;
   bool is_writable_;
   bool close_;
   struct timeval last_interaction_;
@@ -42,6 +42,8 @@ enum NotifyType {
   kNotiEpolloutAndEpollin = 4,
   kNotiWrite = 5,
   kNotiWait = 6,
+  // Only wakes the thread to serve the handed over connections
+  kNotiHandoff = 7,
 };
 
 enum EventStatus {
@@ -50,6 +52,15 @@ enum EventStatus {
   kWriteable = 2,
 };
 
+/*
+ * How the event loops wait for fds to become ready, see
+ * ServerThread::SetPollBackend()
+ */
+enum PollBackend {
+  kPollEpoll = 0,
+  kPollIoUring = 1,
+};
+
 enum ConnStatus {
   kHeader = 0,
   kPacket = 1,
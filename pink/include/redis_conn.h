@@ -14,14 +14,27 @@
 #include "pink/include/pink_define.h"
 #include "pink/include/pink_conn.h"
 #include "pink/include/redis_parser.h"
+#include "pink/include/resp_writer.h"
 
 namespace pink {
 
 typedef std::vector<std::string> RedisCmdArgsType;
 
+/*
+ * kSynchronous:  DealMessage() is called for every parsed command.
+ * kAsynchronous: all commands parsed from one read are handed to
+ *                ProcessRedisCmds(), which may pass them on to another
+ *                thread. That thread appends their replies to the response
+ *                in request order and then calls NotifyEpoll(). The
+ *                connection is neither read nor written until then.
+ * kPipelined:    all commands parsed from one read are handed to
+ *                ProcessRedisCmds() at once, which must append their
+ *                replies to the response in request order before returning.
+ */
 enum HandleType {
   kSynchronous,
-  kAsynchronous
+  kAsynchronous,
+  kPipelined
 };
 
 class RedisConn: public PinkConn {
@@ -42,31 +55,97 @@ class RedisConn: public PinkConn {
   void SetHandleType(const HandleType& handle_type);
   HandleType GetHandleType();
 
+  /*
+   * Parse requests in place in the read buffer. The commands are then
+   * handed to DealMessageView() and ProcessRedisCmdViews() instead, with
+   * arguments pointing into the read buffer. They stay valid until the
+   * connection reads again, which is not before the reply of a complete
+   * read was sent. Must be called before the first request is read.
+   */
+  void SetParseInPlace(bool parse_in_place);
+
+  /*
+   * Streams the last argument of a command that is longer than threshold
+   * bytes to DealBulkChunk() as it is read, if StartBulkStream() accepts
+   * the command, instead of keeping it in the read buffer as a whole. The
+   * command is then handled as usual, with an empty argument in place of
+   * the streamed one. Only when parsing in place, and only for the first
+   * command of a read. 0, the default, disables streaming.
+   */
+  void SetBulkStreamThreshold(long threshold);
+
+  // Unless kSynchronous, the default calls DealMessage() for every command
   virtual void ProcessRedisCmds(const std::vector<RedisCmdArgsType>& argvs, bool async, std::string* response);
+  /*
+   * Hands the connection back to its worker thread once the replies of
+   * the commands passed on in kAsynchronous mode are in the response. The
+   * worker thread closes the connection instead if success is false.
+   */
   void NotifyEpoll(bool success);
 
   virtual int DealMessage(const RedisCmdArgsType& argv, std::string* response) = 0;
 
+  // The defaults copy the arguments and call the functions above
+  virtual void ProcessRedisCmdViews(const std::vector<RedisCmdArgsViewType>& argvs, bool async, std::string* response);
+  virtual int DealMessageView(const RedisCmdArgsViewType& argv, std::string* response);
+
+  // leading_args are the arguments before the streamed one, the default declines
+  virtual bool StartBulkStream(const RedisCmdArgsViewType& leading_args, long bulk_len);
+  /*
+   * Takes the next part of the streamed argument, which is only valid
+   * during the call. Returns 0 to go on reading and -1 to close the
+   * connection. In kAsynchronous mode, a part that is not the last may be
+   * passed on to another thread by returning 1; the connection is then not
+   * read again before that thread calls NotifyEpoll().
+   */
+  virtual int DealBulkChunk(std::string_view chunk, bool last);
+
+  /*
+   * Called in kAsynchronous mode once the response was written completely.
+   * Returning true passes the connection on to another thread, which
+   * appends the next part of the reply to the response and then calls
+   * NotifyEpoll(); the connection is not read meanwhile. So a large reply
+   * can be produced while it is sent. The default returns false.
+   */
+  virtual bool ContinueReply();
+
+ protected:
+  /*
+   * The reply of the connection. The response strings handed to the
+   * functions above are its buffer, so replies can be built through
+   * either of them.
+   */
+  RespWriter* resp_writer() {
+    return &response_;
+  }
+
  private:
   static int ParserDealMessageCb(RedisParser* parser, const RedisCmdArgsType& argv);
   static int ParserCompleteCb(RedisParser* parser, const std::vector<RedisCmdArgsType>& argvs);
+  static int ParserDealMessageViewCb(RedisParser* parser, const RedisCmdArgsViewType& argv);
+  static int ParserCompleteViewCb(RedisParser* parser, const std::vector<RedisCmdArgsViewType>& argvs);
+  static bool ParserStartBulkStreamCb(RedisParser* parser, const RedisCmdArgsViewType& leading_args, long bulk_len);
+  static int ParserDealBulkChunkCb(RedisParser* parser, std::string_view chunk, bool last);
   ReadStatus ParseRedisParserStatus(RedisParserStatus status);
 
   HandleType handle_type_;
+  bool parse_in_place_;
 
   char* rbuf_;
   int rbuf_len_;
   int rbuf_max_len_;
   int msg_peak_;
   int command_len_;
+  // Input before the incomplete command, dropped before the next read
+  int consumed_len_;
 
-  uint32_t wbuf_pos_;
-  std::string response_;
+  RespWriter response_;
 
   // For Redis Protocol parser
   int last_read_pos_;
   RedisParser redis_parser_;
   long bulk_len_;
+  long bulk_end_;
 };
 
 }  // namespace pink
@@ -8,6 +8,7 @@
 
 #include "pink/include/pink_define.h"
 
+#include <string_view>
 #include <vector>
 
 #define REDIS_PARSER_REQUEST 1
@@ -18,8 +19,17 @@ namespace pink {
 class RedisParser;
 
 typedef std::vector<std::string> RedisCmdArgsType;
+/*
+ * Arguments that point into the input buffer, see
+ * ProcessInputBufferInPlace().
+ */
+typedef std::vector<std::string_view> RedisCmdArgsViewType;
 typedef int (*RedisParserDataCb) (RedisParser*, const RedisCmdArgsType&);
 typedef int (*RedisParserMultiDataCb) (RedisParser*, const std::vector<RedisCmdArgsType>&);
+typedef int (*RedisParserDataViewCb) (RedisParser*, const RedisCmdArgsViewType&);
+typedef int (*RedisParserMultiDataViewCb) (RedisParser*, const std::vector<RedisCmdArgsViewType>&);
+typedef bool (*RedisParserBulkStartCb) (RedisParser*, const RedisCmdArgsViewType&, long);
+typedef int (*RedisParserBulkChunkCb) (RedisParser*, std::string_view, bool);
 typedef int (*RedisParserCb) (RedisParser*);
 typedef int RedisParserType;
 
@@ -43,9 +53,25 @@ enum RedisParserError {
 struct RedisParserSettings {
   RedisParserDataCb DealMessage;
   RedisParserMultiDataCb Complete;
+  // Used instead of the two above by ProcessInputBufferInPlace()
+  RedisParserDataViewCb DealMessageView;
+  RedisParserMultiDataViewCb CompleteView;
+  /*
+   * Streaming of large arguments when parsing in place, see
+   * set_bulk_stream_threshold(). StartBulkStream gets the arguments before
+   * the large one and its length and returns true to take it in parts.
+   * DealBulkChunk then gets each part as it is parsed, the last one with
+   * the flag set, and returns non-zero on error.
+   */
+  RedisParserBulkStartCb StartBulkStream;
+  RedisParserBulkChunkCb DealBulkChunk;
   RedisParserSettings() {
     DealMessage = NULL;
     Complete = NULL;
+    DealMessageView = NULL;
+    CompleteView = NULL;
+    StartBulkStream = NULL;
+    DealBulkChunk = NULL;
   }
 };
 
@@ -54,9 +80,40 @@ class RedisParser {
   RedisParser();
   RedisParserStatus RedisParserInit(RedisParserType type, const RedisParserSettings& settings);
   RedisParserStatus ProcessInputBuffer(const char* input_buf, int length, int* parsed_len);
+  /*
+   * Parses without copying the input. The arguments are handed to
+   * DealMessageView and CompleteView as views into input_buf.
+   *
+   * The caller must keep the input that was not consumed: when a command
+   * is incomplete, the commands before it are completed, parsed_len is
+   * the input before it and the next call must pass the rest of the input
+   * followed by the newly read data. The input may have been moved in
+   * between, parsing resumes where the last call stopped.
+   *
+   * While an argument is streamed, parsed_len is the input handed to
+   * DealBulkChunk so far instead, which the next call must not pass again.
+   */
+  RedisParserStatus ProcessInputBufferInPlace(const char* input_buf, int length, int* parsed_len);
+  /*
+   * The last argument of a command that is longer than threshold bytes is
+   * streamed if StartBulkStream accepts it and the command is the first
+   * in the input, so the input before it can be dropped. The command is
+   * then completed with an empty argument in its place. 0, the default,
+   * disables streaming.
+   */
+  void set_bulk_stream_threshold(long threshold) {
+    bulk_stream_threshold_ = threshold;
+  }
   long get_bulk_len() {
     return bulk_len_;
   }
+  // Input length that holds the bulk string being parsed in place, -1 if none
+  long get_bulk_end() {
+    if (bulk_len_ == -1 || bulk_stream_remain_ != -1) {
+      return -1;
+    }
+    return cur_pos_ + bulk_len_ + 2;
+  }
   RedisParserError get_error_code() {
     return error_code_;
   }
@@ -66,6 +123,12 @@ class RedisParser {
   void PrintCurrentStatus();
 
   void CacheHalfArgv();
+  void GetArgViews(size_t begin, size_t end, RedisCmdArgsViewType* argv);
+  int DeliverCommand();
+  int CompleteCommands();
+  int CompleteBeforeHalfCommand();
+  bool StartBulkStream();
+  RedisParserStatus ProcessBulkStream();
   int FindNextSeparators();
   int GetNextNum(int pos, long* value);
   RedisParserStatus ProcessInlineBuffer();
@@ -92,9 +155,29 @@ class RedisParser {
   std::vector<RedisCmdArgsType> argvs_;
 
   int cur_pos_;
+  int cmd_start_;  // offset of the command being parsed
   const char* input_buf_;
   std::string input_str_;
   int length_;
+
+  /*
+   * Parsing in place: the arguments of all commands not yet completed as
+   * offsets into the input. Unescaped inline arguments are kept in
+   * inline_args_ instead, marked by in_inline_args.
+   */
+  struct ArgRef {
+    int offset;
+    int len;
+    bool in_inline_args;
+  };
+  bool in_place_;
+  std::vector<ArgRef> arg_refs_;
+  std::vector<size_t> cmd_ends_;  // index into arg_refs_ after each command
+  std::string inline_args_;
+
+  long bulk_stream_threshold_;
+  // Bytes of the streamed argument not handed to DealBulkChunk yet, -1 if none
+  long bulk_stream_remain_;
 };
 
 }  // namespace pink
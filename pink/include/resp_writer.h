@@ -0,0 +1,111 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef PINK_INCLUDE_RESP_WRITER_H_
+#define PINK_INCLUDE_RESP_WRITER_H_
+
+#include <sys/uio.h>
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "pink/include/pink_define.h"
+
+namespace pink {
+
+/*
+ * Builds a RESP reply as a chain of segments that is sent with writev.
+ *
+ * Headers and small replies are copied into one buffer. Large payloads
+ * can instead be referenced with AppendRef(), they must then stay valid
+ * until the reply is sent or cleared, e.g. by handing their owner to
+ * Retain(). Code that builds replies as strings can append to buffer()
+ * directly, but must not remove anything from it.
+ */
+class RespWriter {
+ public:
+  RespWriter();
+
+  void Append(const char* data, size_t len) {
+    buf_.append(data, len);
+  }
+  void Append(std::string_view data) {
+    buf_.append(data.data(), data.size());
+  }
+  // Replaces everything appended so far
+  void Assign(std::string_view data) {
+    Clear();
+    Append(data);
+  }
+
+  // ":<value>\r\n"
+  void AppendInteger(long long value);
+  // "$<len>\r\n"
+  void AppendBulkHeader(size_t len);
+  // "*<len>\r\n"
+  void AppendArrayHeader(size_t len);
+  // Copies data into a bulk string
+  void AppendBulk(std::string_view data);
+
+  // Refers to data instead of copying it
+  void AppendRef(const char* data, size_t len);
+  // Keeps owner alive until the reply is sent or cleared
+  void Retain(std::shared_ptr<const void> owner);
+
+  // Moves the reply of other to the end of this one and clears other
+  void Append(RespWriter* other);
+
+  void Reserve(size_t len) {
+    buf_.reserve(len);
+  }
+  std::string* buffer() {
+    return &buf_;
+  }
+  size_t size() const {
+    return buf_.size() + ref_len_;
+  }
+  bool empty() const {
+    return size() == 0;
+  }
+
+  void Clear();
+
+  /*
+   * Writes as much of the reply as the socket takes. Clears the reply
+   * once all of it was written.
+   */
+  WriteStatus Flush(int fd);
+
+ private:
+  // Refers to buf_ at offset if data is nullptr
+  struct Segment {
+    const char* data;
+    size_t offset;
+    size_t len;
+  };
+
+  void SealBuffer();
+
+  std::string buf_;
+  // The bytes of buf_ that are covered by segments_
+  size_t sealed_len_;
+  size_t ref_len_;
+  std::vector<Segment> segments_;
+  std::vector<std::shared_ptr<const void>> owners_;
+
+  // Bytes that Flush() already wrote
+  size_t sent_;
+  std::vector<struct iovec> iov_;
+
+  // No copying allowed
+  RespWriter(const RespWriter&);
+  void operator=(const RespWriter&);
+};
+
+}  // namespace pink
+
+#endif  // PINK_INCLUDE_RESP_WRITER_H_
@@ -99,6 +99,17 @@ class ServerHandle {
     UNUSED(data);
     return 0;
   }
+
+  /*
+   *  WorkerBatchHandle(...) will be invoked by every worker thread after it
+   *  has handled all events of one epoll wait. 'data' is the pointer assigned
+   *  in CreateWorkerSpecificData(...). Connections may defer the work of
+   *  their requests to this point to process them together, they must set
+   *  is_reply once their response is ready.
+   */
+  virtual void WorkerBatchHandle(void* data) const {
+    UNUSED(data);
+  }
 };
 
 const char kKillAllConnsTask[] = "kill_all_conns";
@@ -154,6 +165,28 @@ class ServerThread : public Thread {
 
   virtual void SetQueueLimit(int queue_limit) { }
 
+  /*
+   * When more than one connection fired in an epoll wait, keep collecting
+   * events for up to wait_us microseconds before WorkerBatchHandle(...)
+   * is invoked. Default: 0, no waiting.
+   */
+  virtual void SetBatchWait(int wait_us) { }
+
+  /*
+   * Lets every worker listen on its own SO_REUSEPORT socket and accept
+   * its connections itself, instead of handing each one over from the
+   * accepting thread. Must be called before StartThread(). Default:
+   * false.
+   */
+  virtual void SetReusePort(bool reuse_port) { }
+
+  /*
+   * Selects how the event loops wait for readiness, see PollBackend.
+   * Must be called before StartThread(). kPollIoUring falls back to
+   * epoll if the kernel does not support it.
+   */
+  virtual void SetPollBackend(PollBackend backend);
+
   virtual ~ServerThread();
 
  protected:
@@ -191,6 +224,11 @@ class ServerThread : public Thread {
 
   virtual int InitHandle();
   virtual void *ThreadMain() override;
+  /*
+   * Accepts a connection on listen_fd and checks it with AccessHandle.
+   * Returns the new fd, or -1 if there is none or it was refused
+   */
+  int AcceptConn(int listen_fd, std::string* ip_port);
   /*
    * The server event handle
    */
@@ -0,0 +1,153 @@
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "cluster_topology.h"
+
+// The CPUs that this process may run on, in ascending order
+static std::vector<Uint16> get_available_cpus()
+{
+    std::vector<Uint16> cpus;
+#ifdef __linux__
+    cpu_set_t cpu_set;
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0)
+    {
+        for (Uint32 cpu = 0; cpu < CPU_SETSIZE; cpu++)
+        {
+            if (CPU_ISSET(cpu, &cpu_set))
+                cpus.push_back(cpu);
+        }
+        return cpus;
+    }
+#endif
+    long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (long cpu = 0; cpu < num_cpus; cpu++)
+    {
+        cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+static bool parse_number(const char *str, Uint32 max_value, Uint32 *value)
+{
+    char *end = nullptr;
+    unsigned long number = strtoul(str, &end, 10);
+    if (end == str || *end != '\0' || number > max_value)
+        return false;
+    *value = number;
+    return true;
+}
+
+static bool parse_cpus(const char *str, std::vector<Uint16> *cpus)
+{
+    cpus->clear();
+    if (strcmp(str, "none") == 0)
+        return true;
+    std::string list(str);
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        Uint32 cpu;
+        if (!parse_number(list.substr(start, end - start).c_str(), 65535, &cpu))
+            return false;
+        cpus->push_back(cpu);
+        start = end + 1;
+    }
+    return true;
+}
+
+int init_cluster_topology(struct cluster_topology *topology, Uint32 num_ndb_objects)
+{
+    std::vector<Uint16> cpus = get_available_cpus();
+    Uint32 num_cpus = std::max(cpus.size(), size_t(1));
+
+    topology->num_connections = std::clamp(num_cpus / CORES_PER_CLUSTER_CONNECTION,
+                                           Uint32(2),
+                                           Uint32(MAX_CLUSTER_CONNECTIONS));
+    const char *env = getenv("RONDIS_CLUSTER_CONNECTIONS");
+    if (env != nullptr &&
+        (!parse_number(env, MAX_CLUSTER_CONNECTIONS, &topology->num_connections) ||
+         topology->num_connections == 0))
+    {
+        printf("RONDIS_CLUSTER_CONNECTIONS must be between 1 and %d\n",
+               MAX_CLUSTER_CONNECTIONS);
+        return -1;
+    }
+    topology->num_connections = std::min(topology->num_connections, num_ndb_objects);
+
+    topology->block_mapping = false;
+    env = getenv("RONDIS_NDB_MAPPING");
+    if (env != nullptr)
+    {
+        if (strcmp(env, "block") == 0)
+        {
+            topology->block_mapping = true;
+        }
+        else if (strcmp(env, "round-robin") != 0)
+        {
+            printf("RONDIS_NDB_MAPPING must be round-robin or block\n");
+            return -1;
+        }
+    }
+
+    topology->recv_thread_cpus.clear();
+    topology->recv_thread_activation_threshold = 0;
+    if (num_cpus >= MIN_CORES_TO_LOCK_RECV_THREADS &&
+        topology->num_connections < num_cpus / 2)
+    {
+        for (Uint32 i = 0; i < topology->num_connections; i++)
+        {
+            topology->recv_thread_cpus.push_back(cpus[cpus.size() - 1 - i]);
+        }
+        topology->recv_thread_activation_threshold = LOCKED_RECV_THREAD_ACTIVATION_THRESHOLD;
+    }
+    env = getenv("RONDIS_RECV_THREAD_CPUS");
+    if (env != nullptr)
+    {
+        if (!parse_cpus(env, &topology->recv_thread_cpus) ||
+            (!topology->recv_thread_cpus.empty() &&
+             topology->recv_thread_cpus.size() != topology->num_connections))
+        {
+            printf("RONDIS_RECV_THREAD_CPUS must list one CPU for each of the %u "
+                   "cluster connections, or be none\n",
+                   topology->num_connections);
+            return -1;
+        }
+    }
+    env = getenv("RONDIS_RECV_THREAD_THRESHOLD");
+    if (env != nullptr &&
+        !parse_number(env, 16, &topology->recv_thread_activation_threshold))
+    {
+        printf("RONDIS_RECV_THREAD_THRESHOLD must be between 0 and 16\n");
+        return -1;
+    }
+
+    printf("Using %u cluster connections for %u Ndb objects (%s) on %u cores\n",
+           topology->num_connections,
+           num_ndb_objects,
+           topology->block_mapping ? "block" : "round-robin",
+           num_cpus);
+    for (Uint32 i = 0; i < topology->recv_thread_cpus.size(); i++)
+    {
+        printf("Receive thread of cluster connection %u is locked to CPU %u\n",
+               i, topology->recv_thread_cpus[i]);
+    }
+    return 0;
+}
+
+Uint32 get_cluster_connection(const struct cluster_topology *topology,
+                              Uint32 ndb_index,
+                              Uint32 num_ndb_objects)
+{
+    if (topology->block_mapping)
+        return (Uint64)ndb_index * topology->num_connections / num_ndb_objects;
+    return ndb_index % topology->num_connections;
+}
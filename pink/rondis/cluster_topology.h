@@ -0,0 +1,56 @@
+#include <vector>
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#ifndef RONDIS_CLUSTER_TOPOLOGY_H
+#define RONDIS_CLUSTER_TOPOLOGY_H
+
+// Each cluster connection takes an API node slot of the cluster
+#define MAX_CLUSTER_CONNECTIONS 16
+
+/*
+    Without overrides, there is one cluster connection per
+    CORES_PER_CLUSTER_CONNECTION cores, at least two. Hosts with at least
+    MIN_CORES_TO_LOCK_RECV_THREADS cores lock the receive thread of each
+    connection to a core of its own, taken from the last cores, and lower
+    its activation threshold, so that it receives for all Ndb objects of
+    its connection.
+*/
+#define CORES_PER_CLUSTER_CONNECTION 8
+#define MIN_CORES_TO_LOCK_RECV_THREADS 16
+#define LOCKED_RECV_THREAD_ACTIVATION_THRESHOLD 2
+
+/*
+    How the Ndb objects reach the data nodes: the number of cluster
+    connections, each with a receive thread of its own, which of them each
+    Ndb object uses, and where their receive threads run.
+*/
+struct cluster_topology
+{
+    Uint32 num_connections;
+    // Consecutive Ndb objects share a connection instead of alternating
+    bool block_mapping;
+    // The CPU of the receive thread of each connection, empty if unlocked
+    std::vector<Uint16> recv_thread_cpus;
+    // 0 keeps the default of the NDB API
+    Uint32 recv_thread_activation_threshold;
+};
+
+/*
+    Derives the topology from the cores Rondis may run on, then applies
+    the overrides from the environment:
+        RONDIS_CLUSTER_CONNECTIONS    number of cluster connections
+        RONDIS_NDB_MAPPING            round-robin (default) or block
+        RONDIS_RECV_THREAD_CPUS       one CPU per connection, comma
+                                      separated, or none
+        RONDIS_RECV_THREAD_THRESHOLD  receive thread activation threshold
+    There are never more connections than Ndb objects. Returns -1 if an
+    override is invalid.
+*/
+int init_cluster_topology(struct cluster_topology *topology, Uint32 num_ndb_objects);
+
+// Returns the cluster connection that Ndb object ndb_index uses
+Uint32 get_cluster_connection(const struct cluster_topology *topology,
+                              Uint32 ndb_index,
+                              Uint32 num_ndb_objects);
+#endif
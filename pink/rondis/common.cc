@@ -1,4 +1,6 @@
 #include <stdarg.h>
+#include <string.h>
+#include <strings.h>
 #include "pink/include/redis_conn.h"
 #include <ndbapi/NdbApi.hpp>
 #include <ndbapi/Ndb.hpp>
@@ -6,24 +8,24 @@
 #include "common.h"
 
 void assign_ndb_err_to_response(
-    std::string *response,
+    pink::RespWriter *response,
     const char *app_str,
     NdbError error)
 {
     char buf[512];
     snprintf(buf, sizeof(buf), "-ERR %s; NDB(%u) %s\r\n", app_str, error.code, error.message);
     std::cout << buf;
-    response->assign(buf);
+    response->Assign(buf);
 }
 
 void assign_generic_err_to_response(
-    std::string *response,
+    pink::RespWriter *response,
     const char *app_str)
 {
     char buf[512];
     snprintf(buf, sizeof(buf), "-ERR %s\r\n", app_str);
     std::cout << buf;
-    response->assign(buf);
+    response->Assign(buf);
 }
 
 void set_length(char *buf, Uint32 key_len)
@@ -41,3 +43,9 @@ Uint32 get_length(char *buf)
     Uint32 len32 = Uint32(low) + Uint32(256) * Uint32(high);
     return len32;
 }
+
+bool equals_ignore_case(std::string_view arg, const char *str)
+{
+    return arg.size() == strlen(str) &&
+           strncasecmp(arg.data(), str, arg.size()) == 0;
+}
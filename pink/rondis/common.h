@@ -1,23 +1,34 @@
 #include <ndbapi/NdbApi.hpp>
 #include <ndbapi/Ndb.hpp>
+#include <string_view>
+#include "pink/include/resp_writer.h"
 
 #ifndef RONDIS_COMMON_H
 #define RONDIS_COMMON_H
 
-#define MAX_CONNECTIONS 2
-
 #define REDIS_DB_NAME "redis"
 
+/*
+    Number of transactions that can be open at the same time on one
+    Ndb object. Pipelined commands each use their own transaction.
+*/
+#define MAX_PARALLEL_TRANSACTIONS 1024
+
 #define RESTRICT_VALUE_ROWS_ERROR 6000
 
 #define RONDB_INTERNAL_ERROR 2
+// The rows read by a linked query do not belong to one version of the value
+#define INCONSISTENT_READ_ERROR 3
 #define READ_ERROR 626
+#define TUPLE_EXISTS_ERROR 630
 
 int write_formatted(char *buffer, int bufferSize, const char *format, ...);
-void assign_ndb_err_to_response(std::string *response, const char *app_str, NdbError error);
-void assign_generic_err_to_response(std::string *response, const char *app_str);
+void assign_ndb_err_to_response(pink::RespWriter *response, const char *app_str, NdbError error);
+void assign_generic_err_to_response(pink::RespWriter *response, const char *app_str);
 void set_length(char* buf, Uint32 key_len);
 Uint32 get_length(char* buf);
+// Arguments are not null-terminated, see pink::RedisCmdArgsViewType
+bool equals_ignore_case(std::string_view arg, const char *str);
 
 // NDB API error messages
 #define FAILED_GET_DICT "Failed to get NdbDict"
@@ -30,10 +41,17 @@ Uint32 get_length(char* buf);
 #define FAILED_INCR_KEY_MULTI_ROW "Failed to increment key, multi-row value"
 #define FAILED_GET_OP "Failed to get NdbOperation object"
 #define FAILED_DEFINE_OP "Failed to define RonDB operation"
+#define FAILED_DECOMPRESS_VALUE "Failed to decompress value"
 
 // Redis errors
-#define REDIS_UNKNOWN_COMMAND "unknown command '%s'"
-#define REDIS_WRONG_NUMBER_OF_ARGS "wrong number of arguments for '%s' command"
+// Formatted with the length and pointer of the command name
+#define REDIS_UNKNOWN_COMMAND "unknown command '%.*s'"
+#define REDIS_WRONG_NUMBER_OF_ARGS "wrong number of arguments for '%.*s' command"
+// Static replies
+#define REDIS_OK "+OK\r\n"
+#define REDIS_TRUE ":1\r\n"
+#define REDIS_FALSE ":0\r\n"
 #define REDIS_NO_SUCH_KEY "$-1\r\n"
 #define REDIS_KEY_TOO_LARGE "key is too large (3000 bytes max)"
+#define REDIS_NOT_AN_INTEGER "value is not an integer or out of range"
 #endif
@@ -0,0 +1,68 @@
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#include "coroutine.h"
+#include "worker_context.h"
+
+#define EXECUTE_POLL_TIMEOUT_MS 3000
+
+static void execute_async_callback(int result, NdbTransaction *trans, void *arg)
+{
+    execute_async *awaiter = static_cast<execute_async *>(arg);
+    awaiter->result = result;
+    awaiter->ctx->ready.push_back(awaiter->waiting);
+}
+
+void execute_async::await_suspend(std::coroutine_handle<> handle)
+{
+    waiting = handle;
+    trans->executeAsynchPrepare(exec_type,
+                                execute_async_callback,
+                                this,
+                                abort_option);
+    ctx->num_prepared++;
+}
+
+Uint32 execute_prepared(struct worker_context *ctx)
+{
+    Uint32 num_pending = ctx->num_prepared;
+    if (num_pending == 0)
+        return 0;
+    ctx->num_prepared = 0;
+    /*
+        A blocking execute(), as in Ndb::getAutoIncrementValue(), sends the
+        prepared transactions as well and runs the callbacks of those that
+        complete meanwhile. Hence some of them may be ready already.
+    */
+    Ndb *ndb = ctx->ndb;
+    if (ctx->ready.size() < num_pending)
+    {
+        ndb->sendPollNdb(EXECUTE_POLL_TIMEOUT_MS,
+                         num_pending - ctx->ready.size(),
+                         1);
+    }
+    while (ctx->ready.size() < num_pending)
+    {
+        ndb->pollNdb(EXECUTE_POLL_TIMEOUT_MS, num_pending - ctx->ready.size());
+    }
+    /*
+        Resumed tasks prepare their next round trip, which belongs to the
+        next call, and so do the tasks a blocking execute() makes ready.
+    */
+    for (Uint32 i = 0; i < num_pending; i++)
+    {
+        ctx->ready[i].resume();
+    }
+    ctx->ready.erase(ctx->ready.begin(), ctx->ready.begin() + num_pending);
+    return num_pending;
+}
+
+int run_ndb_task(struct worker_context *ctx, ndb_task task)
+{
+    task.start();
+    while (!task.done())
+    {
+        execute_prepared(ctx);
+    }
+    return task.result();
+}
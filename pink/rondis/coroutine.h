@@ -0,0 +1,144 @@
+#include <coroutine>
+#include <exception>
+#include <utility>
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#ifndef RONDIS_COROUTINE_H
+#define RONDIS_COROUTINE_H
+
+struct worker_context;
+
+/*
+    A command, or a step of a command, that suspends while RonDB executes
+    its operations. Every round trip to the data nodes is written as
+
+        int ret = co_await execute_async(ctx, trans, NdbTransaction::NoCommit);
+
+    which prepares the transaction on the Ndb object of the worker and
+    suspends the command. Whoever drives the commands of the worker (see
+    pipeline.h and run_ndb_task()) sends all prepared transactions at once,
+    polls for their completion and resumes the commands they belong to.
+    Hence one worker keeps many multi-step commands in flight, while each
+    of them still reads as a sequence of blocking calls.
+
+    A task starts suspended. Awaiting it from another task runs it and
+    returns its int result; a task that nobody awaits is started with
+    start(). The task owns its coroutine frame, so it must outlive the
+    coroutine, i.e. a suspended task must not be destroyed.
+*/
+struct ndb_task
+{
+    struct promise_type
+    {
+        int result = 0;
+        // The awaiting task, resumed once this one completes
+        std::coroutine_handle<> continuation;
+
+        ndb_task get_return_object()
+        {
+            return ndb_task(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct final_awaiter
+        {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(
+                std::coroutine_handle<promise_type> handle) noexcept
+            {
+                std::coroutine_handle<> continuation = handle.promise().continuation;
+                if (continuation)
+                    return continuation;
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        final_awaiter final_suspend() noexcept { return {}; }
+
+        void return_value(int value) { result = value; }
+        // The command code does not throw
+        void unhandled_exception() { std::terminate(); }
+    };
+
+    ndb_task() = default;
+    explicit ndb_task(std::coroutine_handle<promise_type> handle)
+        : handle(handle) {}
+    ndb_task(ndb_task &&other) noexcept
+        : handle(std::exchange(other.handle, nullptr)) {}
+    ndb_task &operator=(ndb_task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+    ndb_task(const ndb_task &) = delete;
+    ndb_task &operator=(const ndb_task &) = delete;
+    ~ndb_task()
+    {
+        if (handle)
+            handle.destroy();
+    }
+
+    // Runs the task until it first waits for RonDB or completes
+    void start() { handle.resume(); }
+    bool done() const { return !handle || handle.done(); }
+    int result() const { return handle.promise().result; }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        handle.promise().continuation = awaiting;
+        return handle;
+    }
+    int await_resume() const { return handle.promise().result; }
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/*
+    Awaitable replacement of NdbTransaction::execute(). The result is that
+    of execute(), 0 or -1, and the NdbError of the transaction and its
+    operations is set as after execute().
+*/
+struct execute_async
+{
+    execute_async(struct worker_context *ctx,
+                  NdbTransaction *trans,
+                  NdbTransaction::ExecType exec_type,
+                  NdbOperation::AbortOption abort_option = NdbOperation::AbortOnError)
+        : ctx(ctx),
+          trans(trans),
+          exec_type(exec_type),
+          abort_option(abort_option),
+          result(0) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle);
+    int await_resume() const noexcept { return result; }
+
+    struct worker_context *ctx;
+    NdbTransaction *trans;
+    NdbTransaction::ExecType exec_type;
+    NdbOperation::AbortOption abort_option;
+    int result;
+    std::coroutine_handle<> waiting;
+};
+
+/*
+    Sends the transactions prepared by execute_async since the last call,
+    waits until all of them completed and resumes the tasks waiting for
+    them. Returns the number of transactions that were sent.
+*/
+Uint32 execute_prepared(struct worker_context *ctx);
+
+/*
+    Runs the task to completion on the calling thread, waiting for each of
+    its round trips in turn. Returns the result of the task.
+*/
+int run_ndb_task(struct worker_context *ctx, ndb_task task);
+#endif
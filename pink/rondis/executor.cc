@@ -0,0 +1,101 @@
+#include <utility>
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#include "executor.h"
+#include "pipeline.h"
+#include "worker_context.h"
+
+static void executor_main(struct executor *exec)
+{
+    std::vector<pipeline_stream> streams;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(exec->mutex);
+            exec->cond.wait(lock, [exec]
+                            { return exec->stopping || !exec->queued.empty(); });
+            if (exec->queued.empty())
+                return;
+            streams.swap(exec->queued);
+        }
+        rondb_redis_pipeline_execute(streams, exec->ctx);
+        for (auto &stream : streams)
+        {
+            if (stream.conn != nullptr)
+            {
+                stream.conn->NotifyEpoll(true);
+            }
+        }
+        streams.clear();
+    }
+}
+
+struct executor *create_executor(int worker_id)
+{
+    struct worker_context *ctx = create_worker_context(worker_id);
+    if (ctx == nullptr)
+    {
+        return nullptr;
+    }
+    struct executor *exec = new executor();
+    exec->ctx = ctx;
+    exec->stopping = false;
+    exec->thread = std::thread(executor_main, exec);
+    return exec;
+}
+
+void destroy_executor(struct executor *exec)
+{
+    {
+        std::lock_guard<std::mutex> lock(exec->mutex);
+        exec->stopping = true;
+    }
+    exec->cond.notify_one();
+    exec->thread.join();
+    destroy_worker_context(exec->ctx);
+    delete exec;
+}
+
+void executor_submit(struct executor *exec)
+{
+    if (exec->collected.empty())
+    {
+        return;
+    }
+    bool was_idle;
+    {
+        std::lock_guard<std::mutex> lock(exec->mutex);
+        was_idle = exec->queued.empty();
+        if (was_idle)
+        {
+            exec->queued.swap(exec->collected);
+        }
+        else
+        {
+            for (auto &stream : exec->collected)
+            {
+                exec->queued.push_back(std::move(stream));
+            }
+        }
+    }
+    exec->collected.clear();
+    if (was_idle)
+    {
+        exec->cond.notify_one();
+    }
+}
+
+void executor_submit_stream(struct executor *exec, pipeline_stream &&stream)
+{
+    bool was_idle;
+    {
+        std::lock_guard<std::mutex> lock(exec->mutex);
+        was_idle = exec->queued.empty();
+        exec->queued.push_back(std::move(stream));
+    }
+    if (was_idle)
+    {
+        exec->cond.notify_one();
+    }
+}
@@ -0,0 +1,62 @@
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "pipeline.h"
+
+#ifndef RONDIS_EXECUTOR_H
+#define RONDIS_EXECUTOR_H
+
+struct worker_context;
+
+/*
+    Executes the commands of the connections of one worker thread, so that
+    the worker thread never waits for a round trip to RonDB and keeps
+    reading and writing the sockets of its other connections meanwhile.
+
+    Each executor thread has the worker_context, and thereby the Ndb object,
+    of its worker thread to itself. Commands that are handed over while it
+    is busy are executed together in its next batch. When the commands of a
+    connection are done, their replies are in its response and the
+    connection is handed back through RedisConn::NotifyEpoll().
+
+    Streams with large values are handed to a separate pool of executors
+    with their own Ndb objects instead, so that writing or reading many
+    value rows does not delay the small commands of the worker thread (see
+    is_large_command_stream()).
+*/
+struct executor
+{
+    struct worker_context *ctx;
+
+    // Streams the worker thread collected in the current epoll iteration
+    std::vector<pipeline_stream> collected;
+
+    std::mutex mutex;
+    std::condition_variable cond;
+    // Handed over to the executor thread, guarded by mutex
+    std::vector<pipeline_stream> queued;
+    bool stopping;
+
+    std::thread thread;
+};
+
+// Returns nullptr if the worker_context cannot be created
+struct executor *create_executor(int worker_id);
+
+/*
+    Executes the commands that are still queued, then stops the executor
+    thread and releases the executor and its worker_context.
+*/
+void destroy_executor(struct executor *exec);
+
+// Hands the collected streams over to the executor thread
+void executor_submit(struct executor *exec);
+
+/*
+    Hands a single stream over to the executor thread right away. Unlike
+    executor_submit(), it may be called from any thread.
+*/
+void executor_submit_stream(struct executor *exec, pipeline_stream &&stream);
+#endif
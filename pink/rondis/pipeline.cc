@@ -0,0 +1,284 @@
+#include <string.h>
+#include <strings.h>
+#include <deque>
+#include <memory>
+#include "pink/include/redis_conn.h"
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#include "pipeline.h"
+#include "rondb.h"
+#include "common.h"
+#include "coroutine.h"
+#include "worker_context.h"
+#include "string/commands.h"
+
+struct pipeline_op
+{
+    const pink::RedisCmdArgsViewType *argv;
+    // Touches a single key, see classify_command()
+    bool single_key;
+    bool is_hash_cmd;
+    ndb_task task;
+    pink::RespWriter response;
+};
+
+/*
+    The commands of a stream that were started and whose replies are not
+    in the response of the stream yet, in request order.
+*/
+struct stream_state
+{
+    pipeline_stream *stream;
+    std::deque<pipeline_op *> in_flight;
+    // The step of the upload of the stream is not started yet
+    bool upload_pending;
+    // Likewise for the step of a download in progress
+    bool download_pending;
+};
+
+/*
+    Completed ops are kept around for the lifetime of the worker thread
+    rather than allocated per command.
+*/
+static thread_local std::vector<std::unique_ptr<pipeline_op>> free_pipeline_ops;
+
+static pipeline_op *get_pipeline_op()
+{
+    if (free_pipeline_ops.empty())
+    {
+        return new pipeline_op();
+    }
+    pipeline_op *op = free_pipeline_ops.back().release();
+    free_pipeline_ops.pop_back();
+    op->response.Clear();
+    return op;
+}
+
+static void release_pipeline_op(pipeline_op *op)
+{
+    // Frees the coroutine frame of the completed command
+    op->task = ndb_task();
+    free_pipeline_ops.emplace_back(op);
+}
+
+/*
+    Returns true if the command touches a single key, which is then
+    argv[1] or, for hash commands, the field argv[2] of the hash argv[1].
+    Commands with the wrong number of arguments are not, they fail
+    without touching a key anyway.
+*/
+static bool classify_command(const pink::RedisCmdArgsViewType &argv,
+                             bool *is_hash_cmd)
+{
+    std::string_view command = argv[0];
+    Uint32 argc = argv.size();
+    if ((equals_ignore_case(command, "GET") && argc == 2) ||
+        (equals_ignore_case(command, "SET") && argc == 3) ||
+        (equals_ignore_case(command, "INCR") && argc == 2) ||
+        (equals_ignore_case(command, "DECR") && argc == 2) ||
+        (equals_ignore_case(command, "INCRBY") && argc == 3) ||
+        (equals_ignore_case(command, "DECRBY") && argc == 3))
+    {
+        *is_hash_cmd = false;
+        return true;
+    }
+    if ((equals_ignore_case(command, "HGET") && argc == 3) ||
+        (equals_ignore_case(command, "HSET") && argc == 4) ||
+        (equals_ignore_case(command, "HINCR") && argc == 3))
+    {
+        *is_hash_cmd = true;
+        return true;
+    }
+    return false;
+}
+
+static bool touches_same_key(const pipeline_op *op,
+                             const pink::RedisCmdArgsViewType &argv,
+                             bool is_hash_cmd)
+{
+    if (op->is_hash_cmd != is_hash_cmd)
+        return false;
+    const pink::RedisCmdArgsViewType &op_argv = *op->argv;
+    if (op_argv[1] != argv[1])
+        return false;
+    return !is_hash_cmd || op_argv[2] == argv[2];
+}
+
+/*
+    Returns true if the command may start while the commands in flight
+    on the stream have not completed yet.
+*/
+static bool can_start(const stream_state &state,
+                      const pink::RedisCmdArgsViewType &argv,
+                      bool single_key,
+                      bool is_hash_cmd)
+{
+    if (state.in_flight.empty())
+        return true;
+    // Either all commands in flight touch a single key or there is one
+    if (!single_key || !state.in_flight.front()->single_key)
+        return false;
+    for (const pipeline_op *op : state.in_flight)
+    {
+        if (touches_same_key(op, argv, is_hash_cmd))
+            return false;
+    }
+    return true;
+}
+
+// Moves the replies of the completed commands to the stream in order
+static void flush_completed(stream_state &state, Uint32 &num_in_flight)
+{
+    while (!state.in_flight.empty() && state.in_flight.front()->task.done())
+    {
+        pipeline_op *op = state.in_flight.front();
+        state.in_flight.pop_front();
+        num_in_flight--;
+        state.stream->response->Append(&op->response);
+        release_pipeline_op(op);
+    }
+}
+
+/*
+    Starts the next commands of the stream until one of them has to wait
+    for the commands in flight. Each runs until its first round trip is
+    prepared or it completes.
+*/
+static void start_commands(struct worker_context *ctx,
+                           stream_state &state,
+                           Uint32 &num_in_flight)
+{
+    pipeline_stream *stream = state.stream;
+    if (state.upload_pending)
+    {
+        if (num_in_flight >= MAX_COMMANDS_IN_FLIGHT)
+            return;
+        // Holds back the other commands like a multi-key command
+        bool last = !stream->argvs.empty();
+        pipeline_op *op = get_pipeline_op();
+        op->argv = last ? &stream->argvs[0] : nullptr;
+        op->single_key = false;
+        op->is_hash_cmd = false;
+        op->task = rondb_set_upload_step(ctx, stream->upload.get(), last, &op->response);
+        op->task.start();
+        state.in_flight.push_back(op);
+        num_in_flight++;
+        if (last)
+            stream->next_cmd++;
+        state.upload_pending = false;
+        flush_completed(state, num_in_flight);
+    }
+    if (state.download_pending)
+    {
+        if (num_in_flight >= MAX_COMMANDS_IN_FLIGHT)
+            return;
+        pipeline_op *op = get_pipeline_op();
+        op->argv = nullptr;
+        op->single_key = false;
+        op->is_hash_cmd = false;
+        op->task = rondb_get_download_step(ctx, stream->download.get(), &op->response);
+        op->task.start();
+        state.in_flight.push_back(op);
+        num_in_flight++;
+        state.download_pending = false;
+        flush_completed(state, num_in_flight);
+    }
+    while (stream->next_cmd < stream->argvs.size() &&
+           num_in_flight < MAX_COMMANDS_IN_FLIGHT)
+    {
+        const pink::RedisCmdArgsViewType &argv = stream->argvs[stream->next_cmd];
+        bool is_hash_cmd = false;
+        bool single_key = classify_command(argv, &is_hash_cmd);
+        if (!can_start(state, argv, single_key, is_hash_cmd))
+            break;
+        pipeline_op *op = get_pipeline_op();
+        op->argv = &argv;
+        op->single_key = single_key;
+        op->is_hash_cmd = is_hash_cmd;
+        // Using a separate response since error replies overwrite it
+        if (stream->download != nullptr &&
+            stream->next_cmd + 1 == stream->argvs.size() &&
+            single_key && !is_hash_cmd &&
+            equals_ignore_case(argv[0], "GET"))
+        {
+            // Nothing follows that would have to wait for the rest of the value
+            op->task = rondb_get_download_command(ctx, argv, &op->response,
+                                                  stream->download.get());
+        }
+        else
+        {
+            op->task = rondb_redis_handler(argv, &op->response, ctx);
+        }
+        op->task.start();
+        state.in_flight.push_back(op);
+        num_in_flight++;
+        stream->next_cmd++;
+        flush_completed(state, num_in_flight);
+    }
+}
+
+void rondb_redis_pipeline_execute(std::vector<pipeline_stream> &streams,
+                                  struct worker_context *ctx)
+{
+    std::vector<stream_state> states(streams.size());
+    for (Uint32 i = 0; i < streams.size(); i++)
+    {
+        states[i].stream = &streams[i];
+        states[i].upload_pending = streams[i].upload != nullptr;
+        states[i].download_pending = streams[i].download != nullptr &&
+                                     streams[i].download->trans != nullptr;
+        if (streams[i].conn == nullptr)
+        {
+            if (streams[i].upload != nullptr)
+                set_upload_abort(ctx, streams[i].upload.get());
+            if (streams[i].download != nullptr)
+                get_download_abort(ctx, streams[i].download.get());
+            states[i].upload_pending = false;
+            states[i].download_pending = false;
+        }
+    }
+    Uint32 num_in_flight = 0;
+    while (true)
+    {
+        bool cmds_left = false;
+        for (auto &state : states)
+        {
+            start_commands(ctx, state, num_in_flight);
+            if (state.upload_pending ||
+                state.download_pending ||
+                !state.in_flight.empty() ||
+                state.stream->next_cmd < state.stream->argvs.size())
+            {
+                cmds_left = true;
+            }
+        }
+        if (!cmds_left)
+            break;
+        /*
+            Every command in flight waits for a transaction it prepared,
+            sending them resumes at least one of these commands.
+        */
+        execute_prepared(ctx);
+        for (auto &state : states)
+        {
+            flush_completed(state, num_in_flight);
+        }
+    }
+    verify_transactions_closed(ctx);
+}
+
+bool is_large_command_stream(const pipeline_stream &stream)
+{
+    for (const auto &argv : stream.argvs)
+    {
+        size_t command_len = 0;
+        for (const auto &arg : argv)
+        {
+            command_len += arg.size();
+        }
+        if (command_len > LARGE_COMMAND_LEN)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,83 @@
+#include <memory>
+#include <string>
+#include <vector>
+#include "pink/include/redis_conn.h"
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#ifndef RONDIS_PIPELINE_H
+#define RONDIS_PIPELINE_H
+
+/*
+    Maximum number of commands that are in flight on one worker at the same
+    time. Every command uses its own NdbTransaction, hence this must stay
+    below MAX_PARALLEL_TRANSACTIONS.
+*/
+#define MAX_COMMANDS_IN_FLIGHT 256
+
+/*
+    Streams with a command that carries more than this many bytes of keys
+    and values are executed by the large value executors (see executor.h).
+*/
+#define LARGE_COMMAND_LEN (1024 * 1024)
+
+struct worker_context;
+struct set_upload;
+struct get_download;
+
+/*
+    The commands that were parsed from one read of a connection and
+    are waiting to be executed.
+
+    With an upload, the stream first runs a step of the SET whose value is
+    streamed in (see set_upload). If the value is complete, the first
+    command is that SET, otherwise the stream has no commands.
+
+    The download is that of the connection, if the last command is a GET
+    of a large value it only replies with the start of the value and leaves
+    the rest to the download (see get_download). A stream of a download in
+    progress has no commands and reads the next part of the value.
+
+    A stream without a connection only rolls back its upload and download.
+*/
+struct pipeline_stream
+{
+    // Keeps the connection alive until it is handed back to its worker
+    std::shared_ptr<pink::RedisConn> conn;
+    std::vector<pink::RedisCmdArgsViewType> argvs;
+    pink::RespWriter *response;
+    Uint32 next_cmd;
+    std::shared_ptr<struct set_upload> upload;
+    std::shared_ptr<struct get_download> download;
+};
+
+/*
+    Executes the commands of all streams that were handed to an executor
+    (see executor.h).
+
+    Every command runs as a task (see coroutine.h) with its own
+    NdbTransaction. The tasks of all streams are started together and
+    prepare their first round trip, which is then sent in one go with
+    sendPollNdb(). Whenever the transactions complete, their tasks are
+    resumed and prepare the next round trip, so a round of commands from
+    many connections costs one round trip to the data nodes instead of one
+    per command, also for commands that need several round trips (e.g. a
+    SET of a value with value rows).
+
+    Within a stream, the next command starts while earlier ones are still
+    in flight if all of them touch a single key each (GET, SET and INCR and
+    their hash counterparts) and no earlier one touches the same key. Any
+    other command waits for the commands before it and holds back the
+    commands after it.
+
+    Replies are appended to the response of each stream in request order.
+*/
+void rondb_redis_pipeline_execute(std::vector<pipeline_stream> &streams,
+                                  struct worker_context *ctx);
+
+/*
+    Returns true if a command of the stream is above LARGE_COMMAND_LEN,
+    e.g. a SET whose value rows take many round trips to write.
+*/
+bool is_large_command_stream(const pipeline_stream &stream);
+#endif
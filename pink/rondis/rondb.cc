@@ -3,9 +3,14 @@
 #include "pink/include/redis_conn.h"
 #include "pink/include/pink_thread.h"
 #include "rondb.h"
+#include "cluster_topology.h"
 #include "common.h"
+#include "coroutine.h"
+#include "worker_context.h"
 #include "string/table_definitions.h"
 #include "string/commands.h"
+#include "string/key_id_cache.h"
+#include "string/read_cache.h"
 #include <strings.h>
 
 /*
@@ -15,12 +20,16 @@
     Essentially we want:
         num worker threads == number Ndbs objects
     whereby some cluster connections may have created more Ndb objects than others.
+    The topology decides on the number of cluster connections and which Ndb objects
+    use which of them.
 */
-int initialize_ndb_objects(const char *connect_string, int num_ndb_objects)
+int initialize_ndb_objects(const char *connect_string,
+                           int num_ndb_objects,
+                           const struct cluster_topology *topology)
 {
-    Ndb_cluster_connection *rondb_conn[MAX_CONNECTIONS];
+    std::vector<Ndb_cluster_connection *> rondb_conn(topology->num_connections);
 
-    for (unsigned int i = 0; i < MAX_CONNECTIONS; i++)
+    for (unsigned int i = 0; i < topology->num_connections; i++)
     {
         rondb_conn[i] = new Ndb_cluster_connection(connect_string);
         if (rondb_conn[i]->connect() != 0)
@@ -35,18 +44,35 @@ int initialize_ndb_objects(const char *connect_string, int num_ndb_objects)
             return -1;
         }
         printf("RonDB data node connection nr. %d is ready\n", i);
+        // Not being able to place the receive thread only costs performance
+        if (!topology->recv_thread_cpus.empty())
+        {
+            Uint16 cpu = topology->recv_thread_cpus[i];
+            if (rondb_conn[i]->set_recv_thread_cpu(&cpu, 1) != 0)
+            {
+                printf("Failed locking receive thread of connection nr. %d to CPU %u\n",
+                       i, cpu);
+            }
+        }
+        if (topology->recv_thread_activation_threshold != 0 &&
+            rondb_conn[i]->set_recv_thread_activation_threshold(
+                topology->recv_thread_activation_threshold) != 0)
+        {
+            printf("Failed setting receive thread activation threshold of connection nr. %d\n",
+                   i);
+        }
     }
 
-    for (unsigned int j = 0; j < num_ndb_objects; j++)
+    for (int j = 0; j < num_ndb_objects; j++)
     {
-        int connection_num = j % MAX_CONNECTIONS;
+        int connection_num = get_cluster_connection(topology, j, num_ndb_objects);
         Ndb *ndb = new Ndb(rondb_conn[connection_num], REDIS_DB_NAME);
         if (ndb == nullptr)
         {
             printf("Failed creating Ndb object nr. %d for cluster connection %d\n", j, connection_num);
             return -1;
         }
-        if (ndb->init() != 0)
+        if (ndb->init(MAX_PARALLEL_TRANSACTIONS) != 0)
         {
             printf("Failed initializing Ndb object nr. %d for cluster connection %d\n", j, connection_num);
             return -1;
@@ -58,12 +84,14 @@ int initialize_ndb_objects(const char *connect_string, int num_ndb_objects)
     return 0;
 }
 
-int setup_rondb(const char *connect_string, int num_ndb_objects)
+int setup_rondb(const char *connect_string,
+                int num_ndb_objects,
+                const struct cluster_topology *topology)
 {
     // Creating static thread-safe Ndb objects for all connections
     ndb_init();
 
-    int res = initialize_ndb_objects(connect_string, num_ndb_objects);
+    int res = initialize_ndb_objects(connect_string, num_ndb_objects, topology);
     if (res != 0)
     {
         return res;
@@ -78,6 +106,8 @@ int setup_rondb(const char *connect_string, int num_ndb_objects)
                ndb->getNdbError().message);
         return -1;
     }
+    // The cache fills on demand otherwise
+    key_id_cache_warm_up(ndb);
 
     return 0;
 }
@@ -87,68 +117,102 @@ void rondb_end()
     ndb_end(0);
 }
 
-void print_args(const pink::RedisCmdArgsType &argv)
+void verify_transactions_closed(struct worker_context *ctx)
+{
+    Ndb *ndb = ctx->ndb;
+    if (ndb->getClientStat(ndb->TransStartCount) !=
+        ndb->getClientStat(ndb->TransCloseCount) + ctx->num_open_streams)
+    {
+        /*
+            If we are here, we have a transaction that was not closed.
+            Only a certain amount of transactions can be open at the same time.
+            If this limit is reached, the Ndb object will not create any new ones.
+            Hence, better to catch these cases early.
+        */
+        printf("Failed to stop transaction\n");
+        printf("Number of transactions started: %lld\n", ndb->getClientStat(ndb->TransStartCount));
+        printf("Number of transactions closed: %lld\n", ndb->getClientStat(ndb->TransCloseCount));
+        exit(1);
+    }
+}
+
+void print_args(const pink::RedisCmdArgsViewType &argv)
 {
     for (const auto &arg : argv)
     {
-        printf("%s ", arg.c_str());
+        printf("%.*s ", (int)arg.size(), arg.data());
     }
     printf("\n");
 }
 
-void unsupported_command(const pink::RedisCmdArgsType &argv, std::string *response)
+void unsupported_command(const pink::RedisCmdArgsViewType &argv, pink::RespWriter *response)
 {
     printf("Unsupported command: ");
     print_args(argv);
     char error_message[256];
-    snprintf(error_message, sizeof(error_message), REDIS_UNKNOWN_COMMAND, argv[0].c_str());
+    snprintf(error_message, sizeof(error_message), REDIS_UNKNOWN_COMMAND, (int)argv[0].size(), argv[0].data());
     assign_generic_err_to_response(response, error_message);
 }
 
-int rondb_redis_handler(const pink::RedisCmdArgsType &argv,
-                        std::string *response,
-                        int worker_id)
+/*
+    Drops the keys written by a command from the read cache, every step-th
+    argument from argv[first] on.
+*/
+static void invalidate_written_keys(const pink::RedisCmdArgsViewType &argv,
+                                    Uint32 first,
+                                    Uint32 step)
+{
+    if (!read_cache_enabled())
+        return;
+    for (Uint32 i = first; i < argv.size(); i += step)
+    {
+        read_cache_invalidate(argv[i]);
+    }
+}
+
+ndb_task rondb_redis_handler(const pink::RedisCmdArgsViewType &argv,
+                             pink::RespWriter *response,
+                             struct worker_context *ctx)
 {
     // First check non-ndb commands
-    const char *command = argv[0].c_str();
-    if (strcasecmp(command, "ping") == 0)
+    std::string_view command = argv[0];
+    if (equals_ignore_case(command, "ping"))
     {
         if (argv.size() != 1)
         {
             char error_message[256];
-            snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+            snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
             assign_generic_err_to_response(response, error_message);
-            return 0;
+            co_return 0;
         }
-        response->append("+PONG\r\n");
+        response->Append("+PONG\r\n");
     }
     else if (argv[0] == "ECHO")
     {
         if (argv.size() != 2)
         {
             char error_message[256];
-            snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+            snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
             assign_generic_err_to_response(response, error_message);
-            return 0;
+            co_return 0;
         }
 
-        response->assign("$" + std::to_string(argv[1].length()) + "\r\n" + argv[1] + "\r\n");
+        response->AppendBulk(argv[1]);
     }
     else if (argv[0] == "CONFIG")
     {
         if (argv.size() != 3)
         {
             char error_message[256];
-            snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+            snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
             assign_generic_err_to_response(response, error_message);
-            return 0;
+            co_return 0;
         }
         if (argv[1] == "GET")
         {
-            *response += "*2\r\n";
-            *response += "$" + std::to_string(argv[2].length()) + "\r\n";
-            *response += argv[2] + "\r\n";
-            *response += "*0\r\n";
+            response->AppendArrayHeader(2);
+            response->AppendBulk(argv[2]);
+            response->Append("*0\r\n");
         }
         else
         {
@@ -157,82 +221,194 @@ int rondb_redis_handler(const pink::RedisCmdArgsType &argv,
     }
     else
     {
-        Ndb *ndb = ndb_objects[worker_id];
-        if (strcasecmp(command, "GET") == 0)
+        if (equals_ignore_case(command, "GET"))
         {
             if (argv.size() == 2)
             {
-                rondb_get_command(ndb, argv, response);
+                co_await rondb_get_command(ctx, argv, response);
             }
             else
             {
                 char error_message[256];
-                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
                 assign_generic_err_to_response(response, error_message);
             }
         }
-        else if (strcasecmp(command, "SET") == 0)
+        else if (equals_ignore_case(command, "SET"))
         {
             if (argv.size() == 3)
             {
-                rondb_set_command(ndb, argv, response);
+                co_await rondb_set_command(ctx, argv, response);
+                invalidate_written_keys(argv, 1, 2);
+            }
+            else
+            {
+                char error_message[256];
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
+                assign_generic_err_to_response(response, error_message);
+            }
+        }
+        else if (equals_ignore_case(command, "INCR"))
+        {
+            if (argv.size() == 2)
+            {
+                co_await rondb_incr_command(ctx, argv, response);
+                invalidate_written_keys(argv, 1, 1);
             }
             else
             {
                 char error_message[256];
-                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
                 assign_generic_err_to_response(response, error_message);
             }
         }
-        else if (strcasecmp(command, "INCR") == 0)
+        else if (equals_ignore_case(command, "DECR"))
         {
             if (argv.size() == 2)
             {
-                rondb_incr_command(ndb, argv, response);
+                co_await rondb_decr_command(ctx, argv, response);
+                invalidate_written_keys(argv, 1, 1);
+            }
+            else
+            {
+                char error_message[256];
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
+                assign_generic_err_to_response(response, error_message);
+            }
+        }
+        else if (equals_ignore_case(command, "INCRBY"))
+        {
+            if (argv.size() == 3)
+            {
+                co_await rondb_incrby_command(ctx, argv, response);
+                invalidate_written_keys(argv, 1, 2);
+            }
+            else
+            {
+                char error_message[256];
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
+                assign_generic_err_to_response(response, error_message);
+            }
+        }
+        else if (equals_ignore_case(command, "DECRBY"))
+        {
+            if (argv.size() == 3)
+            {
+                co_await rondb_decrby_command(ctx, argv, response);
+                invalidate_written_keys(argv, 1, 2);
             }
             else
             {
                 char error_message[256];
-                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
                 assign_generic_err_to_response(response, error_message);
             }
         }
-        else if (strcasecmp(command, "HGET") == 0)
+        else if (equals_ignore_case(command, "MGET"))
+        {
+            if (argv.size() >= 2)
+            {
+                co_await rondb_mget_command(ctx, argv, response);
+            }
+            else
+            {
+                char error_message[256];
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
+                assign_generic_err_to_response(response, error_message);
+            }
+        }
+        else if (equals_ignore_case(command, "MSET"))
+        {
+            if (argv.size() >= 3 && argv.size() % 2 == 1)
+            {
+                co_await rondb_mset_command(ctx, argv, response);
+                invalidate_written_keys(argv, 1, 2);
+            }
+            else
+            {
+                char error_message[256];
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
+                assign_generic_err_to_response(response, error_message);
+            }
+        }
+        else if (equals_ignore_case(command, "MSETNX"))
+        {
+            if (argv.size() >= 3 && argv.size() % 2 == 1)
+            {
+                co_await rondb_msetnx_command(ctx, argv, response);
+                invalidate_written_keys(argv, 1, 2);
+            }
+            else
+            {
+                char error_message[256];
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
+                assign_generic_err_to_response(response, error_message);
+            }
+        }
+        else if (equals_ignore_case(command, "DEL") ||
+                 equals_ignore_case(command, "UNLINK"))
+        {
+            if (argv.size() >= 2)
+            {
+                co_await rondb_del_command(ctx, argv, response);
+                invalidate_written_keys(argv, 1, 1);
+            }
+            else
+            {
+                char error_message[256];
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
+                assign_generic_err_to_response(response, error_message);
+            }
+        }
+        else if (equals_ignore_case(command, "EXISTS"))
+        {
+            if (argv.size() >= 2)
+            {
+                co_await rondb_exists_command(ctx, argv, response);
+            }
+            else
+            {
+                char error_message[256];
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
+                assign_generic_err_to_response(response, error_message);
+            }
+        }
+        else if (equals_ignore_case(command, "HGET"))
         {
             if (argv.size() == 3)
             {
-                rondb_hget_command(ndb, argv, response);
+                co_await rondb_hget_command(ctx, argv, response);
             }
             else
             {
                 char error_message[256];
-                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
                 assign_generic_err_to_response(response, error_message);
             }
         }
-        else if (strcasecmp(command, "HSET") == 0)
+        else if (equals_ignore_case(command, "HSET"))
         {
             if (argv.size() == 4)
             {
-                rondb_hset_command(ndb, argv, response);
+                co_await rondb_hset_command(ctx, argv, response);
             }
             else
             {
                 char error_message[256];
-                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
                 assign_generic_err_to_response(response, error_message);
             }
         }
-        else if (strcasecmp(command, "HINCR") == 0)
+        else if (equals_ignore_case(command, "HINCR"))
         {
             if (argv.size() == 3)
             {
-                rondb_hincr_command(ndb, argv, response);
+                co_await rondb_hincr_command(ctx, argv, response);
             }
             else
             {
                 char error_message[256];
-                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, argv[0].c_str());
+                snprintf(error_message, sizeof(error_message), REDIS_WRONG_NUMBER_OF_ARGS, (int)argv[0].size(), argv[0].data());
                 assign_generic_err_to_response(response, error_message);
             }
         }
@@ -240,20 +416,6 @@ int rondb_redis_handler(const pink::RedisCmdArgsType &argv,
         {
             unsupported_command(argv, response);
         }
-        if (ndb->getClientStat(ndb->TransStartCount) != ndb->getClientStat(ndb->TransCloseCount))
-        {
-            /*
-                If we are here, we have a transaction that was not closed.
-                Only a certain amount of transactions can be open at the same time.
-                If this limit is reached, the Ndb object will not create any new ones.
-                Hence, better to catch these cases early.
-            */
-            printf("Failed to stop transaction\n");
-            //print_args(argv);
-            printf("Number of transactions started: %lld\n", ndb->getClientStat(ndb->TransStartCount));
-            printf("Number of transactions closed: %lld\n", ndb->getClientStat(ndb->TransCloseCount));
-            exit(1);
-        }
     }
-    return 0;
+    co_return 0;
 }
@@ -2,19 +2,38 @@
 #include "pink/include/redis_conn.h"
 #include <ndbapi/NdbApi.hpp>
 #include <ndbapi/Ndb.hpp>
+#include "coroutine.h"
 
 #ifndef RONDIS_RONDB_H
 #define RONDIS_RONDB_H
 
+struct worker_context;
+struct cluster_topology;
+
 extern std::vector<Ndb *> ndb_objects;
 
-int initialize_ndb_objects(const char *connect_string, int num_ndb_objects);
+int initialize_ndb_objects(const char *connect_string,
+                           int num_ndb_objects,
+                           const struct cluster_topology *topology);
 
-int setup_rondb(const char *connect_string, int num_ndb_objects);
+int setup_rondb(const char *connect_string,
+                int num_ndb_objects,
+                const struct cluster_topology *topology);
 
 void rondb_end();
 
-int rondb_redis_handler(const pink::RedisCmdArgsType &argv,
-                        std::string *response,
-                        int fd);
+/*
+    Exits if a command left a transaction open on the Ndb object of the
+    worker, other than those of SET uploads and GET downloads. Only
+    meaningful once no command of the worker is in flight anymore.
+*/
+void verify_transactions_closed(struct worker_context *ctx);
+
+/*
+    Executes one command and appends its reply to the response. The task
+    waits for RonDB on execute_async, see coroutine.h.
+*/
+ndb_task rondb_redis_handler(const pink::RedisCmdArgsViewType &argv,
+                             pink::RespWriter *response,
+                             struct worker_context *ctx);
 #endif
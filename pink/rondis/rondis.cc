@@ -10,13 +10,43 @@
 #include "pink/include/pink_thread.h"
 #include "pink/src/dispatch_thread.h"
 #include "rondb.h"
+#include "cluster_topology.h"
+#include "coroutine.h"
+#include "pipeline.h"
+#include "executor.h"
+#include "worker_context.h"
 #include "common.h"
+#include "string/commands.h"
+#include "string/value_reclaimer.h"
+#include "string/read_cache.h"
 
 using namespace pink;
 
 std::vector<Ndb *> ndb_objects;
 std::map<std::string, std::string> db;
 
+// Executors for streams with large values, see is_large_command_stream()
+static std::vector<struct executor *> large_value_executors;
+static std::atomic<Uint32> next_large_value_executor(0);
+
+// Returns nullptr if there are no large value executors
+static struct executor *next_large_value_executor_or_null()
+{
+    if (large_value_executors.empty())
+        return nullptr;
+    Uint32 index = next_large_value_executor.fetch_add(1) % large_value_executors.size();
+    return large_value_executors[index];
+}
+
+static void destroy_large_value_executors()
+{
+    for (struct executor *exec : large_value_executors)
+    {
+        destroy_executor(exec);
+    }
+    large_value_executors.clear();
+}
+
 class RondisHandle : public ServerHandle
 {
 public:
@@ -25,15 +55,37 @@ public:
     /*
         We define this so each connection knows from which worker thread it is
         running from. This enables us to to distribute Ndb objects across
-        multiple worker threads.
+        multiple worker threads. Each worker thread gets an executor that
+        uses its Ndb object.
     */
     int CreateWorkerSpecificData(void **data) const override
     {
         std::lock_guard<std::mutex> lock(mutex);
-        *data = new int(counter++);
+        struct executor *exec = create_executor(counter++);
+        if (exec == nullptr)
+        {
+            return -1;
+        }
+        *data = exec;
         return 0;
     }
 
+    int DeleteWorkerSpecificData(void *data) const override
+    {
+        destroy_executor(static_cast<struct executor *>(data));
+        return 0;
+    }
+
+    /*
+        Hands the commands that the connections of this worker read during
+        the last epoll iteration to its executor, which executes them in as
+        few round trips as possible.
+    */
+    void WorkerBatchHandle(void *data) const override
+    {
+        executor_submit(static_cast<struct executor *>(data));
+    }
+
 private:
     mutable std::mutex mutex;
     mutable int counter;
@@ -46,38 +98,200 @@ public:
         int fd,
         const std::string &ip_port,
         Thread *thread,
-        void *worker_specific_data);
-    virtual ~RondisConn() = default;
+        void *worker_specific_data,
+        PinkEpoll *pink_epoll);
+    virtual ~RondisConn();
 
 protected:
     int DealMessage(const RedisCmdArgsType &argv, std::string *response) override;
+    int DealMessageView(const RedisCmdArgsViewType &argv, std::string *response) override;
+    void ProcessRedisCmdViews(const std::vector<RedisCmdArgsViewType> &argvs,
+                              bool async,
+                              std::string *response) override;
+    bool StartBulkStream(const RedisCmdArgsViewType &leading_args, long bulk_len) override;
+    int DealBulkChunk(std::string_view chunk, bool last) override;
+    bool ContinueReply() override;
 
 private:
-    int _worker_id;
+    struct executor *_exec;
+    // The SET whose value is streamed in, and the executor of all its steps
+    std::shared_ptr<struct set_upload> _upload;
+    struct executor *_upload_exec;
+    /*
+        The GET whose value is sent while it is read, and the executor
+        that the last commands went to, which runs all of its steps
+    */
+    std::shared_ptr<struct get_download> _download;
+    struct executor *_download_exec;
 };
 
 RondisConn::RondisConn(
     int fd,
     const std::string &ip_port,
     Thread *thread,
-    void *worker_specific_data)
-    : RedisConn(fd, ip_port, thread)
+    void *worker_specific_data,
+    PinkEpoll *pink_epoll)
+    : RedisConn(fd, ip_port, thread, pink_epoll, kAsynchronous)
 {
-    int worker_id = *static_cast<int *>(worker_specific_data);
-    _worker_id = worker_id;
+    _exec = static_cast<struct executor *>(worker_specific_data);
+    _upload_exec = nullptr;
+    _download = std::make_shared<struct get_download>();
+    init_get_download(_download.get());
+    _download_exec = _exec;
+    // Values are passed on to RonDB straight from the read buffer
+    SetParseInPlace(true);
+    // Larger values are written as they arrive, see StartBulkStream()
+    SetBulkStreamThreshold(LARGE_COMMAND_LEN);
+}
+
+RondisConn::~RondisConn()
+{
+    if (_upload != nullptr)
+    {
+        // Its transaction belongs to the Ndb object of the executor
+        pipeline_stream stream;
+        stream.response = nullptr;
+        stream.next_cmd = 0;
+        stream.upload = std::move(_upload);
+        executor_submit_stream(_upload_exec, std::move(stream));
+    }
+    if (_download->trans != nullptr)
+    {
+        pipeline_stream stream;
+        stream.response = nullptr;
+        stream.next_cmd = 0;
+        stream.download = std::move(_download);
+        executor_submit_stream(_download_exec, std::move(stream));
+    }
 }
 
 int RondisConn::DealMessage(const RedisCmdArgsType &argv, std::string *response)
+{
+    RedisCmdArgsViewType argv_view(argv.begin(), argv.end());
+    return DealMessageView(argv_view, response);
+}
+
+int RondisConn::DealMessageView(const RedisCmdArgsViewType &argv, std::string *response)
 {
     /*    
         printf("Received Redis message: ");
         for (int i = 0; i < argv.size(); i++)
         {
-            printf("%s ", argv[i].c_str());
+            printf("%.*s ", (int)argv[i].size(), argv[i].data());
         }
         printf("\n");
     */
-    return rondb_redis_handler(argv, response, _worker_id);
+    // The response is the buffer of resp_writer()
+    struct worker_context *ctx = _exec->ctx;
+    int ret = run_ndb_task(ctx, rondb_redis_handler(argv, resp_writer(), ctx));
+    verify_transactions_closed(ctx);
+    return ret;
+}
+
+/*
+    The commands are only collected here, they are handed to the executor
+    together with those of the other connections of this worker in
+    WorkerBatchHandle(). The arguments point into the read buffer of the
+    connection, which is not read again before the executor hands the
+    connection back. Streams with large values go to one of the large
+    value executors right away.
+*/
+void RondisConn::ProcessRedisCmdViews(const std::vector<RedisCmdArgsViewType> &argvs,
+                                      bool async,
+                                      std::string *response)
+{
+    pipeline_stream stream;
+    stream.conn = std::static_pointer_cast<RedisConn>(shared_from_this());
+    stream.argvs = argvs;
+    stream.response = resp_writer();
+    stream.next_cmd = 0;
+    stream.download = _download;
+    if (_upload != nullptr)
+    {
+        // The first command is the SET whose value was streamed in
+        stream.upload = std::move(_upload);
+        _download_exec = _upload_exec;
+        executor_submit_stream(_upload_exec, std::move(stream));
+        return;
+    }
+    if (is_large_command_stream(stream))
+    {
+        struct executor *exec = next_large_value_executor_or_null();
+        if (exec != nullptr)
+        {
+            _download_exec = exec;
+            executor_submit_stream(exec, std::move(stream));
+            return;
+        }
+    }
+    _download_exec = _exec;
+    _exec->collected.push_back(std::move(stream));
+}
+
+/*
+    Only SET key value is streamed, its value rows are then written while
+    the rest of the value is still being read (see set_upload). All steps
+    of the upload run on one executor, since they share a transaction.
+*/
+bool RondisConn::StartBulkStream(const RedisCmdArgsViewType &leading_args, long bulk_len)
+{
+    if (leading_args.size() != 2 ||
+        !equals_ignore_case(leading_args[0], "SET") ||
+        bulk_len > UINT32_MAX)
+    {
+        return false;
+    }
+    _upload = std::make_shared<struct set_upload>();
+    init_set_upload(_upload.get(), leading_args[1], bulk_len);
+    _upload_exec = next_large_value_executor_or_null();
+    if (_upload_exec == nullptr)
+    {
+        _upload_exec = _exec;
+    }
+    return true;
+}
+
+int RondisConn::DealBulkChunk(std::string_view chunk, bool last)
+{
+    if (!set_upload_append(_upload.get(), chunk) || last)
+    {
+        return 0;
+    }
+    // The connection is read again once the value rows are written
+    pipeline_stream stream;
+    stream.conn = std::static_pointer_cast<RedisConn>(shared_from_this());
+    stream.response = resp_writer();
+    stream.next_cmd = 0;
+    stream.upload = _upload;
+    executor_submit_stream(_upload_exec, std::move(stream));
+    return 1;
+}
+
+/*
+    Once the start of a large GET value is sent, the next value rows are
+    read (see get_download). Reading them only when the socket took the
+    previous ones bounds the memory of a GET to a few value rows, however
+    slow the client.
+*/
+bool RondisConn::ContinueReply()
+{
+    if (_download->failed)
+    {
+        // The reply ends in the middle of the value
+        SetClose(true);
+        return false;
+    }
+    if (_download->trans == nullptr || IsClose())
+    {
+        return false;
+    }
+    pipeline_stream stream;
+    stream.conn = std::static_pointer_cast<RedisConn>(shared_from_this());
+    stream.response = resp_writer();
+    stream.next_cmd = 0;
+    stream.download = _download;
+    executor_submit_stream(_download_exec, std::move(stream));
+    return true;
 }
 
 class RondisConnFactory : public ConnFactory
@@ -90,7 +304,7 @@ public:
         void *worker_specific_data,
         pink::PinkEpoll *pink_epoll = nullptr) const
     {
-        return std::make_shared<RondisConn>(connfd, ip_port, thread, worker_specific_data);
+        return std::make_shared<RondisConn>(connfd, ip_port, thread, worker_specific_data, pink_epoll);
     }
 };
 
@@ -117,30 +331,97 @@ int main(int argc, char *argv[])
     int port = 6379;
     const char *connect_string = "localhost:13000";
     int worker_threads = 2;
-    if (argc != 4)
+    int batch_wait_us = 0;
+    int large_value_threads = 1;
+    int read_cache_mb = 0;
+    if (argc < 4 || argc > 7)
     {
-        printf("Not receiving 3 arguments, just using defaults\n");
+        printf("Not receiving 3 to 6 arguments, just using defaults\n");
     }
     else
     {
         port = atoi(argv[1]);
         connect_string = argv[2];
         worker_threads = atoi(argv[3]);
+        if (argc >= 5)
+        {
+            batch_wait_us = atoi(argv[4]);
+        }
+        if (argc >= 6)
+        {
+            large_value_threads = atoi(argv[5]);
+        }
+        if (argc == 7)
+        {
+            read_cache_mb = atoi(argv[6]);
+        }
     }
     printf("Server will listen to %d and connect to MGMd at %s\n", port, connect_string);
 
-    if (worker_threads < MAX_CONNECTIONS) {
-        printf("Number of worker threads must be at least %d, otherwise we are wasting resources\n", MAX_CONNECTIONS);
+    if (worker_threads < 1) {
+        printf("Number of worker threads must be at least 1\n");
+        return -1;
+    }
+    if (batch_wait_us < 0) {
+        printf("Batch wait must not be negative\n");
+        return -1;
+    }
+    if (large_value_threads < 0) {
+        printf("Number of large value threads must not be negative\n");
+        return -1;
+    }
+    if (read_cache_mb < 0) {
+        printf("Read cache size must not be negative\n");
         return -1;
     }
 
-    ndb_objects.resize(worker_threads);
+    /*
+        The large value executors use the Ndb objects after those of the
+        workers, followed by the one of the value reclaimer and, if enabled,
+        the one of the read cache
+    */
+    int reclaimer_ndb_index = worker_threads + large_value_threads;
+    int num_ndb_objects = reclaimer_ndb_index + 1 + (read_cache_mb > 0 ? 1 : 0);
+    ndb_objects.resize(num_ndb_objects);
 
-    if (setup_rondb(connect_string, worker_threads) != 0)
+    struct cluster_topology topology;
+    if (init_cluster_topology(&topology, num_ndb_objects) != 0)
+    {
+        return -1;
+    }
+    if (setup_rondb(connect_string, num_ndb_objects, &topology) != 0)
     {
         printf("Failed to setup RonDB environment\n");
         return -1;
     }
+    for (int i = 0; i < large_value_threads; i++)
+    {
+        struct executor *exec = create_executor(worker_threads + i);
+        if (exec == nullptr)
+        {
+            printf("Failed to create large value executor\n");
+            destroy_large_value_executors();
+            rondb_end();
+            return -1;
+        }
+        large_value_executors.push_back(exec);
+    }
+    if (start_value_reclaimer(ndb_objects[reclaimer_ndb_index]) != 0)
+    {
+        destroy_large_value_executors();
+        rondb_end();
+        return -1;
+    }
+    if (read_cache_mb > 0 &&
+        start_read_cache(ndb_objects[reclaimer_ndb_index + 1],
+                         (size_t)read_cache_mb * 1024 * 1024) != 0)
+    {
+        printf("Failed to start the read cache\n");
+        destroy_large_value_executors();
+        stop_value_reclaimer();
+        rondb_end();
+        return -1;
+    }
     SignalSetup();
 
     ConnFactory *conn_factory = new RondisConnFactory();
@@ -148,9 +429,14 @@ int main(int argc, char *argv[])
     RondisHandle *handle = new RondisHandle();
 
     ServerThread *my_thread = NewDispatchThread(port, worker_threads, conn_factory, 1000, 1000, handle);
+    my_thread->SetBatchWait(batch_wait_us);
+    my_thread->SetReusePort(true);
     if (my_thread->StartThread() != 0)
     {
         printf("StartThread error happened!\n");
+        destroy_large_value_executors();
+        stop_value_reclaimer();
+        stop_read_cache();
         rondb_end();
         return -1;
     }
@@ -161,6 +447,10 @@ int main(int argc, char *argv[])
         sleep(1);
     }
     my_thread->StopThread();
+    destroy_large_value_executors();
+    // After all commands ran, since DEL queues value rows to it
+    stop_value_reclaimer();
+    stop_read_cache();
 
     delete my_thread;
     delete conn_factory;
@@ -6,6 +6,8 @@ CREATE TABLE string_keys(
     -- This is to save space when referencing the key in the value table
     rondb_key BIGINT UNSIGNED AUTO_INCREMENT NULL,
     -- TODO: Replace with Enum below
+    -- 0: value_start is stored as is, 1: compressed with deflate,
+    -- 2: an INCR counter stored as a binary 64-bit integer
     value_data_type INT UNSIGNED NOT NULL,
     -- value_data_type ENUM('string', 'number', 'binary_string'),
     -- Max 512MiB --> 512 * 1,048,576 bytes = 536,870,912 characters
@@ -1,7 +1,11 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <limits.h>
+#include <algorithm>
+#include <memory>
 #include "pink/include/redis_conn.h"
+#include "slash/include/slash_string.h"
 #include <ndbapi/NdbApi.hpp>
 #include <ndbapi/Ndb.hpp>
 
@@ -9,16 +13,19 @@
 #include "commands.h"
 #include "../common.h"
 #include "table_definitions.h"
+#include "value_reclaimer.h"
+#include "read_cache.h"
+#include "value_encoding.h"
+#include "../coroutine.h"
+#include "../worker_context.h"
 
 bool setup_transaction(
-    Ndb *ndb,
-    std::string *response,
+    struct worker_context *ctx,
+    pink::RespWriter *response,
     Uint64 redis_key_id,
     struct key_table *key_row,
     const char *key_str,
     Uint32 key_len,
-    const NdbDictionary::Dictionary **ret_dict,
-    const NdbDictionary::Table **ret_tab,
     NdbTransaction **ret_trans)
 {
     if (key_len > MAX_KEY_VALUE_LEN)
@@ -26,22 +33,11 @@ bool setup_transaction(
         assign_generic_err_to_response(response, REDIS_KEY_TOO_LARGE);
         return false;
     }
-    const NdbDictionary::Dictionary *dict = ndb->getDictionary();
-    if (dict == nullptr)
-    {
-        assign_ndb_err_to_response(response, FAILED_GET_DICT, ndb->getNdbError());
-        return false;
-    }
-    const NdbDictionary::Table *tab = dict->getTable(KEY_TABLE_NAME);
-    if (tab == nullptr)
-    {
-        assign_ndb_err_to_response(response, FAILED_CREATE_TABLE_OBJECT, dict->getNdbError());
-        return false;
-    }
+    Ndb *ndb = ctx->ndb;
     key_row->redis_key_id = redis_key_id;
     memcpy(&key_row->redis_key[2], key_str, key_len);
     set_length((char*)&key_row->redis_key[0], key_len);
-    NdbTransaction *trans = ndb->startTransaction(tab,
+    NdbTransaction *trans = ndb->startTransaction(ctx->key_tab,
                                                   (const char*)&key_row->redis_key_id,
                                                   key_len + 10);
     if (trans == nullptr)
@@ -51,12 +47,95 @@ bool setup_transaction(
                                    ndb->getNdbError());
         return false;
     }
-    *ret_tab = tab;
     *ret_trans = trans;
-    *ret_dict = dict;
     return true;
 }
 
+/*
+    Reads the next value rows of a download into the reply, followed by the
+    end of the reply after the last value row. A failure is written to
+    error and rolls the download back.
+*/
+static
+ndb_task read_get_download_rows(struct worker_context *ctx,
+                                struct get_download *download,
+                                pink::RespWriter *response,
+                                pink::RespWriter *error)
+{
+    Uint32 num_rows = std::min((Uint32)GET_DOWNLOAD_ROWS,
+                               download->num_rows - download->next_ordinal);
+    bool is_last = download->next_ordinal + num_rows == download->num_rows;
+    std::shared_ptr<struct value_table[]> value_rows(
+        new struct value_table[num_rows]);
+    for (Uint32 i = 0; i < num_rows; i += ROWS_PER_READ)
+    {
+        Uint32 num_rows_to_read = std::min(ROWS_PER_READ, num_rows - i);
+        bool is_last_batch = is_last && i + num_rows_to_read == num_rows;
+        if (co_await read_batched_value_rows(error,
+                                             ctx,
+                                             download->trans,
+                                             download->rondb_key,
+                                             num_rows_to_read,
+                                             download->next_ordinal + i,
+                                             is_last_batch ?
+                                               NdbTransaction::Commit :
+                                               NdbTransaction::NoCommit,
+                                             &value_rows[i]) != 0)
+        {
+            get_download_abort(ctx, download);
+            co_return -1;
+        }
+    }
+    append_value_rows(response, value_rows.get(), num_rows);
+    response->Retain(value_rows);
+    download->next_ordinal += num_rows;
+    if (is_last)
+    {
+        response->Append("\r\n");
+        // Only closes the transaction, which is committed already
+        get_download_abort(ctx, download);
+    }
+    co_return 0;
+}
+
+/*
+    Replies with the start of a value that has value rows, reading the key
+    row with a shared lock in trans. The transaction is kept by the
+    download if value rows are left after the first ones, otherwise it is
+    closed.
+*/
+static
+ndb_task start_get_download(struct worker_context *ctx,
+                            pink::RespWriter *response,
+                            NdbTransaction *trans,
+                            struct key_table *key_row,
+                            struct get_download *download)
+{
+    if (co_await read_locked_key_row(response, ctx, trans, key_row) != 0)
+    {
+        ctx->ndb->closeTransaction(trans);
+        co_return 0;
+    }
+    if (key_row->num_rows == 0)
+    {
+        // Changed since the first read
+        append_inline_value(response, key_row);
+        ctx->ndb->closeTransaction(trans);
+        co_return 0;
+    }
+    response->AppendBulkHeader(key_row->tot_value_len);
+    response->Append(&key_row->value_start[2],
+                     get_length((char *)&key_row->value_start[0]));
+    download->trans = trans;
+    download->rondb_key = key_row->rondb_key;
+    download->num_rows = key_row->num_rows;
+    download->next_ordinal = 0;
+    ctx->num_open_streams++;
+    // Nothing was sent yet, so an error replaces the start of the reply
+    co_await read_get_download_rows(ctx, download, response, response);
+    co_return 0;
+}
+
 /*
     A successful GET will return in this format:
         $5
@@ -70,49 +149,71 @@ bool setup_transaction(
     The key does not exist.
         $0
     The key exists but has no value (empty string).
+
+    With a download, a value too large for a linked query is only replied
+    to in part, see get_download.
 */
 static
-void rondb_get(Ndb *ndb,
-               const pink::RedisCmdArgsType &argv,
-               std::string *response,
-               Uint64 redis_key_id)
+ndb_task rondb_get(struct worker_context *ctx,
+                   const pink::RedisCmdArgsViewType &argv,
+                   pink::RespWriter *response,
+                   Uint64 redis_key_id,
+                   struct get_download *download)
 {
+    Ndb *ndb = ctx->ndb;
     Uint32 arg_index_start = (redis_key_id == STRING_REDIS_KEY_ID) ? 1 : 2;
-    const NdbDictionary::Dictionary *dict;
-    const NdbDictionary::Table *tab = nullptr;
     NdbTransaction *trans = nullptr;
     struct key_table key_row;
-    const char *key_str = argv[arg_index_start].c_str();
+    const char *key_str = argv[arg_index_start].data();
     Uint32 key_len = argv[arg_index_start].size();
-    if (!setup_transaction(ndb,
+    bool use_cache = redis_key_id == STRING_REDIS_KEY_ID && read_cache_enabled();
+    Uint64 cache_version = 0;
+    if (use_cache)
+    {
+        if (read_cache_get(argv[1], response))
+            co_return 0;
+        cache_version = read_cache_version(argv[1]);
+    }
+    if (!setup_transaction(ctx,
                            response,
                            redis_key_id,
                            &key_row,
                            key_str,
                            key_len,
-                           &dict,
-                           &tab,
                            &trans))
-      return;
+      co_return 0;
 
-    int ret_code = get_simple_key_row(
+    int ret_code = co_await get_simple_key_row(
         response,
-        tab,
-        ndb,
+        ctx,
         trans,
         &key_row);
     ndb->closeTransaction(trans);
+    if (use_cache)
+    {
+        // Values with value rows are not cached
+        if (ret_code == READ_ERROR)
+        {
+            read_cache_put(argv[1], nullptr, cache_version);
+        }
+        else if (ret_code == 0 && key_row.num_rows == 0)
+        {
+            std::string buf;
+            std::string_view value;
+            if (get_inline_value(&key_row, &buf, &value))
+                read_cache_put(argv[1], &value, cache_version);
+        }
+    }
     if ((ret_code != 0) || key_row.num_rows == 0)
     {
-        return;
+        co_return 0;
     }
     {
         /*
-            Our value uses value rows, so a more complex read is required.
-            We're starting from scratch here since we'll use a shared lock
-            on the key table this time we read from it.
+            Our value uses value rows. Read the key row again together with
+            all of its value rows in one linked query.
         */
-        trans = ndb->startTransaction(tab,
+        trans = ndb->startTransaction(ctx->key_tab,
                                       (const char*)&key_row.redis_key_id,
                                       key_len + 10);
         if (trans == nullptr)
@@ -120,52 +221,96 @@ void rondb_get(Ndb *ndb,
             assign_ndb_err_to_response(response,
                                        FAILED_CREATE_TXN_OBJECT,
                                        ndb->getNdbError());
-            return;
+            co_return 0;
         }
-        get_complex_key_row(response,
-                            dict,
-                            tab,
-                            ndb,
-                            trans,
-                            &key_row);
+        ret_code = co_await get_linked_key_row(response, ctx, trans, &key_row);
         ndb->closeTransaction(trans);
-        return;
+        if (ret_code != INCONSISTENT_READ_ERROR)
+            co_return 0;
+
+        /*
+            The value changed while we read it or is too large for a linked
+            query. We're starting from scratch here since we'll use a shared
+            lock on the key table this time we read from it.
+        */
+        trans = ndb->startTransaction(ctx->key_tab,
+                                      (const char*)&key_row.redis_key_id,
+                                      key_len + 10);
+        if (trans == nullptr)
+        {
+            assign_ndb_err_to_response(response,
+                                       FAILED_CREATE_TXN_OBJECT,
+                                       ndb->getNdbError());
+            co_return 0;
+        }
+        if (download != nullptr)
+        {
+            co_return co_await start_get_download(ctx,
+                                                  response,
+                                                  trans,
+                                                  &key_row,
+                                                  download);
+        }
+        co_await get_complex_key_row(response,
+                                     ctx,
+                                     trans,
+                                     &key_row);
+        ndb->closeTransaction(trans);
+        co_return 0;
     }
 }
 
+/*
+    Writes the key row of a SET with the inline part of the value and
+    allocates the rondb_key of its value rows, replacing the value rows of
+    the previous value within the same transaction if there are any.
+    value_str only needs to hold the inline part. If compressed is not
+    nullptr, it is stored instead of the value, which then has no value
+    rows. Returns 0 if the value rows are to be written in the transaction
+    left in *ret_trans, followed by commit_set(). Otherwise the SET is
+    complete and replied to.
+*/
 static
-void rondb_set(
-    Ndb *ndb,
-    const pink::RedisCmdArgsType &argv,
-    std::string *response,
-    Uint64 redis_key_id)
+ndb_task write_set_key_row(
+    struct worker_context *ctx,
+    pink::RespWriter *response,
+    Uint64 redis_key_id,
+    const char *key_str,
+    Uint32 key_len,
+    const char *value_str,
+    Uint32 value_len,
+    const std::string *compressed,
+    Uint64 &rondb_key,
+    Uint32 &num_value_rows,
+    Uint32 &prev_num_rows,
+    NdbTransaction **ret_trans)
 {
-    Uint32 arg_index_start = (redis_key_id == STRING_REDIS_KEY_ID) ? 1 : 2;
-    const NdbDictionary::Dictionary *dict;
-    const NdbDictionary::Table *tab = nullptr;
+    Ndb *ndb = ctx->ndb;
     NdbTransaction *trans = nullptr;
     struct key_table key_row;
-    const char *key_str = argv[arg_index_start].c_str();
-    Uint32 key_len = argv[arg_index_start].size();
-    if (!setup_transaction(ndb,
+    if (!setup_transaction(ctx,
                            response,
                            redis_key_id,
                            &key_row,
                            key_str,
                            key_len,
-                           &dict,
-                           &tab,
                            &trans))
-      return;
+      co_return 1;
 
-    const char *value_str = argv[arg_index_start + 1].c_str();
-    Uint32 value_len = argv[arg_index_start + 1].size();
-    char varsize_param[EXTENSION_VALUE_LEN + 500];
-    Uint32 num_value_rows = 0;
-    Uint32 prev_num_rows = 0;
-    Uint64 rondb_key = 0;
+    num_value_rows = 0;
+    prev_num_rows = 0;
+    rondb_key = 0;
 
-    if (value_len > INLINE_VALUE_LEN)
+    const char *inline_value = value_str;
+    Uint32 inline_value_len = std::min(value_len, Uint32(INLINE_VALUE_LEN));
+    Uint32 value_data_type = VALUE_DATA_TYPE_RAW;
+    if (compressed != nullptr)
+    {
+        inline_value = compressed->data();
+        inline_value_len = compressed->size();
+        value_data_type = VALUE_DATA_TYPE_DEFLATE;
+    }
+    else if (value_len > INLINE_VALUE_LEN)
     {
         /**
          * The row doesn't fit in one RonDB row, create more rows
@@ -183,33 +328,34 @@ void rondb_set(
             num_value_rows++;
         }
 
-        if (rondb_get_rondb_key(tab, rondb_key, ndb, response) != 0)
+        if (rondb_get_rondb_key(ctx->key_tab, rondb_key, ndb, response) != 0)
         {
             ndb->closeTransaction(trans);
-            return;
+            co_return 1;
         }
     }
 
     int ret_code = 0;
-    ret_code = create_key_row(response,
-                              tab,
-                              trans,
-                              redis_key_id,
-                              rondb_key,
-                              key_str,
-                              key_len,
-                              value_str,
-                              value_len,
-                              num_value_rows,
-                              prev_num_rows,
-                              Uint32(0));
+    ret_code = co_await create_key_row(response,
+                                       ctx,
+                                       trans,
+                                       redis_key_id,
+                                       rondb_key,
+                                       key_str,
+                                       key_len,
+                                       inline_value,
+                                       value_len,
+                                       inline_value_len,
+                                       num_value_rows,
+                                       prev_num_rows,
+                                       value_data_type);
     if (ret_code != 0)
     {
         // Often unnecessary since it already failed to commit
         ndb->closeTransaction(trans);
         if (ret_code != RESTRICT_VALUE_ROWS_ERROR)
         {
-            return;
+            co_return 1;
         }
         /*
             If we are here, we have tried writing a key that already exists.
@@ -218,39 +364,117 @@ void rondb_set(
             is best done via a cascade delete. We do a delete & insert in
             a single transaction (plus writing the value rows).
         */
-        trans = ndb->startTransaction(tab,
+        trans = ndb->startTransaction(ctx->key_tab,
                                       (const char*)&key_row.redis_key_id,
                                       key_len + 10);
         if (trans == nullptr)
         {
             assign_ndb_err_to_response(response, FAILED_CREATE_TXN_OBJECT, ndb->getNdbError());
-            return;
+            co_return 1;
         }
         /**
          * We don't know the exact number of value rows, but we know that it is
          * at least one.
          */
         prev_num_rows = 1;
-        ret_code = create_key_row(response,
-                                  tab,
-                                  trans,
-                                  redis_key_id,
-                                  rondb_key,
-                                  key_str,
-                                  key_len,
-                                  value_str,
-                                  value_len,
-                                  num_value_rows,
-                                  prev_num_rows,
-                                  Uint32(0));
+        ret_code = co_await create_key_row(response,
+                                           ctx,
+                                           trans,
+                                           redis_key_id,
+                                           rondb_key,
+                                           key_str,
+                                           key_len,
+                                           inline_value,
+                                           value_len,
+                                           inline_value_len,
+                                           num_value_rows,
+                                           prev_num_rows,
+                                           value_data_type);
         if (ret_code != 0) {
             ndb->closeTransaction(trans);
-            return;
+            co_return 1;
         }
     } else if (num_value_rows == 0) {
         ndb->closeTransaction(trans);
-        response->append("+OK\r\n");
-        return;
+        response->Append(REDIS_OK);
+        co_return 1;
+    }
+    *ret_trans = trans;
+    co_return 0;
+}
+
+/*
+    Deletes the value rows of the previous value that are beyond the new
+    ones, commits and replies to the SET. Closes the transaction.
+*/
+static
+ndb_task commit_set(
+    struct worker_context *ctx,
+    pink::RespWriter *response,
+    NdbTransaction *trans,
+    Uint64 rondb_key,
+    Uint32 num_value_rows,
+    Uint32 prev_num_rows)
+{
+    Ndb *ndb = ctx->ndb;
+    int ret_code = co_await delete_value_rows(response,
+                                              ctx,
+                                              ctx->key_tab,
+                                              trans,
+                                              rondb_key,
+                                              num_value_rows,
+                                              prev_num_rows);
+    if (ret_code != 0) {
+        ndb->closeTransaction(trans);
+        co_return 0;
+    }
+    if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                               NdbOperation::AbortOnError) == 0 &&
+        trans->getNdbError().code != 0)
+    {
+        ndb->closeTransaction(trans);
+        assign_ndb_err_to_response(response,
+                                   FAILED_EXEC_TXN,
+                                   trans->getNdbError());
+        co_return 0;
+    }
+    ndb->closeTransaction(trans);
+    response->Append(REDIS_OK);
+    co_return 0;
+}
+
+static
+ndb_task rondb_set(
+    struct worker_context *ctx,
+    pink::RespWriter *response,
+    Uint64 redis_key_id,
+    const char *key_str,
+    Uint32 key_len,
+    const char *value_str,
+    Uint32 value_len)
+{
+    Ndb *ndb = ctx->ndb;
+    NdbTransaction *trans = nullptr;
+    Uint32 num_value_rows = 0;
+    Uint32 prev_num_rows = 0;
+    Uint64 rondb_key = 0;
+    std::string compressed;
+    bool is_compressed = compress_value(std::string_view(value_str, value_len),
+                                        &compressed);
+    if (co_await write_set_key_row(ctx,
+                                   response,
+                                   redis_key_id,
+                                   key_str,
+                                   key_len,
+                                   value_str,
+                                   value_len,
+                                   is_compressed ? &compressed : nullptr,
+                                   rondb_key,
+                                   num_value_rows,
+                                   prev_num_rows,
+                                   &trans) != 0)
+    {
+        co_return 0;
     }
     /**
      * Coming here means that we either have to add new value rows or we have
@@ -259,135 +483,768 @@ void rondb_set(
      * remaining value rows from the previous instantiation of the row.
      */
     if (num_value_rows > 0) {
-        ret_code = create_all_value_rows(response,
-                                         ndb,
-                                         dict,
-                                         trans,
-                                         rondb_key,
-                                         value_str,
-                                         value_len,
-                                         num_value_rows,
-                                         &varsize_param[0]);
+        int ret_code = co_await create_all_value_rows(response,
+                                                      ctx,
+                                                      trans,
+                                                      rondb_key,
+                                                      value_str,
+                                                      value_len,
+                                                      num_value_rows,
+                                                      &ctx->varsize_param[0]);
+        if (ret_code != 0) {
+            ndb->closeTransaction(trans);
+            co_return 0;
+        }
     }
-    if (ret_code != 0) {
-        ndb->closeTransaction(trans);
-        return;
+    co_return co_await commit_set(ctx,
+                                  response,
+                                  trans,
+                                  rondb_key,
+                                  num_value_rows,
+                                  prev_num_rows);
+}
+
+void init_set_upload(struct set_upload *upload,
+                     std::string_view key,
+                     Uint32 value_len)
+{
+    upload->key.assign(key.data(), key.size());
+    upload->value_len = value_len;
+    upload->inline_value.clear();
+    upload->inline_value.reserve(INLINE_VALUE_LEN);
+    upload->pending_rows.clear();
+    upload->next_ordinal = 0;
+    upload->rondb_key = 0;
+    upload->num_value_rows = 0;
+    upload->prev_num_rows = 0;
+    upload->trans = nullptr;
+    upload->failed = false;
+}
+
+bool set_upload_append(struct set_upload *upload, std::string_view chunk)
+{
+    if (upload->inline_value.size() < INLINE_VALUE_LEN)
+    {
+        size_t inline_len = std::min(chunk.size(),
+                                     INLINE_VALUE_LEN - upload->inline_value.size());
+        upload->inline_value.append(chunk.data(), inline_len);
+        chunk.remove_prefix(inline_len);
     }
-    ret_code = delete_value_rows(response,
-                                 tab,
-                                 trans,
-                                 rondb_key,
-                                 num_value_rows,
-                                 prev_num_rows);
-    if (ret_code != 0) {
-        ndb->closeTransaction(trans);
-        return;
+    if (upload->failed)
+    {
+        // The SET replies with the error once the whole value is read
+        return false;
     }
-    if (trans->execute(NdbTransaction::Commit,
-                       NdbOperation::AbortOnError) == 0 &&
-        trans->getNdbError().code != 0)
+    upload->pending_rows.append(chunk.data(), chunk.size());
+    return upload->pending_rows.size() >= SET_UPLOAD_ROWS * EXTENSION_VALUE_LEN;
+}
+
+ndb_task rondb_set_upload_step(struct worker_context *ctx,
+                               struct set_upload *upload,
+                               bool last,
+                               pink::RespWriter *response)
+{
+    if (!upload->failed && upload->trans == nullptr)
     {
-        ndb->closeTransaction(trans);
-        assign_ndb_err_to_response(response,
-                                   FAILED_EXEC_TXN,
-                                   trans->getNdbError());
+        // The first step, the inline part of the value is complete
+        if (co_await write_set_key_row(ctx,
+                                       &upload->error,
+                                       STRING_REDIS_KEY_ID,
+                                       upload->key.data(),
+                                       upload->key.size(),
+                                       upload->inline_value.data(),
+                                       upload->value_len,
+                                       nullptr,
+                                       upload->rondb_key,
+                                       upload->num_value_rows,
+                                       upload->prev_num_rows,
+                                       &upload->trans) != 0)
+        {
+            upload->failed = true;
+        }
+        else
+        {
+            ctx->num_open_streams++;
+        }
+    }
+    if (!upload->failed)
+    {
+        // Partial value rows are left for the next step
+        Uint32 write_len = upload->pending_rows.size();
+        if (!last)
+        {
+            write_len -= write_len % EXTENSION_VALUE_LEN;
+        }
+        if (co_await create_value_rows(&upload->error,
+                                       ctx,
+                                       upload->trans,
+                                       upload->rondb_key,
+                                       upload->pending_rows.data(),
+                                       write_len,
+                                       upload->next_ordinal,
+                                       &ctx->varsize_param[0]) != 0)
+        {
+            set_upload_abort(ctx, upload);
+            upload->failed = true;
+        }
+        else
+        {
+            upload->next_ordinal += write_len / EXTENSION_VALUE_LEN;
+            upload->pending_rows.erase(0, write_len);
+        }
+    }
+    if (!last)
+    {
+        co_return 0;
+    }
+    if (upload->failed)
+    {
+        response->Append(&upload->error);
+        co_return 0;
+    }
+    NdbTransaction *trans = upload->trans;
+    upload->trans = nullptr;
+    ctx->num_open_streams--;
+    int ret_code = co_await commit_set(ctx,
+                                       response,
+                                       trans,
+                                       upload->rondb_key,
+                                       upload->num_value_rows,
+                                       upload->prev_num_rows);
+    read_cache_invalidate(upload->key);
+    co_return ret_code;
+}
+
+void set_upload_abort(struct worker_context *ctx, struct set_upload *upload)
+{
+    if (upload->trans == nullptr)
         return;
+    ctx->ndb->closeTransaction(upload->trans);
+    upload->trans = nullptr;
+    ctx->num_open_streams--;
+}
+
+void init_get_download(struct get_download *download)
+{
+    download->trans = nullptr;
+    download->rondb_key = 0;
+    download->num_rows = 0;
+    download->next_ordinal = 0;
+    download->failed = false;
+}
+
+ndb_task rondb_get_download_step(struct worker_context *ctx,
+                                 struct get_download *download,
+                                 pink::RespWriter *response)
+{
+    // Part of the value was sent already, an error reply cannot follow
+    pink::RespWriter error;
+    if (co_await read_get_download_rows(ctx, download, response, &error) != 0)
+    {
+        download->failed = true;
     }
-    ndb->closeTransaction(trans);
-    response->append("+OK\r\n");
-    return;
+    co_return 0;
+}
+
+void get_download_abort(struct worker_context *ctx, struct get_download *download)
+{
+    if (download->trans == nullptr)
+        return;
+    ctx->ndb->closeTransaction(download->trans);
+    download->trans = nullptr;
+    ctx->num_open_streams--;
 }
 
 static
-void rondb_incr(
-    Ndb *ndb,
-    const pink::RedisCmdArgsType &argv,
-    std::string *response,
-    Uint64 redis_key_id)
+ndb_task rondb_incr(
+    struct worker_context *ctx,
+    const pink::RedisCmdArgsViewType &argv,
+    pink::RespWriter *response,
+    Uint64 redis_key_id,
+    Int64 increment)
 {
+    Ndb *ndb = ctx->ndb;
     Uint32 arg_index_start = (redis_key_id == STRING_REDIS_KEY_ID) ? 1 : 2;
-    const NdbDictionary::Dictionary *dict;
-    const NdbDictionary::Table *tab = nullptr;
     NdbTransaction *trans = nullptr;
     struct key_table key_row;
-    const char *key_str = argv[arg_index_start].c_str();
+    const char *key_str = argv[arg_index_start].data();
     Uint32 key_len = argv[arg_index_start].size();
-    if (!setup_transaction(ndb,
+    if (!setup_transaction(ctx,
                            response,
                            redis_key_id,
                            &key_row,
                            key_str,
                            key_len,
-                           &dict,
-                           &tab,
                            &trans))
-      return;
+      co_return 0;
 
-    incr_key_row(response,
-                 ndb,
-                 tab,
-                 trans,
-                 &key_row);
+    co_await incr_key_row(response,
+                          ctx,
+                          trans,
+                          &key_row,
+                          increment);
     ndb->closeTransaction(trans);
-    return;
+    co_return 0;
+}
+
+ndb_task rondb_get_command(struct worker_context *ctx,
+                           const pink::RedisCmdArgsViewType &argv,
+                           pink::RespWriter *response)
+{
+  return rondb_get(ctx, argv, response, STRING_REDIS_KEY_ID, nullptr);
+}
+
+ndb_task rondb_get_download_command(struct worker_context *ctx,
+                                    const pink::RedisCmdArgsViewType &argv,
+                                    pink::RespWriter *response,
+                                    struct get_download *download)
+{
+  return rondb_get(ctx, argv, response, STRING_REDIS_KEY_ID, download);
+}
+
+ndb_task rondb_set_command(struct worker_context *ctx,
+                           const pink::RedisCmdArgsViewType &argv,
+                           pink::RespWriter *response)
+{
+  return rondb_set(ctx,
+                   response,
+                   STRING_REDIS_KEY_ID,
+                   argv[1].data(),
+                   argv[1].size(),
+                   argv[2].data(),
+                   argv[2].size());
+}
+
+ndb_task rondb_incr_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response)
+{
+  return rondb_incr(ctx, argv, response, STRING_REDIS_KEY_ID, 1);
 }
 
-void rondb_get_command(Ndb *ndb,
-                       const pink::RedisCmdArgsType &argv,
-                       std::string *response)
+ndb_task rondb_decr_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response)
 {
-  return rondb_get(ndb, argv, response, STRING_REDIS_KEY_ID);
+  return rondb_incr(ctx, argv, response, STRING_REDIS_KEY_ID, -1);
 }
 
-void rondb_set_command(Ndb *ndb,
-                       const pink::RedisCmdArgsType &argv,
-                       std::string *response)
+ndb_task rondb_incrby_command(struct worker_context *ctx,
+                              const pink::RedisCmdArgsViewType &argv,
+                              pink::RespWriter *response)
 {
-  return rondb_set(ndb, argv, response, STRING_REDIS_KEY_ID);
+  long long increment;
+  if (slash::string2ll(argv[2].data(), argv[2].size(), &increment) == 0)
+  {
+    assign_generic_err_to_response(response, REDIS_NOT_AN_INTEGER);
+    co_return 0;
+  }
+  co_return co_await rondb_incr(ctx, argv, response, STRING_REDIS_KEY_ID, increment);
 }
 
-void rondb_incr_command(Ndb *ndb,
-                        const pink::RedisCmdArgsType &argv,
-                        std::string *response)
+ndb_task rondb_decrby_command(struct worker_context *ctx,
+                              const pink::RedisCmdArgsViewType &argv,
+                              pink::RespWriter *response)
 {
-  return rondb_incr(ndb, argv, response, STRING_REDIS_KEY_ID);
+  long long decrement;
+  // The negation of LLONG_MIN does not fit
+  if (slash::string2ll(argv[2].data(), argv[2].size(), &decrement) == 0 ||
+      decrement == LLONG_MIN)
+  {
+    assign_generic_err_to_response(response, REDIS_NOT_AN_INTEGER);
+    co_return 0;
+  }
+  co_return co_await rondb_incr(ctx, argv, response, STRING_REDIS_KEY_ID, -decrement);
 }
 
-void rondb_hget_command(Ndb *ndb,
-                        const pink::RedisCmdArgsType &argv,
-                        std::string *response)
+ndb_task rondb_hget_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response)
 {
   Uint64 redis_key_id;
-  int ret_code = rondb_get_redis_key_id(ndb,
-                                       redis_key_id,
-                                       argv[1].c_str(),
-                                       argv[1].size(),
-                                       response);
-  return rondb_get(ndb, argv, response, redis_key_id);
+  // A hash that does not exist is not created just to reply nil
+  int ret_code = co_await rondb_find_redis_key_id(ctx,
+                                                 redis_key_id,
+                                                 argv[1].data(),
+                                                 argv[1].size(),
+                                                 response);
+  if (ret_code != 0)
+    co_return 0;
+  co_return co_await rondb_get(ctx, argv, response, redis_key_id, nullptr);
 }
 
-void rondb_hset_command(Ndb *ndb,
-                        const pink::RedisCmdArgsType &argv,
-                        std::string *response)
+ndb_task rondb_hset_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response)
 {
   Uint64 redis_key_id;
-  int ret_code = rondb_get_redis_key_id(ndb,
-                                       redis_key_id,
-                                       argv[1].c_str(),
-                                       argv[1].size(),
-                                       response);
-  return rondb_set(ndb, argv, response, redis_key_id);
+  int ret_code = co_await rondb_get_redis_key_id(ctx,
+                                                redis_key_id,
+                                                argv[1].data(),
+                                                argv[1].size(),
+                                                response);
+  if (ret_code != 0)
+    co_return 0;
+  co_return co_await rondb_set(ctx,
+                               response,
+                               redis_key_id,
+                               argv[2].data(),
+                               argv[2].size(),
+                               argv[3].data(),
+                               argv[3].size());
 }
 
-void rondb_hincr_command(Ndb *ndb,
-                         const pink::RedisCmdArgsType &argv,
-                         std::string *response)
+ndb_task rondb_hincr_command(struct worker_context *ctx,
+                             const pink::RedisCmdArgsViewType &argv,
+                             pink::RespWriter *response)
 {
   Uint64 redis_key_id;
-  int ret_code = rondb_get_redis_key_id(ndb,
-                                       redis_key_id,
-                                       argv[1].c_str(),
-                                       argv[1].size(),
-                                       response);
-  return rondb_incr(ndb, argv, response, redis_key_id);
+  int ret_code = co_await rondb_get_redis_key_id(ctx,
+                                                redis_key_id,
+                                                argv[1].data(),
+                                                argv[1].size(),
+                                                response);
+  if (ret_code != 0)
+    co_return 0;
+  co_return co_await rondb_incr(ctx, argv, response, redis_key_id, 1);
+}
+
+static
+bool keys_fit(const pink::RedisCmdArgsViewType &argv,
+              Uint32 arg_index_start,
+              Uint32 arg_step,
+              pink::RespWriter *response)
+{
+    for (Uint32 i = arg_index_start; i < argv.size(); i += arg_step)
+    {
+        if (argv[i].size() > MAX_KEY_VALUE_LEN)
+        {
+            assign_generic_err_to_response(response, REDIS_KEY_TOO_LARGE);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*
+    The key rows of a multi-key command and their operations. They are
+    kept in the frame of the command, since the other commands of the
+    worker run while it waits for RonDB.
+*/
+struct multi_key_rows
+{
+    std::vector<struct key_table> rows;
+    std::vector<struct key_table *> row_ptrs;
+    std::vector<const NdbOperation *> ops;
+};
+
+/*
+    Fills one key row per key in argv and starts a transaction hinted
+    on the first of them.
+*/
+static
+bool setup_multi_key_transaction(struct worker_context *ctx,
+                                 pink::RespWriter *response,
+                                 const pink::RedisCmdArgsViewType &argv,
+                                 Uint32 arg_index_start,
+                                 Uint32 arg_step,
+                                 struct multi_key_rows &keys,
+                                 Uint32 &num_keys,
+                                 NdbTransaction **ret_trans)
+{
+    if (!keys_fit(argv, arg_index_start, arg_step, response))
+        return false;
+
+    num_keys = (argv.size() - arg_index_start + arg_step - 1) / arg_step;
+    keys.rows.resize(num_keys);
+    keys.row_ptrs.resize(num_keys);
+    keys.ops.resize(num_keys);
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        std::string_view key = argv[arg_index_start + i * arg_step];
+        struct key_table *key_row = &keys.rows[i];
+        key_row->redis_key_id = STRING_REDIS_KEY_ID;
+        memcpy(&key_row->redis_key[2], key.data(), key.size());
+        set_length(&key_row->redis_key[0], key.size());
+        keys.row_ptrs[i] = key_row;
+    }
+    std::string_view first_key = argv[arg_index_start];
+    return setup_transaction(ctx,
+                             response,
+                             STRING_REDIS_KEY_ID,
+                             &keys.rows[0],
+                             first_key.data(),
+                             first_key.size(),
+                             ret_trans);
+}
+
+/*
+    The key rows are released with the command, so the inline value is
+    copied. The value rows are referenced, the caller must make the
+    response retain them.
+*/
+static
+void append_bulk_value(pink::RespWriter *response,
+                       const struct key_table *key_row,
+                       const struct value_table *value_rows)
+{
+    if (key_row->num_rows == 0)
+    {
+        append_inline_value(response, key_row);
+        return;
+    }
+    response->AppendBulkHeader(key_row->tot_value_len);
+    response->Append(&key_row->value_start[2],
+                     get_length((char *)&key_row->value_start[0]));
+    append_value_rows(response, value_rows, key_row->num_rows);
+    response->Append("\r\n");
+}
+
+/*
+    All key rows are read in one batch. Keys with value rows are read again
+    under a shared lock, as in GET, and all their value rows are read in one
+    follow-up batch. Hence MGET takes a single round trip unless some of the
+    values have value rows.
+
+    A successful MGET will return in this format:
+        *2
+        $5
+        Hello
+        $-1
+    with one bulk string per key, $-1 for keys that do not exist.
+*/
+ndb_task rondb_mget_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response)
+{
+    Ndb *ndb = ctx->ndb;
+    NdbTransaction *trans = nullptr;
+    struct multi_key_rows keys;
+    Uint32 num_keys = 0;
+    if (!setup_multi_key_transaction(ctx,
+                                     response,
+                                     argv,
+                                     1,
+                                     1,
+                                     keys,
+                                     num_keys,
+                                     &trans))
+        co_return 0;
+
+    struct key_table **key_rows = keys.row_ptrs.data();
+    const NdbOperation **read_ops = keys.ops.data();
+    int ret_code = co_await read_key_rows(response,
+                                          ctx,
+                                          trans,
+                                          key_rows,
+                                          num_keys,
+                                          KEY_TABLE_MASK_ALL_NON_PK,
+                                          NdbOperation::LM_CommittedRead,
+                                          NdbTransaction::Commit,
+                                          read_ops);
+    // The operations are released with the transaction
+    std::vector<bool> found(num_keys);
+    std::vector<struct key_table *> complex_rows;
+    std::vector<Uint32> complex_index;
+    for (Uint32 i = 0; ret_code == 0 && i < num_keys; i++)
+    {
+        found[i] = (read_ops[i]->getNdbError().code == 0);
+        if (found[i] && key_rows[i]->num_rows > 0)
+        {
+            complex_rows.push_back(key_rows[i]);
+            complex_index.push_back(i);
+        }
+    }
+    ndb->closeTransaction(trans);
+    if (ret_code != 0)
+        co_return 0;
+
+    Uint32 num_value_rows = 0;
+    std::shared_ptr<struct value_table[]> value_rows;
+    if (!complex_rows.empty())
+    {
+        Uint32 num_complex = complex_rows.size();
+        trans = ndb->startTransaction(ctx->key_tab,
+                                      (const char *)&complex_rows[0]->redis_key_id,
+                                      get_length(&complex_rows[0]->redis_key[0]) + 10);
+        if (trans == nullptr)
+        {
+            assign_ndb_err_to_response(response,
+                                       FAILED_CREATE_TXN_OBJECT,
+                                       ndb->getNdbError());
+            co_return 0;
+        }
+        ret_code = co_await read_key_rows(response,
+                                          ctx,
+                                          trans,
+                                          complex_rows.data(),
+                                          num_complex,
+                                          KEY_TABLE_MASK_ALL_NON_PK,
+                                          NdbOperation::LM_Read,
+                                          NdbTransaction::NoCommit,
+                                          read_ops);
+        std::vector<struct key_table *> locked_rows;
+        for (Uint32 i = 0; ret_code == 0 && i < num_complex; i++)
+        {
+            if (read_ops[i]->getNdbError().code != 0)
+            {
+                // Deleted in the meantime
+                found[complex_index[i]] = false;
+                continue;
+            }
+            num_value_rows += complex_rows[i]->num_rows;
+            locked_rows.push_back(complex_rows[i]);
+        }
+        if (ret_code == 0)
+        {
+            // Owned by the reply, which refers to the values
+            value_rows.reset(new struct value_table[num_value_rows]);
+            ret_code = co_await read_all_value_rows(response,
+                                                    ctx,
+                                                    trans,
+                                                    locked_rows.data(),
+                                                    locked_rows.size(),
+                                                    value_rows.get());
+        }
+        ndb->closeTransaction(trans);
+        if (ret_code != 0)
+            co_return 0;
+    }
+
+    response->AppendArrayHeader(num_keys);
+    Uint32 value_row_index = 0;
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        if (!found[i])
+        {
+            response->Append(REDIS_NO_SUCH_KEY);
+            continue;
+        }
+        append_bulk_value(response,
+                          key_rows[i],
+                          &value_rows[value_row_index]);
+        value_row_index += key_rows[i]->num_rows;
+    }
+    if (value_rows)
+        response->Retain(value_rows);
+    co_return 0;
+}
+
+/*
+    All keys are written in a single transaction if every value fits inline
+    and none of the keys had value rows before. Otherwise every pair is
+    written as by SET, each in its own transaction.
+*/
+ndb_task rondb_mset_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response)
+{
+    Ndb *ndb = ctx->ndb;
+    if (!keys_fit(argv, 1, 2, response))
+        co_return 0;
+
+    bool all_inline = true;
+    for (Uint32 i = 2; i < argv.size(); i += 2)
+    {
+        if (argv[i].size() > INLINE_VALUE_LEN)
+            all_inline = false;
+    }
+    if (all_inline)
+    {
+        NdbTransaction *trans = nullptr;
+        struct key_table key_row;
+        if (!setup_transaction(ctx,
+                               response,
+                               STRING_REDIS_KEY_ID,
+                               &key_row,
+                               argv[1].data(),
+                               argv[1].size(),
+                               &trans))
+            co_return 0;
+        int ret_code = co_await write_inline_key_rows(response, ctx, trans, argv, 1);
+        ndb->closeTransaction(trans);
+        if (ret_code == 0)
+        {
+            response->Append(REDIS_OK);
+            co_return 0;
+        }
+        if (ret_code != RESTRICT_VALUE_ROWS_ERROR)
+            co_return 0;
+    }
+    pink::RespWriter set_response;
+    for (Uint32 i = 1; i + 1 < argv.size(); i += 2)
+    {
+        set_response.Clear();
+        co_await rondb_set(ctx,
+                           &set_response,
+                           STRING_REDIS_KEY_ID,
+                           argv[i].data(),
+                           argv[i].size(),
+                           argv[i + 1].data(),
+                           argv[i + 1].size());
+        if (*set_response.buffer() != REDIS_OK)
+        {
+            response->Assign(*set_response.buffer());
+            co_return 0;
+        }
+    }
+    response->Append(REDIS_OK);
+    co_return 0;
+}
+
+/*
+    Inserts all keys in a single transaction; the insert of an existing
+    key aborts it.
+        :1  All keys were set.
+        :0  No key was set since at least one of them exists.
+*/
+ndb_task rondb_msetnx_command(struct worker_context *ctx,
+                              const pink::RedisCmdArgsViewType &argv,
+                              pink::RespWriter *response)
+{
+    Ndb *ndb = ctx->ndb;
+    if (!keys_fit(argv, 1, 2, response))
+        co_return 0;
+
+    NdbTransaction *trans = nullptr;
+    struct key_table key_row;
+    if (!setup_transaction(ctx,
+                           response,
+                           STRING_REDIS_KEY_ID,
+                           &key_row,
+                           argv[1].data(),
+                           argv[1].size(),
+                           &trans))
+        co_return 0;
+
+    int ret_code = co_await insert_key_rows(response,
+                                            ctx,
+                                            trans,
+                                            argv,
+                                            1,
+                                            &key_row,
+                                            &ctx->varsize_param[0]);
+    ndb->closeTransaction(trans);
+    if (ret_code == 0)
+    {
+        response->Append(REDIS_TRUE);
+    }
+    else if (ret_code == TUPLE_EXISTS_ERROR)
+    {
+        response->Assign(REDIS_FALSE);
+    }
+    co_return 0;
+}
+
+/*
+    Deletes the key rows in one batch, reading back which of them have
+    value rows. Those are deleted in the same transaction when committing,
+    unless they take more than one batch of the value reclaimer, which then
+    deletes them after the commit. Also used for UNLINK. Returns the number
+    of keys that were deleted:
+        :2
+*/
+ndb_task rondb_del_command(struct worker_context *ctx,
+                           const pink::RedisCmdArgsViewType &argv,
+                           pink::RespWriter *response)
+{
+    Ndb *ndb = ctx->ndb;
+    NdbTransaction *trans = nullptr;
+    struct multi_key_rows keys;
+    Uint32 num_keys = 0;
+    if (!setup_multi_key_transaction(ctx,
+                                     response,
+                                     argv,
+                                     1,
+                                     1,
+                                     keys,
+                                     num_keys,
+                                     &trans))
+        co_return 0;
+
+    struct key_table **key_rows = keys.row_ptrs.data();
+    const NdbOperation **del_ops = keys.ops.data();
+    int ret_code = co_await delete_key_rows(response, ctx, trans, key_rows, num_keys, del_ops);
+    if (ret_code != 0)
+    {
+        ndb->closeTransaction(trans);
+        co_return 0;
+    }
+    Uint32 num_deleted = 0;
+    std::vector<struct key_table *> complex_rows;
+    std::vector<struct key_table *> reclaimed_rows;
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        if (del_ops[i]->getNdbError().code != 0)
+            continue;
+        num_deleted++;
+        if (key_rows[i]->num_rows > RECLAIM_BATCH_ROWS &&
+            value_reclaimer_has_room())
+            reclaimed_rows.push_back(key_rows[i]);
+        else if (key_rows[i]->num_rows > 0)
+            complex_rows.push_back(key_rows[i]);
+    }
+    struct value_table value_row;
+    ret_code = co_await delete_all_value_rows(response,
+                                              ctx,
+                                              trans,
+                                              complex_rows.data(),
+                                              complex_rows.size(),
+                                              &value_row);
+    ndb->closeTransaction(trans);
+    if (ret_code != 0)
+        co_return 0;
+    // Unreachable now that their key rows are gone
+    for (struct key_table *key_row : reclaimed_rows)
+    {
+        reclaim_value_rows(key_row->rondb_key, key_row->num_rows);
+    }
+    response->AppendInteger(num_deleted);
+    co_return 0;
+}
+
+/*
+    Returns the number of given keys that exist, counting keys that are
+    given several times once per occurrence:
+        :2
+*/
+ndb_task rondb_exists_command(struct worker_context *ctx,
+                              const pink::RedisCmdArgsViewType &argv,
+                              pink::RespWriter *response)
+{
+    Ndb *ndb = ctx->ndb;
+    NdbTransaction *trans = nullptr;
+    struct multi_key_rows keys;
+    Uint32 num_keys = 0;
+    if (!setup_multi_key_transaction(ctx,
+                                     response,
+                                     argv,
+                                     1,
+                                     1,
+                                     keys,
+                                     num_keys,
+                                     &trans))
+        co_return 0;
+
+    const NdbOperation **read_ops = keys.ops.data();
+    int ret_code = co_await read_key_rows(response,
+                                          ctx,
+                                          trans,
+                                          keys.row_ptrs.data(),
+                                          num_keys,
+                                          KEY_TABLE_MASK_VALUE_ROWS,
+                                          NdbOperation::LM_CommittedRead,
+                                          NdbTransaction::Commit,
+                                          read_ops);
+    Uint32 num_found = 0;
+    for (Uint32 i = 0; ret_code == 0 && i < num_keys; i++)
+    {
+        if (read_ops[i]->getNdbError().code == 0)
+            num_found++;
+    }
+    ndb->closeTransaction(trans);
+    if (ret_code != 0)
+        co_return 0;
+    response->AppendInteger(num_found);
+    co_return 0;
 }
@@ -1,13 +1,18 @@
 #include <string.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <string>
+#include <string_view>
 #include "pink/include/redis_conn.h"
 #include <ndbapi/NdbApi.hpp>
 #include <ndbapi/Ndb.hpp>
 #include "db_operations.h"
+#include "../coroutine.h"
 
 #ifndef STRING_COMMANDS_H
 #define STRING_COMMANDS_H
+
+struct worker_context;
 /*
     All STRING commands:
     https://redis.io/docs/latest/commands/?group=string
@@ -21,28 +26,181 @@
     The db_operations level however handles most of the low-level NdbError handling.
     Most importantly, it writes Ndb error messages to the response string. This may
     however change in the future, since this causes redundancy.
+
+    The commands are tasks (see coroutine.h) that suspend on every round trip,
+    so they must not keep state in the worker_context across a co_await; other
+    commands of the worker run meanwhile. Their result is always 0, errors are
+    replied in the response.
 */
-void rondb_get_command(Ndb *ndb,
-                       const pink::RedisCmdArgsType &argv,
-                       std::string *response);
+bool setup_transaction(struct worker_context *ctx,
+                       pink::RespWriter *response,
+                       Uint64 redis_key_id,
+                       struct key_table *key_row,
+                       const char *key_str,
+                       Uint32 key_len,
+                       NdbTransaction **ret_trans);
+
+ndb_task rondb_get_command(struct worker_context *ctx,
+                           const pink::RedisCmdArgsViewType &argv,
+                           pink::RespWriter *response);
+
+ndb_task rondb_set_command(struct worker_context *ctx,
+                           const pink::RedisCmdArgsViewType &argv,
+                           pink::RespWriter *response);
+
+ndb_task rondb_incr_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response);
+
+ndb_task rondb_decr_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response);
+
+ndb_task rondb_incrby_command(struct worker_context *ctx,
+                              const pink::RedisCmdArgsViewType &argv,
+                              pink::RespWriter *response);
+
+ndb_task rondb_decrby_command(struct worker_context *ctx,
+                              const pink::RedisCmdArgsViewType &argv,
+                              pink::RespWriter *response);
+
+ndb_task rondb_mget_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response);
+
+ndb_task rondb_mset_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response);
 
-void rondb_set_command(Ndb *ndb,
-                       const pink::RedisCmdArgsType &argv,
-                       std::string *response);
+ndb_task rondb_msetnx_command(struct worker_context *ctx,
+                              const pink::RedisCmdArgsViewType &argv,
+                              pink::RespWriter *response);
 
-void rondb_incr_command(Ndb *ndb,
-                        const pink::RedisCmdArgsType &argv,
-                        std::string *response);
+ndb_task rondb_del_command(struct worker_context *ctx,
+                           const pink::RedisCmdArgsViewType &argv,
+                           pink::RespWriter *response);
 
-void rondb_hget_command(Ndb *ndb,
-                       const pink::RedisCmdArgsType &argv,
-                       std::string *response);
+ndb_task rondb_exists_command(struct worker_context *ctx,
+                              const pink::RedisCmdArgsViewType &argv,
+                              pink::RespWriter *response);
+
+ndb_task rondb_hget_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response);
+
+ndb_task rondb_hset_command(struct worker_context *ctx,
+                            const pink::RedisCmdArgsViewType &argv,
+                            pink::RespWriter *response);
+
+ndb_task rondb_hincr_command(struct worker_context *ctx,
+                             const pink::RedisCmdArgsViewType &argv,
+                             pink::RespWriter *response);
+
+/*
+    Number of complete value rows a SET upload collects before they are
+    written, about 240 KB.
+*/
+#define SET_UPLOAD_ROWS (2 * MAX_VALUES_TO_WRITE)
+
+/*
+    A SET whose value is streamed in from the connection instead of being
+    read as a whole, see pink::RedisConn::SetBulkStreamThreshold(). Its
+    value rows are written as they arrive, in a transaction that stays
+    open until the key row is committed at the end. So only the inline
+    part of the value and a few value rows are held in memory.
+
+    The steps of an upload must all run on the same worker_context, one
+    after the other.
+*/
+struct set_upload
+{
+    std::string key;
+    Uint32 value_len;
+    // The start of the value, stored in the key row
+    std::string inline_value;
+    // The value rows received and not written yet, the last one may be partial
+    std::string pending_rows;
+    Uint32 next_ordinal;
+    Uint64 rondb_key;
+    Uint32 num_value_rows;
+    Uint32 prev_num_rows;
+    // Open from the first step until the SET completes or fails
+    NdbTransaction *trans;
+    // Once a step failed, the rest of the value is dropped and the SET
+    // replies with this error
+    bool failed;
+    pink::RespWriter error;
+};
+
+void init_set_upload(struct set_upload *upload,
+                     std::string_view key,
+                     Uint32 value_len);
+
+/*
+    Copies the next part of the value. Returns true once SET_UPLOAD_ROWS
+    value rows are ready to be written by rondb_set_upload_step().
+*/
+bool set_upload_append(struct set_upload *upload, std::string_view chunk);
+
+/*
+    Writes the complete value rows received so far, starting with the key
+    row in the first step. With last set, all of the value has been
+    received; the rest of it is written, the transaction committed and the
+    SET replied to.
+*/
+ndb_task rondb_set_upload_step(struct worker_context *ctx,
+                               struct set_upload *upload,
+                               bool last,
+                               pink::RespWriter *response);
+
+// Rolls back an upload whose connection closed before the value was complete
+void set_upload_abort(struct worker_context *ctx, struct set_upload *upload);
+
+/*
+    Number of value rows a GET download reads per step, about 240 KB.
+*/
+#define GET_DOWNLOAD_ROWS (4 * ROWS_PER_READ)
+
+/*
+    A GET whose value is too large for a linked query and is sent while it
+    is read. The first step replies with the start of the value, each
+    further step reads the next value rows once the reply so far was
+    written to the socket (see pink::RedisConn::ContinueReply()). So only a
+    few value rows are held in memory and the client gets the first bytes
+    without waiting for all of them. The key row is read with a shared lock
+    in a transaction that stays open until the last value row was read.
+
+    The steps of a download must all run on the same worker_context, one
+    after the other.
+*/
+struct get_download
+{
+    // Open from the first step until the last value row was read
+    NdbTransaction *trans;
+    Uint64 rondb_key;
+    Uint32 num_rows;
+    Uint32 next_ordinal;
+    // A step failed after a part of the value was replied, so the
+    // connection has to be closed
+    bool failed;
+};
+
+void init_get_download(struct get_download *download);
+
+/*
+    GET that replies with the start of the value only and leaves the rest
+    to rondb_get_download_step() if the value is large, see get_download.
+*/
+ndb_task rondb_get_download_command(struct worker_context *ctx,
+                                    const pink::RedisCmdArgsViewType &argv,
+                                    pink::RespWriter *response,
+                                    struct get_download *download);
 
-void rondb_hset_command(Ndb *ndb,
-                       const pink::RedisCmdArgsType &argv,
-                       std::string *response);
+// Appends the next value rows to the reply, and its end after the last one
+ndb_task rondb_get_download_step(struct worker_context *ctx,
+                                 struct get_download *download,
+                                 pink::RespWriter *response);
 
-void rondb_hincr_command(Ndb *ndb,
-                        const pink::RedisCmdArgsType &argv,
-                        std::string *response);
+// Rolls back a download whose connection closed before the value was sent
+void get_download_abort(struct worker_context *ctx, struct get_download *download);
 #endif
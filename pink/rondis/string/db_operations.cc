@@ -1,3 +1,5 @@
+#include <memory>
+#include <string_view>
 #include <unordered_map>
 #include <string.h>
 #include <stdio.h>
@@ -9,7 +11,11 @@
 #include "../common.h"
 #include "db_operations.h"
 #include "table_definitions.h"
+#include "value_encoding.h"
 #include "interpreted_code.h"
+#include "key_id_cache.h"
+#include "../coroutine.h"
+#include "../worker_context.h"
 
 NdbRecord *pk_hset_key_record = nullptr;
 NdbRecord *entire_hset_key_record = nullptr;
@@ -18,23 +24,24 @@ NdbRecord *entire_key_record = nullptr;
 NdbRecord *pk_value_record = nullptr;
 NdbRecord *entire_value_record = nullptr;
 
-int create_key_row(std::string *response,
-                   const NdbDictionary::Table *tab,
-                   NdbTransaction *trans,
-                   Uint64 redis_key_id,
-                   Uint64 rondb_key,
-                   const char *key_str,
-                   Uint32 key_len,
-                   const char *value_str,
-                   Uint32 tot_value_len,
-                   Uint32 num_value_rows,
-                   Uint32 &prev_num_rows,
-                   Uint32 row_state) {
+ndb_task create_key_row(pink::RespWriter *response,
+                        struct worker_context *ctx,
+                        NdbTransaction *trans,
+                        Uint64 redis_key_id,
+                        Uint64 rondb_key,
+                        const char *key_str,
+                        Uint32 key_len,
+                        const char *value_str,
+                        Uint32 tot_value_len,
+                        Uint32 inline_value_len,
+                        Uint32 num_value_rows,
+                        Uint32 &prev_num_rows,
+                        Uint32 row_state) {
     const NdbOperation *write_op = nullptr;
     NdbRecAttr *recAttr = nullptr;
     int ret_code = write_data_to_key_op(response,
                                         &write_op,
-                                        tab,
+                                        ctx,
                                         trans,
                                         redis_key_id,
                                         rondb_key,
@@ -42,30 +49,31 @@ int create_key_row(std::string *response,
                                         key_len,
                                         value_str,
                                         tot_value_len,
+                                        inline_value_len,
                                         num_value_rows,
                                         prev_num_rows,
                                         row_state,
                                         &recAttr);
     if (ret_code != 0) {
-        return ret_code;
+        co_return ret_code;
     }
     if (num_value_rows == 0 && prev_num_rows == 0)
     {
-        if (trans->execute(NdbTransaction::Commit,
-                           NdbOperation::AbortOnError) == 0 &&
+        if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                                   NdbOperation::AbortOnError) == 0 &&
             trans->getNdbError().code == 0)
         {
-            return 0;
+            co_return 0;
         }
     }
     else
     {
-        if (trans->execute(NdbTransaction::NoCommit,
-                           NdbOperation::AbortOnError) == 0 &&
+        if (co_await execute_async(ctx, trans, NdbTransaction::NoCommit,
+                                   NdbOperation::AbortOnError) == 0 &&
             trans->getNdbError().code == 0)
         {
             prev_num_rows = recAttr->u_32_value();
-            return 0;
+            co_return 0;
         }
     }
 
@@ -75,12 +83,12 @@ int create_key_row(std::string *response,
                                    FAILED_EXEC_TXN,
                                    trans->getNdbError());
     }
-    return trans->getNdbError().code;
+    co_return trans->getNdbError().code;
 }
 
-int write_data_to_key_op(std::string *response,
+int write_data_to_key_op(pink::RespWriter *response,
                          const NdbOperation **ndb_op,
-                         const NdbDictionary::Table *tab,
+                         struct worker_context *ctx,
                          NdbTransaction *trans,
                          Uint64 redis_key_id,
                          Uint64 rondb_key,
@@ -88,6 +96,7 @@ int write_data_to_key_op(std::string *response,
                          Uint32 key_len,
                          const char *value_str,
                          Uint32 tot_value_len,
+                         Uint32 inline_value_len,
                          Uint32 num_value_rows,
                          Uint32 & prev_num_rows,
                          Uint32 row_state,
@@ -112,34 +121,21 @@ int write_data_to_key_op(std::string *response,
     key_row.value_data_type = row_state;
     key_row.expiry_date = 0;
 
-    Uint32 this_value_len = tot_value_len;
-    if (this_value_len > INLINE_VALUE_LEN)
-    {
-        this_value_len = INLINE_VALUE_LEN;
-    }
-    memcpy(&key_row.value_start[2], value_str, this_value_len);
-    set_length(&key_row.value_start[0], this_value_len);
-
-    Uint32 code_buffer[64];
-    NdbInterpretedCode code(tab, &code_buffer[0], sizeof(code_buffer));
-    int ret_code = 0;
-    if (num_value_rows > 0 || prev_num_rows > 0) {
-        ret_code = write_key_row_no_commit(response, code, tab);
-    }
-    else
-    {
-        ret_code = write_key_row_commit(response, code, tab);
-    }
-    if (ret_code != 0) {
-        return ret_code;
-    }
+    memcpy(&key_row.value_start[2], value_str, inline_value_len);
+    set_length(&key_row.value_start[0], inline_value_len);
 
     // Prepare the interpreted program to be part of the write
     NdbOperation::OperationOptions opts;
     std::memset(&opts, 0, sizeof(opts));
     opts.optionsPresent |= NdbOperation::OperationOptions::OO_INTERPRETED;
     opts.optionsPresent |= NdbOperation::OperationOptions::OO_INTERPRETED_INSERT;
-    opts.interpretedCode = &code;
+    if (num_value_rows > 0 || prev_num_rows > 0) {
+        opts.interpretedCode = ctx->write_key_no_commit_code;
+    }
+    else
+    {
+        opts.interpretedCode = ctx->write_key_commit_code;
+    }
 
     NdbOperation::GetValueSpec getvals[1];
     getvals[0].appStorage = nullptr;
@@ -170,12 +166,13 @@ int write_data_to_key_op(std::string *response,
     return 0;
 }
 
-int delete_value_rows(std::string *response,
-                      const NdbDictionary::Table *tab,
-                      NdbTransaction *trans,
-                      Uint64 rondb_key,
-                      Uint32 start_ordinal,
-                      Uint32 end_ordinal) {
+ndb_task delete_value_rows(pink::RespWriter *response,
+                           struct worker_context *ctx,
+                           const NdbDictionary::Table *tab,
+                           NdbTransaction *trans,
+                           Uint64 rondb_key,
+                           Uint32 start_ordinal,
+                           Uint32 end_ordinal) {
     for (Uint32 i = start_ordinal; i < end_ordinal; i++) {
         NdbOperation *del_op = trans->getNdbOperation(tab);
         if (del_op == nullptr)
@@ -183,7 +180,7 @@ int delete_value_rows(std::string *response,
             assign_ndb_err_to_response(response,
                                        FAILED_GET_OP,
                                        trans->getNdbError());
-            return -1;
+            co_return -1;
         }
         del_op->deleteTuple();
         del_op->equal(VALUE_TABLE_COL_rondb_key, rondb_key);
@@ -192,39 +189,39 @@ int delete_value_rows(std::string *response,
             assign_ndb_err_to_response(response,
                                        FAILED_DEFINE_OP,
                                        del_op->getNdbError());
-            return -1;
+            co_return -1;
         }
     }
     if (start_ordinal >= end_ordinal) {
-        return 0;
+        co_return 0;
     }
-    if (trans->execute(NdbTransaction::NoCommit,
-                       NdbOperation::AbortOnError) != 0 ||
+    if (co_await execute_async(ctx, trans, NdbTransaction::NoCommit,
+                               NdbOperation::AbortOnError) != 0 ||
         trans->getNdbError().code != 0)
     {
         assign_ndb_err_to_response(response,
                                    FAILED_EXEC_TXN,
                                    trans->getNdbError());
-        return -1;
+        co_return -1;
     }
-    return 0;
+    co_return 0;
 }
 
-int delete_key_row(std::string *response,
-                   Ndb *ndb,
-                   const NdbDictionary::Table *tab,
-                   NdbTransaction *trans,
-                   Uint64 redis_key_id,
-                   const char *key_str,
-                   Uint32 key_len,
-                   char *buf) {
+ndb_task delete_key_row(pink::RespWriter *response,
+                        struct worker_context *ctx,
+                        const NdbDictionary::Table *tab,
+                        NdbTransaction *trans,
+                        Uint64 redis_key_id,
+                        const char *key_str,
+                        Uint32 key_len,
+                        char *buf) {
     NdbOperation *del_op = trans->getNdbOperation(tab);
     if (del_op == nullptr)
     {
         assign_ndb_err_to_response(response,
                                    FAILED_GET_OP,
                                    trans->getNdbError());
-        return -1;
+        co_return -1;
     }
     del_op->deleteTuple();
     memcpy(&buf[2], key_str, key_len);
@@ -237,39 +234,30 @@ int delete_key_row(std::string *response,
         assign_ndb_err_to_response(response,
                                    FAILED_DEFINE_OP,
                                    del_op->getNdbError());
-        return -1;
+        co_return -1;
     }
 
-    if (trans->execute(NdbTransaction::NoCommit,
-                       NdbOperation::AbortOnError) != 0 ||
+    if (co_await execute_async(ctx, trans, NdbTransaction::NoCommit,
+                               NdbOperation::AbortOnError) != 0 ||
         trans->getNdbError().code != 0)
     {
         assign_ndb_err_to_response(response,
                                    FAILED_EXEC_TXN,
                                    trans->getNdbError());
-        return -1;
+        co_return -1;
     }
-    return 0;
+    co_return 0;
 }
 
-int create_value_row(std::string *response,
-                     Ndb *ndb,
-                     const NdbDictionary::Dictionary *dict,
+int create_value_row(pink::RespWriter *response,
+                     struct worker_context *ctx,
                      NdbTransaction *trans,
                      const char *start_value_ptr,
                      Uint64 rondb_key,
                      Uint32 this_value_len,
                      Uint32 ordinal,
                      char *buf) {
-    const NdbDictionary::Table *tab = dict->getTable(VALUE_TABLE_NAME);
-    if (tab == nullptr)
-    {
-        assign_ndb_err_to_response(response,
-                                   FAILED_CREATE_TABLE_OBJECT,
-                                   ndb->getNdbError());
-        return -1;
-    }
-    NdbOperation *op = trans->getNdbOperation(tab);
+    NdbOperation *op = trans->getNdbOperation(ctx->value_tab);
     if (op == nullptr)
     {
         assign_ndb_err_to_response(response,
@@ -291,18 +279,36 @@ int create_value_row(std::string *response,
     return 0;
 }
 
-int create_all_value_rows(std::string *response,
-                          Ndb *ndb,
-                          const NdbDictionary::Dictionary *dict,
-                          NdbTransaction *trans,
-                          Uint64 rondb_key,
-                          const char *value_str,
-                          Uint32 value_len,
-                          Uint32 num_value_rows,
-                          char *buf) {
-    Uint32 remaining_len = value_len - INLINE_VALUE_LEN;
-    const char *start_value_ptr = &value_str[INLINE_VALUE_LEN];
-    for (Uint32 ordinal = 0; ordinal < num_value_rows; ordinal++)
+ndb_task create_all_value_rows(pink::RespWriter *response,
+                               struct worker_context *ctx,
+                               NdbTransaction *trans,
+                               Uint64 rondb_key,
+                               const char *value_str,
+                               Uint32 value_len,
+                               Uint32 num_value_rows,
+                               char *buf) {
+    return create_value_rows(response,
+                             ctx,
+                             trans,
+                             rondb_key,
+                             &value_str[INLINE_VALUE_LEN],
+                             value_len - INLINE_VALUE_LEN,
+                             0,
+                             buf);
+}
+
+ndb_task create_value_rows(pink::RespWriter *response,
+                           struct worker_context *ctx,
+                           NdbTransaction *trans,
+                           Uint64 rondb_key,
+                           const char *value_str,
+                           Uint32 value_len,
+                           Uint32 start_ordinal,
+                           char *buf) {
+    Uint32 num_value_rows = (value_len + EXTENSION_VALUE_LEN - 1) / EXTENSION_VALUE_LEN;
+    Uint32 remaining_len = value_len;
+    const char *start_value_ptr = value_str;
+    for (Uint32 i = 0; i < num_value_rows; i++)
     {
         Uint32 this_value_len = remaining_len;
         if (remaining_len > EXTENSION_VALUE_LEN)
@@ -310,38 +316,57 @@ int create_all_value_rows(std::string *response,
             this_value_len = EXTENSION_VALUE_LEN;
         }
         if (create_value_row(response,
-                             ndb,
-                             dict,
+                             ctx,
                              trans,
                              start_value_ptr,
                              rondb_key,
                              this_value_len,
-                             ordinal,
+                             start_ordinal + i,
                              buf) != 0)
         {
-            return -1;
+            co_return -1;
         }
         remaining_len -= this_value_len;
         start_value_ptr += this_value_len;
-        if (ordinal == (num_value_rows - 1) ||
-            ordinal % MAX_VALUES_TO_WRITE == (MAX_VALUES_TO_WRITE - 1)) {
-            if (trans->execute(NdbTransaction::NoCommit,
-                               NdbOperation::AbortOnError) != 0 ||
+        if (i == (num_value_rows - 1) ||
+            i % MAX_VALUES_TO_WRITE == (MAX_VALUES_TO_WRITE - 1)) {
+            if (co_await execute_async(ctx, trans, NdbTransaction::NoCommit,
+                                       NdbOperation::AbortOnError) != 0 ||
                 trans->getNdbError().code != 0)
             {
                 assign_ndb_err_to_response(response, FAILED_EXEC_TXN, trans->getNdbError());
-                return -1;
+                co_return -1;
             }
         }
     }
-    return 0;
+    co_return 0;
 }
 
-int get_simple_key_row(std::string *response,
-                       const NdbDictionary::Table *tab,
-                       Ndb *ndb,
-                       NdbTransaction *trans,
-                       struct key_table *key_row) {
+ndb_task get_simple_key_row(pink::RespWriter *response,
+                            struct worker_context *ctx,
+                            NdbTransaction *trans,
+                            struct key_table *key_row) {
+    const NdbOperation *read_op = nullptr;
+    int ret_code = prepare_simple_key_row_read(response,
+                                               trans,
+                                               key_row,
+                                               &read_op);
+    if (ret_code != 0)
+    {
+        co_return ret_code;
+    }
+    bool exec_failed = co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                                              NdbOperation::AbortOnError) != 0;
+    co_return complete_simple_key_row_read(response,
+                                           read_op,
+                                           exec_failed,
+                                           key_row);
+}
+
+int prepare_simple_key_row_read(pink::RespWriter *response,
+                                NdbTransaction *trans,
+                                struct key_table *key_row,
+                                const NdbOperation **read_op) {
     /**
      * Mask and options means simply reading all columns
      * except primary key columns.
@@ -349,27 +374,33 @@ int get_simple_key_row(std::string *response,
 
     const Uint32 mask = 0x1FC;
     const unsigned char *mask_ptr = (const unsigned char *)&mask;
-    const NdbOperation *read_op = trans->readTuple(
+    const NdbOperation *op = trans->readTuple(
         pk_key_record,
         (const char *)key_row,
         entire_key_record,
         (char *)key_row,
         NdbOperation::LM_CommittedRead,
         mask_ptr);
-    if (read_op == nullptr)
+    if (op == nullptr)
     {
         assign_ndb_err_to_response(response,
                                    FAILED_GET_OP,
                                    trans->getNdbError());
         return RONDB_INTERNAL_ERROR;
     }
-    if (trans->execute(NdbTransaction::Commit,
-                       NdbOperation::AbortOnError) != 0 ||
-        read_op->getNdbError().code != 0)
+    *read_op = op;
+    return 0;
+}
+
+int complete_simple_key_row_read(pink::RespWriter *response,
+                                 const NdbOperation *read_op,
+                                 bool exec_failed,
+                                 struct key_table *key_row) {
+    if (exec_failed || read_op->getNdbError().code != 0)
     {
         if (read_op->getNdbError().classification == NdbError::NoDataFound)
         {
-            response->assign(REDIS_NO_SUCH_KEY);
+            response->Assign(REDIS_NO_SUCH_KEY);
             return READ_ERROR;
         }
         assign_ndb_err_to_response(response,
@@ -382,17 +413,10 @@ int get_simple_key_row(std::string *response,
     {
         return 0;
     }
-    char header_buf[20];
-    int header_len = snprintf(header_buf,
-                              sizeof(header_buf),
-                              "$%u\r\n",
-                              key_row->tot_value_len);
-
-    // The total length of the expected response
-    response->reserve(header_len + key_row->tot_value_len + 2);
-    response->append(header_buf);
-    response->append((const char *)&key_row->value_start[2], key_row->tot_value_len);
-    response->append("\r\n");
+    if (append_inline_value(response, key_row) != 0)
+    {
+        return RONDB_INTERNAL_ERROR;
+    }
     /*
         printf("Respond with tot_value_len: %u, string: %s\n",
            key_row->tot_value_len,
@@ -401,22 +425,12 @@ int get_simple_key_row(std::string *response,
     return 0;
 }
 
-int get_value_rows(std::string *response,
-                   Ndb *ndb,
-                   const NdbDictionary::Dictionary *dict,
-                   NdbTransaction *trans,
-                   const Uint32 num_rows,
-                   const Uint64 rondb_key,
-                   const Uint32 tot_value_len) {
-    const NdbDictionary::Table *tab = dict->getTable(VALUE_TABLE_NAME);
-    if (tab == nullptr)
-    {
-        assign_ndb_err_to_response(response,
-                                   FAILED_CREATE_TABLE_OBJECT,
-                                   ndb->getNdbError());
-        return -1;
-    }
-
+ndb_task get_value_rows(pink::RespWriter *response,
+                        struct worker_context *ctx,
+                        NdbTransaction *trans,
+                        const Uint32 num_rows,
+                        const Uint64 rondb_key,
+                        struct value_table *value_rows) {
     // This is rounded up
     Uint32 num_read_batches = (num_rows + ROWS_PER_READ - 1) / ROWS_PER_READ;
     for (Uint32 batch = 0; batch < num_read_batches; batch++)
@@ -428,28 +442,30 @@ int get_value_rows(std::string *response,
         NdbTransaction::ExecType commit_type = is_last_batch ?
           NdbTransaction::Commit : NdbTransaction::NoCommit;
 
-        if (read_batched_value_rows(response,
-                                    trans,
-                                    rondb_key,
-                                    num_rows_to_read,
-                                    start_ordinal,
-                                    commit_type) != 0)
+        if (co_await read_batched_value_rows(response,
+                                             ctx,
+                                             trans,
+                                             rondb_key,
+                                             num_rows_to_read,
+                                             start_ordinal,
+                                             commit_type,
+                                             &value_rows[start_ordinal]) != 0)
         {
-            return -1;
+            co_return -1;
         }
     }
-    return 0;
+    co_return 0;
 }
 
 // Break up fetching large values to avoid blocking the network for other reads
-int read_batched_value_rows(std::string *response,
-                            NdbTransaction *trans,
-                            const Uint64 rondb_key,
-                            const Uint32 num_rows_to_read,
-                            const Uint32 start_ordinal,
-                            const NdbTransaction::ExecType commit_type) {
-    struct value_table value_rows[ROWS_PER_READ];
-
+ndb_task read_batched_value_rows(pink::RespWriter *response,
+                                 struct worker_context *ctx,
+                                 NdbTransaction *trans,
+                                 const Uint64 rondb_key,
+                                 const Uint32 num_rows_to_read,
+                                 const Uint32 start_ordinal,
+                                 const NdbTransaction::ExecType commit_type,
+                                 struct value_table *value_rows) {
     Uint32 ordinal = start_ordinal;
     for (Uint32 i = 0; i < num_rows_to_read; i++)
     {
@@ -466,41 +482,37 @@ int read_batched_value_rows(std::string *response,
             assign_ndb_err_to_response(response,
                                        FAILED_GET_OP,
                                        trans->getNdbError());
-            return -1;
+            co_return -1;
         }
         ordinal++;
     }
 
-    if (trans->execute(commit_type,
-                       NdbOperation::AbortOnError) != 0 ||
+    if (co_await execute_async(ctx, trans, commit_type,
+                               NdbOperation::AbortOnError) != 0 ||
         trans->getNdbError().code != 0)
     {
         assign_ndb_err_to_response(response,
                                    FAILED_READ_KEY,
                                    trans->getNdbError());
-        return -1;
+        co_return -1;
     }
+    co_return 0;
+}
 
-    for (Uint32 i = 0; i < num_rows_to_read; i++)
+void append_value_rows(pink::RespWriter *response,
+                       const struct value_table *value_rows,
+                       Uint32 num_rows) {
+    for (Uint32 i = 0; i < num_rows; i++)
     {
-        // Transfer char pointer to response's string
-        Uint32 row_value_len = get_length((char *)&value_rows->value[0]);
-        response->append((const char *)&value_rows[i].value[2], row_value_len);
+        response->AppendRef(&value_rows[i].value[2],
+                            get_length((char *)&value_rows[i].value[0]));
     }
-    return 0;
 }
 
-int get_complex_key_row(std::string *response,
-                        const NdbDictionary::Dictionary *dict,
-                        const NdbDictionary::Table *tab,
-                        Ndb *ndb,
-                        NdbTransaction *trans,
-                        struct key_table *key_row) {
-    /**
-     * Since a simple read using CommittedRead we will go back to
-     * the safe method where we first read with lock the key row
-     * followed by reading the value rows.
-     */
+ndb_task read_locked_key_row(pink::RespWriter *response,
+                             struct worker_context *ctx,
+                             NdbTransaction *trans,
+                             struct key_table *key_row) {
     /**
      * Mask and options means simply reading all columns
      * except primary key column.
@@ -520,52 +532,169 @@ int get_complex_key_row(std::string *response,
         assign_ndb_err_to_response(response,
                                    FAILED_GET_OP,
                                    trans->getNdbError());
-        return RONDB_INTERNAL_ERROR;
+        co_return RONDB_INTERNAL_ERROR;
     }
-    if (trans->execute(NdbTransaction::NoCommit,
-                       NdbOperation::AbortOnError) != 0 ||
+    if (co_await execute_async(ctx, trans, NdbTransaction::NoCommit,
+                               NdbOperation::AbortOnError) != 0 ||
         trans->getNdbError().code != 0)
     {
         assign_ndb_err_to_response(response,
                                    FAILED_READ_KEY,
                                    trans->getNdbError());
-        return RONDB_INTERNAL_ERROR;
+        co_return RONDB_INTERNAL_ERROR;
+    }
+    co_return 0;
+}
+
+ndb_task get_complex_key_row(pink::RespWriter *response,
+                             struct worker_context *ctx,
+                             NdbTransaction *trans,
+                             struct key_table *key_row) {
+    /**
+     * Since a simple read using CommittedRead we will go back to
+     * the safe method where we first read with lock the key row
+     * followed by reading the value rows.
+     */
+    if (co_await read_locked_key_row(response, ctx, trans, key_row) != 0)
+        co_return RONDB_INTERNAL_ERROR;
+    if (key_row->num_rows == 0)
+    {
+        // Changed since the first read
+        co_return append_inline_value(response, key_row) == 0 ? 0 : RONDB_INTERNAL_ERROR;
     }
 
     // Got inline value, now getting the other value rows
 
-    // Writing the Redis header to the response (indicating value length)
-    char header_buf[20];
-    int header_len = snprintf(header_buf,
-                              sizeof(header_buf),
-                              "$%u\r\n",
-                              key_row->tot_value_len);
-    response->reserve(header_len + key_row->tot_value_len + 2);
-    response->append(header_buf);
-
-    // Append inline value to response
-    Uint32 inline_value_len = get_length((char *)&key_row->value_start[0]);
-    response->append((const char *)&key_row->value_start[2], inline_value_len);
-
-    int ret_code = get_value_rows(response,
-                                  ndb,
-                                  dict,
-                                  trans,
-                                  key_row->num_rows,
-                                  key_row->rondb_key,
-                                  key_row->tot_value_len);
-    if (ret_code == 0)
-    {
-        response->append("\r\n");
-        return 0;
+    std::shared_ptr<struct value_table[]> value_rows(
+        new struct value_table[key_row->num_rows]);
+    int ret_code = co_await get_value_rows(response,
+                                           ctx,
+                                           trans,
+                                           key_row->num_rows,
+                                           key_row->rondb_key,
+                                           value_rows.get());
+    if (ret_code != 0)
+        co_return RONDB_INTERNAL_ERROR;
+
+    // The inline value is copied, the value rows are sent from their buffer
+    response->AppendBulkHeader(key_row->tot_value_len);
+    response->Append(&key_row->value_start[2],
+                     get_length((char *)&key_row->value_start[0]));
+    append_value_rows(response, value_rows.get(), key_row->num_rows);
+    response->Retain(value_rows);
+    response->Append("\r\n");
+    co_return 0;
+}
+
+ndb_task get_linked_key_row(pink::RespWriter *response,
+                            struct worker_context *ctx,
+                            NdbTransaction *trans,
+                            struct key_table *key_row) {
+    Uint32 num_value_rows = key_row->num_rows;
+    const NdbQueryDef *query_def = get_linked_value_query(ctx, num_value_rows);
+    if (query_def == nullptr)
+        co_return INCONSISTENT_READ_ERROR;
+
+    /**
+     * The value rows are looked up with the rondb_key of the key row that
+     * the query reads, not the one of the earlier read. Every write of a
+     * value with value rows uses a new rondb_key, so CommittedRead gives a
+     * consistent value as long as no value row is missing and the key row
+     * still has the same number of value rows.
+     */
+    const NdbQueryParamValue params[] = {
+        NdbQueryParamValue(key_row->redis_key_id),
+        NdbQueryParamValue((const void *)&key_row->redis_key[0]),
+        NdbQueryParamValue()};
+    NdbQuery *query = trans->createQuery(query_def,
+                                         params,
+                                         NdbOperation::LM_CommittedRead);
+    if (query == nullptr)
+    {
+        assign_ndb_err_to_response(response,
+                                   FAILED_GET_OP,
+                                   trans->getNdbError());
+        co_return RONDB_INTERNAL_ERROR;
+    }
+    // Owned by the reply once the value is known to be consistent
+    std::shared_ptr<struct value_table[]> value_rows_owner(
+        new struct value_table[num_value_rows]);
+    struct value_table *value_rows = value_rows_owner.get();
+    const Uint32 mask = KEY_TABLE_MASK_ALL_NON_PK;
+    if (query->getQueryOperation(0)->setResultRowBuf(entire_key_record,
+                                                     (char *)key_row,
+                                                     (const unsigned char *)&mask) != 0)
+    {
+        assign_ndb_err_to_response(response,
+                                   FAILED_DEFINE_OP,
+                                   query->getNdbError());
+        co_return RONDB_INTERNAL_ERROR;
     }
-    return RONDB_INTERNAL_ERROR;
+    for (Uint32 i = 0; i < num_value_rows; i++)
+    {
+        if (query->getQueryOperation(i + 1)->setResultRowBuf(entire_value_record,
+                                                             (char *)&value_rows[i]) != 0)
+        {
+            assign_ndb_err_to_response(response,
+                                       FAILED_DEFINE_OP,
+                                       query->getNdbError());
+            co_return RONDB_INTERNAL_ERROR;
+        }
+    }
+
+    if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                               NdbOperation::AbortOnError) != 0 ||
+        trans->getNdbError().code != 0)
+    {
+        if (trans->getNdbError().code == READ_ERROR)
+        {
+            // Deleted since the earlier read
+            response->Append(REDIS_NO_SUCH_KEY);
+            co_return 0;
+        }
+        assign_ndb_err_to_response(response,
+                                   FAILED_READ_KEY,
+                                   trans->getNdbError());
+        co_return RONDB_INTERNAL_ERROR;
+    }
+    NdbQuery::NextResultOutcome outcome = query->nextResult(true, false);
+    if (outcome == NdbQuery::NextResult_scanComplete)
+    {
+        response->Append(REDIS_NO_SUCH_KEY);
+        co_return 0;
+    }
+    if (outcome != NdbQuery::NextResult_gotRow)
+    {
+        assign_ndb_err_to_response(response,
+                                   FAILED_READ_KEY,
+                                   query->getNdbError());
+        co_return RONDB_INTERNAL_ERROR;
+    }
+    if (key_row->num_rows != num_value_rows)
+        co_return INCONSISTENT_READ_ERROR;
+    Uint32 value_len = get_length((char *)&key_row->value_start[0]);
+    for (Uint32 i = 0; i < num_value_rows; i++)
+    {
+        if (query->getQueryOperation(i + 1)->isRowNULL())
+            co_return INCONSISTENT_READ_ERROR;
+        value_len += get_length((char *)&value_rows[i].value[0]);
+    }
+    if (value_len != key_row->tot_value_len)
+        co_return INCONSISTENT_READ_ERROR;
+
+    response->AppendBulkHeader(key_row->tot_value_len);
+    response->Append(&key_row->value_start[2],
+                     get_length((char *)&key_row->value_start[0]));
+    append_value_rows(response, value_rows, num_value_rows);
+    response->Retain(value_rows_owner);
+    response->Append("\r\n");
+    co_return 0;
 }
 
 int rondb_get_rondb_key(const NdbDictionary::Table *tab,
                         Uint64 &rondb_key,
                         Ndb *ndb,
-                        std::string *response) {
+                        pink::RespWriter *response) {
     if (ndb->getAutoIncrementValue(tab, rondb_key, unsigned(1024)) != 0)
     {
         assign_ndb_err_to_response(response,
@@ -576,11 +705,37 @@ int rondb_get_rondb_key(const NdbDictionary::Table *tab,
     return 0;
 }
 
-void incr_key_row(std::string *response,
-                  Ndb *ndb,
-                  const NdbDictionary::Table *tab,
-                  NdbTransaction *trans,
-                  struct key_table *key_row) {
+ndb_task incr_key_row(pink::RespWriter *response,
+                      struct worker_context *ctx,
+                      NdbTransaction *trans,
+                      struct key_table *key_row,
+                      Int64 increment) {
+    // INCR uses the program of the worker, other increments one of their own
+    Uint32 code_buffer[INCR_CODE_WORDS];
+    NdbInterpretedCode code(ctx->key_tab, &code_buffer[0], INCR_CODE_WORDS);
+    const NdbInterpretedCode *incr_code = ctx->incr_code;
+    if (increment != 1)
+    {
+        if (initNdbCodeIncr(response, &code, ctx->key_tab, increment) != 0)
+            co_return 0;
+        incr_code = &code;
+    }
+    NdbRecAttr *recAttr = nullptr;
+    if (prepare_incr_key_row(response, trans, key_row, incr_code, &recAttr) != 0)
+        co_return 0;
+
+    /* Send to RonDB and execute the INCR operation */
+    bool exec_failed = co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                                              NdbOperation::AbortOnError) != 0;
+    complete_incr_key_row(response, trans, exec_failed, recAttr);
+    co_return 0;
+}
+
+int prepare_incr_key_row(pink::RespWriter *response,
+                         NdbTransaction *trans,
+                         struct key_table *key_row,
+                         const NdbInterpretedCode *incr_code,
+                         NdbRecAttr **recAttr) {
     /**
      * The mask specifies which columns is to be updated after the interpreter
      * has finished. The values are set in the key_row.
@@ -597,20 +752,15 @@ void incr_key_row(std::string *response,
     // redis_key already set as this is the Primary key
     key_row->null_bits = 1; // Set rondb_key to NULL, first NULL column
     key_row->num_rows = 0;
-    key_row->value_data_type = 0;
+    key_row->value_data_type = VALUE_DATA_TYPE_INT64;
     key_row->expiry_date = 0;
 
-    Uint32 code_buffer[128];
-    NdbInterpretedCode code(tab, &code_buffer[0], sizeof(code_buffer));
-    if (initNdbCodeIncr(response, &code, tab) != 0)
-        return;
-
     // Prepare the interpreted program to be part of the write
     NdbOperation::OperationOptions opts;
     std::memset(&opts, 0, sizeof(opts));
     opts.optionsPresent |= NdbOperation::OperationOptions::OO_INTERPRETED;
     opts.optionsPresent |= NdbOperation::OperationOptions::OO_INTERPRETED_INSERT;
-    opts.interpretedCode = &code;
+    opts.interpretedCode = incr_code;
 
     /**
      * Prepare to get the final value of the Redis row after INCR is finished
@@ -642,13 +792,17 @@ void incr_key_row(std::string *response,
         assign_ndb_err_to_response(response,
                                    "Failed to create NdbOperation",
                                    trans->getNdbError());
-        return;
+        return -1;
     }
+    *recAttr = getvals[0].recAttr;
+    return 0;
+}
 
-    /* Send to RonDB and execute the INCR operation */
-    if (trans->execute(NdbTransaction::Commit,
-                       NdbOperation::AbortOnError) != 0 ||
-        trans->getNdbError().code != 0)
+void complete_incr_key_row(pink::RespWriter *response,
+                           NdbTransaction *trans,
+                           bool exec_failed,
+                           NdbRecAttr *recAttr) {
+    if (exec_failed || trans->getNdbError().code != 0)
     {
         if (trans->getNdbError().code == RONDB_KEY_NOT_NULL_ERROR)
         {
@@ -664,16 +818,10 @@ void incr_key_row(std::string *response,
     }
 
     /* Retrieve the returned new value as an Int64 value */
-    NdbRecAttr *recAttr = getvals[0].recAttr;
     Int64 new_incremented_value = recAttr->int64_value();
 
     /* Send the return message to Redis client */
-    char header_buf[20];
-    int header_len = snprintf(header_buf,
-                              sizeof(header_buf),
-                              ":%lld\r\n",
-                              new_incremented_value);
-    response->append(header_buf);
+    response->AppendInteger(new_incremented_value);
     return;
 }
 
@@ -681,7 +829,7 @@ static
 int get_unique_redis_key_id(const NdbDictionary::Table *tab,
                             Ndb *ndb,
                             Uint64 &redis_key_id,
-                            std::string *response) {
+                            pink::RespWriter *response) {
 
     if (ndb->getAutoIncrementValue(tab, redis_key_id, unsigned(1024)) != 0)
     {
@@ -693,47 +841,404 @@ int get_unique_redis_key_id(const NdbDictionary::Table *tab,
     return 0;
 }
 
-std::unordered_map<std::string, Uint64> redis_key_id_hash;
-int rondb_get_redis_key_id(Ndb *ndb,
-                           Uint64 &redis_key_id,
-                           const char *key_str,
-                           Uint32 key_len,
-                           std::string *response) {
-    std::string std_key_str = std::string(key_str, key_len);
-    auto it = redis_key_id_hash.find(std_key_str);
-    if (it == redis_key_id_hash.end()) {
-        /* Found no redis_key_id in local hash */
-        const NdbDictionary::Dictionary *dict = ndb->getDictionary();
-        if (dict == nullptr)
+ndb_task rondb_get_redis_key_id(struct worker_context *ctx,
+                                Uint64 &redis_key_id,
+                                const char *key_str,
+                                Uint32 key_len,
+                                pink::RespWriter *response) {
+    std::string_view key(key_str, key_len);
+    if (key_id_cache_find(key, &redis_key_id)) {
+        co_return 0;
+    }
+    /* Found no redis_key_id in the cache */
+    Ndb *ndb = ctx->ndb;
+    const NdbDictionary::Table *tab = ctx->hset_key_tab;
+    int ret_code = get_unique_redis_key_id(tab,
+                                           ndb,
+                                           redis_key_id,
+                                           response);
+    if (ret_code < 0) {
+        co_return -1;
+    }
+    ret_code = co_await write_hset_key_table(ctx,
+                                             tab,
+                                             key,
+                                             redis_key_id,
+                                             response);
+    if (ret_code < 0) {
+        co_return -1;
+    }
+    key_id_cache_insert(key, redis_key_id);
+    co_return 0;
+}
+
+ndb_task rondb_find_redis_key_id(struct worker_context *ctx,
+                                 Uint64 &redis_key_id,
+                                 const char *key_str,
+                                 Uint32 key_len,
+                                 pink::RespWriter *response) {
+    std::string_view key(key_str, key_len);
+    if (key_id_cache_find(key, &redis_key_id)) {
+        co_return 0;
+    }
+    if (key_len > MAX_KEY_VALUE_LEN) {
+        assign_generic_err_to_response(response, REDIS_KEY_TOO_LARGE);
+        co_return -1;
+    }
+    Ndb *ndb = ctx->ndb;
+    struct hset_key_table key_row;
+    set_length(&key_row.redis_key[0], key_len);
+    memcpy(&key_row.redis_key[2], key_str, key_len);
+    NdbTransaction *trans = ndb->startTransaction(ctx->hset_key_tab,
+                                                  &key_row.redis_key[0],
+                                                  key_len + 2);
+    if (trans == nullptr) {
+        assign_ndb_err_to_response(response,
+                                   FAILED_CREATE_TXN_OBJECT,
+                                   ndb->getNdbError());
+        co_return -1;
+    }
+    const NdbOperation *read_op = trans->readTuple(pk_hset_key_record,
+                                                   (const char *)&key_row,
+                                                   entire_hset_key_record,
+                                                   (char *)&key_row,
+                                                   NdbOperation::LM_CommittedRead);
+    if (read_op == nullptr) {
+        assign_ndb_err_to_response(response,
+                                   FAILED_GET_OP,
+                                   trans->getNdbError());
+        ndb->closeTransaction(trans);
+        co_return -1;
+    }
+    if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                               NdbOperation::AbortOnError) != 0 ||
+        read_op->getNdbError().code != 0) {
+        int ret_code = -1;
+        if (read_op->getNdbError().classification == NdbError::NoDataFound) {
+            response->Assign(REDIS_NO_SUCH_KEY);
+            ret_code = READ_ERROR;
+        } else {
+            assign_ndb_err_to_response(response,
+                                       FAILED_HSET_KEY,
+                                       read_op->getNdbError());
+        }
+        ndb->closeTransaction(trans);
+        co_return ret_code;
+    }
+    ndb->closeTransaction(trans);
+    redis_key_id = key_row.redis_key_id;
+    key_id_cache_insert(key, redis_key_id);
+    co_return 0;
+}
+
+ndb_task read_key_rows(pink::RespWriter *response,
+                       struct worker_context *ctx,
+                       NdbTransaction *trans,
+                       struct key_table **key_rows,
+                       Uint32 num_keys,
+                       Uint32 mask,
+                       NdbOperation::LockMode lock_mode,
+                       NdbTransaction::ExecType commit_type,
+                       const NdbOperation **read_ops) {
+    const unsigned char *mask_ptr = (const unsigned char *)&mask;
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        read_ops[i] = trans->readTuple(pk_key_record,
+                                       (const char *)key_rows[i],
+                                       entire_key_record,
+                                       (char *)key_rows[i],
+                                       lock_mode,
+                                       mask_ptr);
+        if (read_ops[i] == nullptr)
         {
-            assign_ndb_err_to_response(response, FAILED_GET_DICT, ndb->getNdbError());
-            return -1;
+            assign_ndb_err_to_response(response,
+                                       FAILED_GET_OP,
+                                       trans->getNdbError());
+            co_return RONDB_INTERNAL_ERROR;
         }
-        const NdbDictionary::Table *tab = dict->getTable(HSET_KEY_TABLE_NAME);
-        if (tab == nullptr)
+    }
+    /**
+     * Missing keys must not abort the reads of the other keys, hence
+     * errors are checked per operation.
+     */
+    if (co_await execute_async(ctx, trans, commit_type, NdbOperation::AO_IgnoreError) != 0 &&
+        trans->getNdbError().classification != NdbError::NoDataFound)
+    {
+        assign_ndb_err_to_response(response,
+                                   FAILED_READ_KEY,
+                                   trans->getNdbError());
+        co_return RONDB_INTERNAL_ERROR;
+    }
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        const NdbError &error = read_ops[i]->getNdbError();
+        if (error.code != 0 && error.classification != NdbError::NoDataFound)
         {
-            assign_ndb_err_to_response(response, FAILED_CREATE_TABLE_OBJECT, dict->getNdbError());
-            return -1;
+            assign_ndb_err_to_response(response, FAILED_READ_KEY, error);
+            co_return RONDB_INTERNAL_ERROR;
         }
-        int ret_code = get_unique_redis_key_id(tab,
-                                               ndb,
-                                               redis_key_id,
-                                               response);
-        if (ret_code < 0) {
-            return -1;
+    }
+    co_return 0;
+}
+
+ndb_task read_all_value_rows(pink::RespWriter *response,
+                             struct worker_context *ctx,
+                             NdbTransaction *trans,
+                             struct key_table **key_rows,
+                             Uint32 num_keys,
+                             struct value_table *value_rows) {
+    Uint32 row_index = 0;
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        for (Uint32 ordinal = 0; ordinal < key_rows[i]->num_rows; ordinal++)
+        {
+            struct value_table *value_row = &value_rows[row_index++];
+            value_row->rondb_key = key_rows[i]->rondb_key;
+            value_row->ordinal = ordinal;
+            const NdbOperation *read_op = trans->readTuple(
+                pk_value_record,
+                (const char *)value_row,
+                entire_value_record,
+                (char *)value_row,
+                NdbOperation::LM_CommittedRead);
+            if (read_op == nullptr)
+            {
+                assign_ndb_err_to_response(response,
+                                           FAILED_GET_OP,
+                                           trans->getNdbError());
+                co_return RONDB_INTERNAL_ERROR;
+            }
         }
-        ret_code = write_hset_key_table(ndb,
-                                        tab,
-                                        std_key_str,
-                                        redis_key_id,
-                                        response);
-        if (ret_code < 0) {
-            return -1;
+    }
+    if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                               NdbOperation::AbortOnError) != 0 ||
+        trans->getNdbError().code != 0)
+    {
+        assign_ndb_err_to_response(response,
+                                   FAILED_READ_KEY,
+                                   trans->getNdbError());
+        co_return RONDB_INTERNAL_ERROR;
+    }
+    co_return 0;
+}
+
+ndb_task write_inline_key_rows(pink::RespWriter *response,
+                               struct worker_context *ctx,
+                               NdbTransaction *trans,
+                               const pink::RedisCmdArgsViewType &argv,
+                               Uint32 arg_index_start) {
+    for (Uint32 i = arg_index_start; i + 1 < argv.size(); i += 2)
+    {
+        const NdbOperation *write_op = nullptr;
+        NdbRecAttr *recAttr = nullptr;
+        Uint32 prev_num_rows = 0;
+        int ret_code = write_data_to_key_op(response,
+                                            &write_op,
+                                            ctx,
+                                            trans,
+                                            STRING_REDIS_KEY_ID,
+                                            Uint64(0),
+                                            argv[i].data(),
+                                            argv[i].size(),
+                                            argv[i + 1].data(),
+                                            argv[i + 1].size(),
+                                            argv[i + 1].size(),
+                                            Uint32(0),
+                                            prev_num_rows,
+                                            Uint32(0),
+                                            &recAttr);
+        if (ret_code != 0)
+        {
+            co_return ret_code;
         }
-        redis_key_id_hash[std_key_str] = redis_key_id;
-    } else {
-        /* Found local redis_key_id */
-        redis_key_id = it->second;
     }
-    return 0;
+    if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                               NdbOperation::AbortOnError) == 0 &&
+        trans->getNdbError().code == 0)
+    {
+        co_return 0;
+    }
+    if (trans->getNdbError().code != RESTRICT_VALUE_ROWS_ERROR)
+    {
+        assign_ndb_err_to_response(response,
+                                   FAILED_EXEC_TXN,
+                                   trans->getNdbError());
+    }
+    co_return trans->getNdbError().code;
+}
+
+ndb_task insert_key_rows(pink::RespWriter *response,
+                         struct worker_context *ctx,
+                         NdbTransaction *trans,
+                         const pink::RedisCmdArgsViewType &argv,
+                         Uint32 arg_index_start,
+                         struct key_table *key_row,
+                         char *buf) {
+    // Only the last value of a key is written, inserting it twice would fail
+    std::unordered_map<std::string_view, Uint32> last_pair;
+    for (Uint32 i = arg_index_start; i + 1 < argv.size(); i += 2)
+    {
+        last_pair[argv[i]] = i;
+    }
+    for (Uint32 i = arg_index_start; i + 1 < argv.size(); i += 2)
+    {
+        if (last_pair[argv[i]] != i)
+            continue;
+        const char *value_str = argv[i + 1].data();
+        Uint32 value_len = argv[i + 1].size();
+        Uint32 num_value_rows = 0;
+        Uint32 mask = 0xFF;
+        key_row->null_bits = 0;
+        key_row->rondb_key = 0;
+        if (value_len > INLINE_VALUE_LEN)
+        {
+            Uint32 extended_value_len = value_len - INLINE_VALUE_LEN;
+            num_value_rows = (extended_value_len + EXTENSION_VALUE_LEN - 1) /
+                             EXTENSION_VALUE_LEN;
+            if (rondb_get_rondb_key(ctx->key_tab, key_row->rondb_key, ctx->ndb, response) != 0)
+            {
+                co_return -1;
+            }
+        }
+        else
+        {
+            // rondb_key is left NULL
+            mask = 0xFB;
+        }
+        key_row->redis_key_id = STRING_REDIS_KEY_ID;
+        memcpy(&key_row->redis_key[2], argv[i].data(), argv[i].size());
+        set_length(&key_row->redis_key[0], argv[i].size());
+        key_row->tot_value_len = value_len;
+        key_row->num_rows = num_value_rows;
+        key_row->value_data_type = 0;
+        key_row->expiry_date = 0;
+        Uint32 this_value_len = std::min(value_len, Uint32(INLINE_VALUE_LEN));
+        memcpy(&key_row->value_start[2], value_str, this_value_len);
+        set_length(&key_row->value_start[0], this_value_len);
+
+        const NdbOperation *insert_op = trans->insertTuple(
+            pk_key_record,
+            (const char *)key_row,
+            entire_key_record,
+            (char *)key_row,
+            (const unsigned char *)&mask);
+        if (insert_op == nullptr)
+        {
+            assign_ndb_err_to_response(response,
+                                       FAILED_GET_OP,
+                                       trans->getNdbError());
+            co_return -1;
+        }
+        if (num_value_rows > 0 &&
+            co_await create_all_value_rows(response,
+                                           ctx,
+                                           trans,
+                                           key_row->rondb_key,
+                                           value_str,
+                                           value_len,
+                                           num_value_rows,
+                                           buf) != 0)
+        {
+            if (trans->getNdbError().classification == NdbError::ConstraintViolation)
+            {
+                co_return TUPLE_EXISTS_ERROR;
+            }
+            co_return -1;
+        }
+    }
+    if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                               NdbOperation::AbortOnError) == 0 &&
+        trans->getNdbError().code == 0)
+    {
+        co_return 0;
+    }
+    if (trans->getNdbError().classification == NdbError::ConstraintViolation)
+    {
+        co_return TUPLE_EXISTS_ERROR;
+    }
+    assign_ndb_err_to_response(response,
+                               FAILED_EXEC_TXN,
+                               trans->getNdbError());
+    co_return trans->getNdbError().code;
+}
+
+ndb_task delete_key_rows(pink::RespWriter *response,
+                         struct worker_context *ctx,
+                         NdbTransaction *trans,
+                         struct key_table **key_rows,
+                         Uint32 num_keys,
+                         const NdbOperation **del_ops) {
+    // Read rondb_key and num_rows before deleting to find the value rows
+    const Uint32 mask = KEY_TABLE_MASK_VALUE_ROWS;
+    const unsigned char *mask_ptr = (const unsigned char *)&mask;
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        del_ops[i] = trans->deleteTuple(pk_key_record,
+                                        (const char *)key_rows[i],
+                                        entire_key_record,
+                                        (char *)key_rows[i],
+                                        mask_ptr);
+        if (del_ops[i] == nullptr)
+        {
+            assign_ndb_err_to_response(response,
+                                       FAILED_GET_OP,
+                                       trans->getNdbError());
+            co_return RONDB_INTERNAL_ERROR;
+        }
+    }
+    if (co_await execute_async(ctx, trans, NdbTransaction::NoCommit, NdbOperation::AO_IgnoreError) != 0 &&
+        trans->getNdbError().classification != NdbError::NoDataFound)
+    {
+        assign_ndb_err_to_response(response,
+                                   FAILED_EXEC_TXN,
+                                   trans->getNdbError());
+        co_return RONDB_INTERNAL_ERROR;
+    }
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        const NdbError &error = del_ops[i]->getNdbError();
+        if (error.code != 0 && error.classification != NdbError::NoDataFound)
+        {
+            assign_ndb_err_to_response(response, FAILED_EXEC_TXN, error);
+            co_return RONDB_INTERNAL_ERROR;
+        }
+    }
+    co_return 0;
+}
+
+ndb_task delete_all_value_rows(pink::RespWriter *response,
+                               struct worker_context *ctx,
+                               NdbTransaction *trans,
+                               struct key_table **key_rows,
+                               Uint32 num_keys,
+                               struct value_table *value_row) {
+    for (Uint32 i = 0; i < num_keys; i++)
+    {
+        for (Uint32 ordinal = 0; ordinal < key_rows[i]->num_rows; ordinal++)
+        {
+            value_row->rondb_key = key_rows[i]->rondb_key;
+            value_row->ordinal = ordinal;
+            const NdbOperation *del_op = trans->deleteTuple(
+                pk_value_record,
+                (const char *)value_row,
+                entire_value_record);
+            if (del_op == nullptr)
+            {
+                assign_ndb_err_to_response(response,
+                                           FAILED_GET_OP,
+                                           trans->getNdbError());
+                co_return RONDB_INTERNAL_ERROR;
+            }
+        }
+    }
+    if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                               NdbOperation::AbortOnError) != 0 ||
+        trans->getNdbError().code != 0)
+    {
+        assign_ndb_err_to_response(response,
+                                   FAILED_EXEC_TXN,
+                                   trans->getNdbError());
+        co_return RONDB_INTERNAL_ERROR;
+    }
+    co_return 0;
 }
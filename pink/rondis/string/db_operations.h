@@ -4,28 +4,41 @@
 #include "pink/include/redis_conn.h"
 #include <ndbapi/NdbApi.hpp>
 #include <ndbapi/Ndb.hpp>
+#include "../coroutine.h"
 
 #ifndef STRING_DB_OPERATIONS_H
 #define STRING_DB_OPERATIONS_H
 
 const Uint32 ROWS_PER_READ = 2;
 
-int create_key_row(std::string *response,
-                   const NdbDictionary::Table *tab,
-                   NdbTransaction *trans,
-                   Uint64 redis_key_id,
-                   Uint64 rondb_key,
-                   const char *key_str,
-                   Uint32 key_len,
-                   const char *value_str,
-                   Uint32 tot_value_len,
-                   Uint32 num_value_rows,
-                   Uint32 &prev_num_rows,
-                   Uint32 row_state);
-
-int write_data_to_key_op(std::string *response,
+struct worker_context;
+
+/*
+    The functions returning an ndb_task wait for their round trips with
+    execute_async (see coroutine.h), so they are awaited by the commands.
+
+    create_key_row() writes inline_value_len bytes of value_str into the
+    key row, tot_value_len is the length of the whole value. They differ
+    for values with value rows and for compressed values, whose
+    value_data_type is given as row_state.
+*/
+ndb_task create_key_row(pink::RespWriter *response,
+                        struct worker_context *ctx,
+                        NdbTransaction *trans,
+                        Uint64 redis_key_id,
+                        Uint64 rondb_key,
+                        const char *key_str,
+                        Uint32 key_len,
+                        const char *value_str,
+                        Uint32 tot_value_len,
+                        Uint32 inline_value_len,
+                        Uint32 num_value_rows,
+                        Uint32 &prev_num_rows,
+                        Uint32 row_state);
+
+int write_data_to_key_op(pink::RespWriter *response,
                          const NdbOperation **ndb_op,
-                         const NdbDictionary::Table *tab,
+                         struct worker_context *ctx,
                          NdbTransaction *trans,
                          Uint64 redis_key_id,
                          Uint64 rondb_key,
@@ -33,23 +46,23 @@ int write_data_to_key_op(std::string *response,
                          Uint32 key_len,
                          const char *value_str,
                          Uint32 tot_value_len,
+                         Uint32 inline_value_len,
                          Uint32 num_value_rows,
                          Uint32 &prev_num_rows,
                          Uint32 row_state,
                          NdbRecAttr **recAttr);
 
-int delete_key_row(std::string *response,
-                   Ndb *ndb,
-                   const NdbDictionary::Table *tab,
-                   NdbTransaction *trans,
-                   Uint64 redis_key_id,
-                   const char *key_str,
-                   Uint32 key_len,
-                   char *buf);
-
-int create_value_row(std::string *response,
-                     Ndb *ndb,
-                     const NdbDictionary::Dictionary *dict,
+ndb_task delete_key_row(pink::RespWriter *response,
+                        struct worker_context *ctx,
+                        const NdbDictionary::Table *tab,
+                        NdbTransaction *trans,
+                        Uint64 redis_key_id,
+                        const char *key_str,
+                        Uint32 key_len,
+                        char *buf);
+
+int create_value_row(pink::RespWriter *response,
+                     struct worker_context *ctx,
                      NdbTransaction *trans,
                      const char *start_value_ptr,
                      Uint64 key_id,
@@ -57,68 +70,227 @@ int create_value_row(std::string *response,
                      Uint32 ordinal,
                      char *buf);
 
-int create_all_value_rows(std::string *response,
-                          Ndb *ndb,
-                          const NdbDictionary::Dictionary *dict,
-                          NdbTransaction *trans,
-                          Uint64 rondb_key,
-                          const char *value_str,
-                          Uint32 value_len,
-                          Uint32 num_value_rows,
-                          char *buf);
-
-int delete_value_rows(std::string *response,
-                      const NdbDictionary::Table *tab,
-                      NdbTransaction *trans,
-                      Uint64 rondb_key,
-                      Uint32 start_ordinal,
-                      Uint32 end_ordinal);
+ndb_task create_all_value_rows(pink::RespWriter *response,
+                               struct worker_context *ctx,
+                               NdbTransaction *trans,
+                               Uint64 rondb_key,
+                               const char *value_str,
+                               Uint32 value_len,
+                               Uint32 num_value_rows,
+                               char *buf);
+
+/*
+    Writes the value rows of the value_len bytes at value_str, the first
+    of them with ordinal start_ordinal. Used directly for values that are
+    written in parts, see set_upload.
+*/
+ndb_task create_value_rows(pink::RespWriter *response,
+                           struct worker_context *ctx,
+                           NdbTransaction *trans,
+                           Uint64 rondb_key,
+                           const char *value_str,
+                           Uint32 value_len,
+                           Uint32 start_ordinal,
+                           char *buf);
+
+ndb_task delete_value_rows(pink::RespWriter *response,
+                           struct worker_context *ctx,
+                           const NdbDictionary::Table *tab,
+                           NdbTransaction *trans,
+                           Uint64 rondb_key,
+                           Uint32 start_ordinal,
+                           Uint32 end_ordinal);
 /*
     Since the beginning of the value is saved within the key table, it
     can suffice to read the key table to get the value. If the value is
 */
-int get_simple_key_row(std::string *response,
-                       const NdbDictionary::Table *tab,
-                       Ndb *ndb,
-                       NdbTransaction *trans,
-                       struct key_table *key_row);
+ndb_task get_simple_key_row(pink::RespWriter *response,
+                            struct worker_context *ctx,
+                            NdbTransaction *trans,
+                            struct key_table *key_row);
 
-int get_complex_key_row(std::string *response,
-                        const NdbDictionary::Dictionary *dict,
-                        const NdbDictionary::Table *tab,
-                        Ndb *ndb,
-                        NdbTransaction *trans,
-                        struct key_table *row);
+/*
+    The prepare_* functions only define the operation on the transaction,
+    the complete_* functions interpret the outcome once the transaction
+    has been executed, see get_simple_key_row() and incr_key_row().
+*/
+int prepare_simple_key_row_read(pink::RespWriter *response,
+                                NdbTransaction *trans,
+                                struct key_table *key_row,
+                                const NdbOperation **read_op);
+
+int complete_simple_key_row_read(pink::RespWriter *response,
+                                 const NdbOperation *read_op,
+                                 bool exec_failed,
+                                 struct key_table *key_row);
+
+/*
+    Reads the key row with a shared lock, without committing, so that the
+    value rows read later in the transaction belong to the same value.
+*/
+ndb_task read_locked_key_row(pink::RespWriter *response,
+                             struct worker_context *ctx,
+                             NdbTransaction *trans,
+                             struct key_table *key_row);
 
-int get_value_rows(std::string *response,
-                   Ndb *ndb,
-                   const NdbDictionary::Dictionary *dict,
-                   NdbTransaction *trans,
-                   const Uint32 num_rows,
-                   const Uint64 key_id,
-                   const Uint32 tot_value_len);
+ndb_task get_complex_key_row(pink::RespWriter *response,
+                             struct worker_context *ctx,
+                             NdbTransaction *trans,
+                             struct key_table *row);
 
-int read_batched_value_rows(std::string *response,
+/*
+    Reads the key row and all of its value rows in a single round trip
+    using a linked query, based on the number of value rows that an
+    earlier read of the key row returned. Returns INCONSISTENT_READ_ERROR
+    without touching the response if the value changed in the meantime or
+    is too large; get_complex_key_row() must then be used instead.
+*/
+ndb_task get_linked_key_row(pink::RespWriter *response,
+                            struct worker_context *ctx,
                             NdbTransaction *trans,
-                            const Uint64 rondb_key,
-                            const Uint32 num_rows_to_read,
-                            const Uint32 start_ordinal,
-                            const NdbTransaction::ExecType commit_type);
+                            struct key_table *key_row);
+
+/*
+    Reads the value rows of a value into value_rows, which must have room
+    for num_rows rows.
+*/
+ndb_task get_value_rows(pink::RespWriter *response,
+                        struct worker_context *ctx,
+                        NdbTransaction *trans,
+                        const Uint32 num_rows,
+                        const Uint64 key_id,
+                        struct value_table *value_rows);
+
+ndb_task read_batched_value_rows(pink::RespWriter *response,
+                                 struct worker_context *ctx,
+                                 NdbTransaction *trans,
+                                 const Uint64 rondb_key,
+                                 const Uint32 num_rows_to_read,
+                                 const Uint32 start_ordinal,
+                                 const NdbTransaction::ExecType commit_type,
+                                 struct value_table *value_rows);
+
+/*
+    Appends the values of the value rows to the response without copying
+    them. The caller must make the response retain the rows, see
+    pink::RespWriter::Retain().
+*/
+void append_value_rows(pink::RespWriter *response,
+                       const struct value_table *value_rows,
+                       Uint32 num_rows);
 
 int rondb_get_rondb_key(const NdbDictionary::Table *tab,
                         Uint64 &key_id,
                         Ndb *ndb,
-                        std::string *response);
-
-void incr_key_row(std::string *response,
-                  Ndb *ndb,
-                  const NdbDictionary::Table *tab,
-                  NdbTransaction *trans,
-                  struct key_table *key_row);
-
-int rondb_get_redis_key_id(Ndb *ndb,
-                           Uint64 &redis_key_id,
-                           const char *key_str,
-                           Uint32 key_len,
-                           std::string *response);
+                        pink::RespWriter *response);
+
+// Adds increment to the counter of the key row and replies with the result
+ndb_task incr_key_row(pink::RespWriter *response,
+                      struct worker_context *ctx,
+                      NdbTransaction *trans,
+                      struct key_table *key_row,
+                      Int64 increment);
+
+int prepare_incr_key_row(pink::RespWriter *response,
+                         NdbTransaction *trans,
+                         struct key_table *key_row,
+                         const NdbInterpretedCode *incr_code,
+                         NdbRecAttr **recAttr);
+
+void complete_incr_key_row(pink::RespWriter *response,
+                           NdbTransaction *trans,
+                           bool exec_failed,
+                           NdbRecAttr *recAttr);
+
+/*
+    The following functions define the operations on several keys at once
+    and execute them in a single round trip. The mask selects the key table
+    columns to read, see KEY_TABLE_MASK_*. They are used by the multi-key
+    commands (MGET, MSET, MSETNX, DEL, EXISTS).
+
+    read_key_rows() and delete_key_rows() ignore missing keys, the caller
+    checks the NdbError of each returned operation for NoDataFound.
+*/
+ndb_task read_key_rows(pink::RespWriter *response,
+                       struct worker_context *ctx,
+                       NdbTransaction *trans,
+                       struct key_table **key_rows,
+                       Uint32 num_keys,
+                       Uint32 mask,
+                       NdbOperation::LockMode lock_mode,
+                       NdbTransaction::ExecType commit_type,
+                       const NdbOperation **read_ops);
+
+/*
+    Reads the value rows of all given key rows in one batch and commits.
+    value_rows must have room for the sum of their num_rows.
+*/
+ndb_task read_all_value_rows(pink::RespWriter *response,
+                             struct worker_context *ctx,
+                             NdbTransaction *trans,
+                             struct key_table **key_rows,
+                             Uint32 num_keys,
+                             struct value_table *value_rows);
+
+/*
+    Writes all key/value pairs of argv starting at arg_index_start. All
+    values must be inline. Returns RESTRICT_VALUE_ROWS_ERROR without
+    touching the response if one of the keys has value rows.
+*/
+ndb_task write_inline_key_rows(pink::RespWriter *response,
+                               struct worker_context *ctx,
+                               NdbTransaction *trans,
+                               const pink::RedisCmdArgsViewType &argv,
+                               Uint32 arg_index_start);
+
+/*
+    Inserts all key/value pairs of argv starting at arg_index_start,
+    including value rows. A key given more than once gets its last value.
+    If one of the keys exists, nothing is written and TUPLE_EXISTS_ERROR
+    is returned. The response may then contain an
+    error message already.
+*/
+ndb_task insert_key_rows(pink::RespWriter *response,
+                         struct worker_context *ctx,
+                         NdbTransaction *trans,
+                         const pink::RedisCmdArgsViewType &argv,
+                         Uint32 arg_index_start,
+                         struct key_table *key_row,
+                         char *buf);
+
+ndb_task delete_key_rows(pink::RespWriter *response,
+                         struct worker_context *ctx,
+                         NdbTransaction *trans,
+                         struct key_table **key_rows,
+                         Uint32 num_keys,
+                         const NdbOperation **del_ops);
+
+// Deletes the value rows of all given key rows and commits
+ndb_task delete_all_value_rows(pink::RespWriter *response,
+                               struct worker_context *ctx,
+                               NdbTransaction *trans,
+                               struct key_table **key_rows,
+                               Uint32 num_keys,
+                               struct value_table *value_row);
+
+/*
+    Returns the redis_key_id of a hash key, creating the hash key if it
+    does not exist yet.
+*/
+ndb_task rondb_get_redis_key_id(struct worker_context *ctx,
+                                Uint64 &redis_key_id,
+                                const char *key_str,
+                                Uint32 key_len,
+                                pink::RespWriter *response);
+
+/*
+    Like rondb_get_redis_key_id(), but for commands that only read: a hash
+    key that does not exist is not created. The response is then nil and
+    READ_ERROR is returned.
+*/
+ndb_task rondb_find_redis_key_id(struct worker_context *ctx,
+                                 Uint64 &redis_key_id,
+                                 const char *key_str,
+                                 Uint32 key_len,
+                                 pink::RespWriter *response);
 #endif
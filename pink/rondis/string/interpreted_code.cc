@@ -5,15 +5,19 @@
 #include "commands.h"
 #include "interpreted_code.h"
 #include "table_definitions.h"
+#include "../coroutine.h"
+#include "../worker_context.h"
 
 // Define the interpreted program for the INCR operation
-int initNdbCodeIncr(std::string *response,
+int initNdbCodeIncr(pink::RespWriter *response,
                     NdbInterpretedCode *code,
-                    const NdbDictionary::Table *tab)
+                    const NdbDictionary::Table *tab,
+                    Int64 increment)
 {
     const NdbDictionary::Column *value_start_col = tab->getColumn(KEY_TABLE_COL_value_start);
     const NdbDictionary::Column *tot_value_len_col = tab->getColumn(KEY_TABLE_COL_tot_value_len);
     const NdbDictionary::Column *rondb_key_col = tab->getColumn(KEY_TABLE_COL_rondb_key);
+    const NdbDictionary::Column *value_data_type_col = tab->getColumn(KEY_TABLE_COL_value_data_type);
 
     code->load_const_u16(REG0, MEMORY_OFFSET_LEN_BYTES);
     code->load_const_u16(REG6, MEMORY_OFFSET_START);
@@ -23,13 +27,17 @@ int initNdbCodeIncr(std::string *response,
     /**
      * The first 4 bytes of the memory must be kept for the Attribute header
      * REG0 Memory offset == 4
-     * REG1 Memory offset == 6
+     * REG1 Memory offset == 6, value_data_type while reading the value
      * REG2 Size of value_start
      * REG3 Size of value_start without length bytes
-     * REG4 Old integer value after conversion
+     * REG4 Old integer value
      * REG5 New integer value after increment
      * REG6 Memory offset == 0
-     * REG7 Value of rondb_key (should be NULL)
+     * REG7 Value of rondb_key (should be NULL), later the increment
+     *
+     * The new value is always written as VALUE_DATA_TYPE_INT64, the final
+     * update of the operation sets value_data_type accordingly. A value
+     * written by SET is converted from its decimal string once.
      */
     /* UPDATE code */
     code->read_attr(REG7, rondb_key_col);
@@ -37,37 +45,29 @@ int initNdbCodeIncr(std::string *response,
     code->interpret_exit_nok(RONDB_KEY_NOT_NULL_ERROR);
     code->def_label(LABEL0);
     code->read_full(value_start_col, REG6, REG2); // Read value_start column
+    code->read_attr(REG1, value_data_type_col);
+    code->branch_eq_const(REG1, VALUE_DATA_TYPE_INT64, LABEL2);
     code->load_const_u16(REG1, MEMORY_OFFSET_STRING);
     code->sub_const_reg(REG3, REG2, NUM_LEN_BYTES);
     code->str_to_int64(REG4, REG1, REG3); // Convert string to number
-    code->add_const_reg(REG5, REG4, INCREMENT_VALUE);
-    code->int64_to_str(REG3, REG1, REG5);           // Convert number to string
-    code->add_const_reg(REG2, REG3, NUM_LEN_BYTES); // New value_start length
-    code->write_size_mem(REG3, REG0);               // Write back length bytes in memory
+    code->branch_label(LABEL3);
+    code->def_label(LABEL2);
+    code->read_int64_to_reg_const(REG4, MEMORY_OFFSET_STRING);
+    code->branch_label(LABEL3);
 
-    code->write_interpreter_output(REG5, OUTPUT_INDEX); // Write into output index 0
-    code->write_from_mem(value_start_col, REG6, REG2);  // Write to column
-    code->write_attr(tot_value_len_col, REG3);
-    code->interpret_exit_ok();
-
-    /* INSERT code */
+    /* INSERT code, increments 0 */
     code->def_label(LABEL1);
-    code->load_const_u16(REG5, INITIAL_INT_VALUE);
-    code->load_const_u16(REG3, INITIAL_INT_STRING_LEN);
-    code->write_interpreter_output(REG5, OUTPUT_INDEX); // Write into output index 0
+    code->load_const_u64(REG4, 0);
 
-    Uint32 insert_value;
-    Uint8 *insert_value_ptr = (Uint8 *)&insert_value;
-    insert_value_ptr[0] = 1;                  // Length is 1
-    insert_value_ptr[1] = 0;                  // Second length byte is 0
-    insert_value_ptr[2] = INITIAL_INT_STRING; // Inserts a string '1'
-    insert_value_ptr[3] = 0;
-
-    code->load_const_mem(REG0,
-                         REG2,
-                         INITIAL_INT_STRING_LEN_WITH_LEN_BYTES,
-                         &insert_value);
-    code->write_from_mem(value_start_col, REG6, REG2); // Write to column
+    code->def_label(LABEL3);
+    code->load_const_u64(REG7, (Uint64)increment);
+    code->add_reg(REG5, REG4, REG7);
+    code->write_interpreter_output(REG5, OUTPUT_INDEX); // Write into output index 0
+    code->write_int64_reg_to_mem_const(REG5, MEMORY_OFFSET_STRING);
+    code->load_const_u16(REG3, INT64_VALUE_LEN);
+    code->write_size_mem(REG3, REG0);               // Write length bytes in memory
+    code->add_const_reg(REG2, REG3, NUM_LEN_BYTES); // New value_start length
+    code->write_from_mem(value_start_col, REG6, REG2);  // Write to column
     code->write_attr(tot_value_len_col, REG3);
     code->interpret_exit_ok();
 
@@ -83,15 +83,16 @@ int initNdbCodeIncr(std::string *response,
     return 0;
 }
 
-int write_hset_key_table(Ndb *ndb,
-                         const NdbDictionary::Table *tab,
-                         std::string std_key_str,
-                         Uint64 & redis_key_id,
-                         std::string *response) {
+ndb_task write_hset_key_table(struct worker_context *ctx,
+                              const NdbDictionary::Table *tab,
+                              std::string_view key,
+                              Uint64 & redis_key_id,
+                              pink::RespWriter *response) {
+    Ndb *ndb = ctx->ndb;
     /* Prepare primary key */
     struct hset_key_table key_row;
-    const char *key_str = std_key_str.c_str();
-    Uint32 key_len = std_key_str.size();
+    const char *key_str = key.data();
+    Uint32 key_len = key.size();
     set_length(&key_row.redis_key[0], key_len);
     memcpy(&key_row.redis_key[2], key_str, key_len);
 
@@ -121,7 +122,7 @@ int write_hset_key_table(Ndb *ndb,
         assign_ndb_err_to_response(response,
                                    "Failed to create Interpreted code",
                                    code.getNdbError());
-        return -1;
+        co_return -1;
     }
     // Prepare the interpreted program to be part of the write
     NdbOperation::OperationOptions opts;
@@ -157,26 +158,26 @@ int write_hset_key_table(Ndb *ndb,
         assign_ndb_err_to_response(response,
                                    "Failed to create NdbOperation",
                                    trans->getNdbError());
-        return -1;
+        co_return -1;
     }
-    if (trans->execute(NdbTransaction::Commit,
-                       NdbOperation::AbortOnError) != 0 ||
+    if (co_await execute_async(ctx, trans, NdbTransaction::Commit,
+                               NdbOperation::AbortOnError) != 0 ||
         trans->getNdbError().code != 0)
     {
         ndb->closeTransaction(trans);
         assign_ndb_err_to_response(response,
                                    FAILED_HSET_KEY,
                                    trans->getNdbError());
-        return -1;
+        co_return -1;
     }
     /* Retrieve the returned new value as an Uint64 value */
     NdbRecAttr *recAttr = getvals[0].recAttr;
     redis_key_id = recAttr->u_64_value();
     ndb->closeTransaction(trans);
-    return 0;
+    co_return 0;
 }
 
-int write_key_row_no_commit(std::string *response,
+int write_key_row_no_commit(pink::RespWriter *response,
                             NdbInterpretedCode &code,
                             const NdbDictionary::Table *tab) {
     const NdbDictionary::Column *num_rows_col = tab->getColumn(KEY_TABLE_COL_num_rows);
@@ -205,7 +206,7 @@ int write_key_row_no_commit(std::string *response,
     return 0;
 }
 
-int write_key_row_commit(std::string *response,
+int write_key_row_commit(pink::RespWriter *response,
                          NdbInterpretedCode &code,
                          const NdbDictionary::Table *tab) {
     const NdbDictionary::Column *num_rows_col = tab->getColumn(KEY_TABLE_COL_num_rows);
@@ -1,4 +1,7 @@
+#include <string_view>
 #include <ndbapi/NdbApi.hpp>
+#include "pink/include/resp_writer.h"
+#include "../coroutine.h"
 
 #ifndef STRING_INTERPRETED_CODE_H
 #define STRING_INTERPRETED_CODE_H
@@ -15,33 +18,35 @@
 #define REG7 7
 #define LABEL0 0
 #define LABEL1 1
+#define LABEL2 2
+#define LABEL3 3
 
 #define MEMORY_OFFSET_START 0
 #define MEMORY_OFFSET_LEN_BYTES 4
 #define MEMORY_OFFSET_STRING 6
 #define NUM_LEN_BYTES 2
-#define INCREMENT_VALUE 1
 #define OUTPUT_INDEX 0
 #define RONDB_KEY_NOT_NULL_ERROR 6000
 
-#define INITIAL_INT_VALUE 1
-#define INITIAL_INT_STRING '1'
-#define INITIAL_INT_STRING_LEN 1
-#define INITIAL_INT_STRING_LEN_WITH_LEN_BYTES 3
-
-int initNdbCodeIncr(std::string *response,
+/*
+    Adds increment to the integer value of a key row, creating it with the
+    value increment if it does not exist. The new value is written as
+    VALUE_DATA_TYPE_INT64.
+*/
+int initNdbCodeIncr(pink::RespWriter *response,
                     NdbInterpretedCode *code,
-                    const NdbDictionary::Table *tab);
+                    const NdbDictionary::Table *tab,
+                    Int64 increment);
 
-int write_hset_key_table(Ndb *ndb,
-                         const NdbDictionary::Table *tab,
-                         std::string std_key_str,
-                         Uint64 & redis_key_id,
-                         std::string *response);
-int write_key_row_commit(std::string *response,
+ndb_task write_hset_key_table(struct worker_context *ctx,
+                              const NdbDictionary::Table *tab,
+                              std::string_view key,
+                              Uint64 & redis_key_id,
+                              pink::RespWriter *response);
+int write_key_row_commit(pink::RespWriter *response,
                          NdbInterpretedCode &code,
                          const NdbDictionary::Table *tab);
-int write_key_row_no_commit(std::string *response,
+int write_key_row_no_commit(pink::RespWriter *response,
                             NdbInterpretedCode &code,
                             const NdbDictionary::Table *tab);
 #endif
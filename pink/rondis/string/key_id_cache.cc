@@ -0,0 +1,136 @@
+#include <stdio.h>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#include "../common.h"
+#include "key_id_cache.h"
+#include "table_definitions.h"
+
+#define KEY_ID_CACHE_SHARD_ENTRIES (KEY_ID_CACHE_ENTRIES / KEY_ID_CACHE_SHARDS)
+
+struct key_id_cache_entry
+{
+    std::string key;
+    Uint64 redis_key_id;
+    // Looked up since the clock hand passed it last
+    bool referenced;
+};
+
+struct key_id_cache_shard
+{
+    std::mutex mutex;
+    /*
+        The keys are views of those in entries, which stay in place since
+        entries only grows at the end and an evicted entry is reused.
+    */
+    std::unordered_map<std::string_view, Uint32> slots;
+    std::deque<struct key_id_cache_entry> entries;
+    Uint32 clock_hand;
+};
+
+static struct key_id_cache_shard key_id_cache[KEY_ID_CACHE_SHARDS];
+
+static struct key_id_cache_shard *get_shard(std::string_view key)
+{
+    return &key_id_cache[std::hash<std::string_view>()(key) % KEY_ID_CACHE_SHARDS];
+}
+
+bool key_id_cache_find(std::string_view key, Uint64 *redis_key_id)
+{
+    struct key_id_cache_shard *shard = get_shard(key);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto it = shard->slots.find(key);
+    if (it == shard->slots.end())
+        return false;
+    struct key_id_cache_entry &entry = shard->entries[it->second];
+    entry.referenced = true;
+    *redis_key_id = entry.redis_key_id;
+    return true;
+}
+
+void key_id_cache_insert(std::string_view key, Uint64 redis_key_id)
+{
+    struct key_id_cache_shard *shard = get_shard(key);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    auto it = shard->slots.find(key);
+    if (it != shard->slots.end())
+    {
+        // Another worker inserted it meanwhile, RonDB gave both the same id
+        shard->entries[it->second].redis_key_id = redis_key_id;
+        return;
+    }
+    Uint32 slot;
+    if (shard->entries.size() < KEY_ID_CACHE_SHARD_ENTRIES)
+    {
+        slot = shard->entries.size();
+        shard->entries.emplace_back();
+    }
+    else
+    {
+        while (shard->entries[shard->clock_hand].referenced)
+        {
+            shard->entries[shard->clock_hand].referenced = false;
+            shard->clock_hand = (shard->clock_hand + 1) % KEY_ID_CACHE_SHARD_ENTRIES;
+        }
+        slot = shard->clock_hand;
+        shard->clock_hand = (shard->clock_hand + 1) % KEY_ID_CACHE_SHARD_ENTRIES;
+        shard->slots.erase(shard->entries[slot].key);
+    }
+    struct key_id_cache_entry &entry = shard->entries[slot];
+    entry.key.assign(key.data(), key.size());
+    entry.redis_key_id = redis_key_id;
+    entry.referenced = true;
+    shard->slots.emplace(entry.key, slot);
+}
+
+int key_id_cache_warm_up(Ndb *ndb)
+{
+    NdbTransaction *trans = ndb->startTransaction();
+    if (trans == nullptr)
+    {
+        printf("Failed to start transaction for hash key scan: %s\n",
+               ndb->getNdbError().message);
+        return -1;
+    }
+    // Without SO_PARALLEL, all fragments are scanned in parallel
+    NdbScanOperation *scan_op = trans->scanTable(entire_hset_key_record,
+                                                 NdbOperation::LM_CommittedRead);
+    if (scan_op == nullptr ||
+        trans->execute(NdbTransaction::NoCommit) != 0)
+    {
+        printf("Failed to scan table %s: %s\n",
+               HSET_KEY_TABLE_NAME,
+               trans->getNdbError().message);
+        ndb->closeTransaction(trans);
+        return -1;
+    }
+    Uint32 num_keys = 0;
+    const char *row = nullptr;
+    int ret_code = 0;
+    while (num_keys < KEY_ID_CACHE_ENTRIES &&
+           (ret_code = scan_op->nextResult(&row, true, false)) == 0)
+    {
+        const struct hset_key_table *key_row = (const struct hset_key_table *)row;
+        Uint32 key_len = get_length((char *)&key_row->redis_key[0]);
+        key_id_cache_insert(std::string_view(&key_row->redis_key[2], key_len),
+                            key_row->redis_key_id);
+        num_keys++;
+    }
+    if (num_keys < KEY_ID_CACHE_ENTRIES && ret_code == -1)
+    {
+        printf("Failed to scan table %s: %s\n",
+               HSET_KEY_TABLE_NAME,
+               trans->getNdbError().message);
+        ndb->closeTransaction(trans);
+        return -1;
+    }
+    ndb->closeTransaction(trans);
+    printf("Cached the ids of %u hash keys\n", num_keys);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#include <string_view>
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#ifndef STRING_KEY_ID_CACHE_H
+#define STRING_KEY_ID_CACHE_H
+
+/*
+    Cache of the redis_key_id of hash keys (see the HSET KEY TABLE), shared
+    by all worker threads. The ids are kept in RonDB, so the cache may drop
+    any of them: it is split into KEY_ID_CACHE_SHARDS shards, each with its
+    own mutex and at most KEY_ID_CACHE_ENTRIES / KEY_ID_CACHE_SHARDS keys,
+    and a full shard evicts a key that was not looked up recently (CLOCK).
+*/
+#define KEY_ID_CACHE_SHARDS 64
+#define KEY_ID_CACHE_ENTRIES (1024 * 1024)
+
+// Returns false if the key is not cached, lookups do not allocate
+bool key_id_cache_find(std::string_view key, Uint64 *redis_key_id);
+
+void key_id_cache_insert(std::string_view key, Uint64 redis_key_id);
+
+/*
+    Fills the cache with the hash keys in RonDB, up to its size, using a
+    scan of the HSET KEY TABLE that reads all of its fragments in parallel.
+    Only to be called at startup, before the worker threads run.
+*/
+int key_id_cache_warm_up(Ndb *ndb);
+#endif
@@ -0,0 +1,419 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#include "../common.h"
+#include "read_cache.h"
+#include "table_definitions.h"
+
+// Error code of createEvent() if another Rondis server created the event
+#define EVENT_EXISTS_ERROR 746
+
+#define SKETCH_ROWS 4
+#define SKETCH_MAX_COUNT 15
+
+struct read_cache_entry
+{
+    std::string key;
+    // The complete GET reply, a bulk string or nil
+    std::string reply;
+    // Looked up since the clock hand passed it last
+    bool referenced;
+    bool in_use;
+};
+
+struct read_cache_shard
+{
+    std::mutex mutex;
+    /*
+        The keys are views of those in entries, which stay in place since
+        entries only grows at the end and an evicted entry is reused.
+    */
+    std::unordered_map<std::string_view, Uint32> slots;
+    std::deque<struct read_cache_entry> entries;
+    std::vector<Uint32> free_slots;
+    Uint32 clock_hand;
+    size_t bytes;
+    // Incremented by every invalidation, see read_cache_version()
+    Uint64 version;
+    /*
+        Count-min sketch of how often keys were looked up, the counters
+        are halved every READ_CACHE_SKETCH_PERIOD lookups so that it
+        follows the keys that are hot now.
+    */
+    Uint8 sketch[SKETCH_ROWS][READ_CACHE_SKETCH_WIDTH];
+    Uint32 sketch_count;
+};
+
+static struct read_cache_shard read_cache[READ_CACHE_SHARDS];
+static size_t shard_max_bytes = 0;
+static std::atomic<bool> cache_enabled(false);
+
+static Ndb *event_ndb = nullptr;
+static NdbEventOperation *event_op = nullptr;
+static NdbRecAttr *event_key_id = nullptr;
+static NdbRecAttr *event_key = nullptr;
+static std::thread event_thread;
+static std::atomic<bool> stopping(false);
+
+static Uint64 hash_key(std::string_view key)
+{
+    return std::hash<std::string_view>()(key);
+}
+
+static struct read_cache_shard *get_shard(Uint64 hash)
+{
+    return &read_cache[hash % READ_CACHE_SHARDS];
+}
+
+// The shard was selected with the low bits, the sketch uses the high ones
+static Uint32 sketch_index(Uint64 hash, Uint32 row)
+{
+    Uint64 mixed = hash * 0x9E3779B97F4A7C15ULL;
+    return (Uint32)(mixed >> (16 * row)) % READ_CACHE_SKETCH_WIDTH;
+}
+
+static Uint32 sketch_estimate(struct read_cache_shard *shard, Uint64 hash)
+{
+    Uint32 count = SKETCH_MAX_COUNT;
+    for (Uint32 row = 0; row < SKETCH_ROWS; row++)
+        count = std::min(count, (Uint32)shard->sketch[row][sketch_index(hash, row)]);
+    return count;
+}
+
+static void sketch_increment(struct read_cache_shard *shard, Uint64 hash)
+{
+    for (Uint32 row = 0; row < SKETCH_ROWS; row++)
+    {
+        Uint8 &counter = shard->sketch[row][sketch_index(hash, row)];
+        if (counter < SKETCH_MAX_COUNT)
+            counter++;
+    }
+    if (++shard->sketch_count < READ_CACHE_SKETCH_PERIOD)
+        return;
+    shard->sketch_count = 0;
+    for (Uint32 row = 0; row < SKETCH_ROWS; row++)
+    {
+        for (Uint32 i = 0; i < READ_CACHE_SKETCH_WIDTH; i++)
+            shard->sketch[row][i] >>= 1;
+    }
+}
+
+static size_t entry_bytes(std::string_view key, size_t reply_len)
+{
+    return key.size() + reply_len + READ_CACHE_ENTRY_OVERHEAD;
+}
+
+static void evict_entry(struct read_cache_shard *shard, Uint32 slot)
+{
+    struct read_cache_entry &entry = shard->entries[slot];
+    shard->slots.erase(entry.key);
+    shard->bytes -= entry_bytes(entry.key, entry.reply.size());
+    std::string().swap(entry.key);
+    std::string().swap(entry.reply);
+    entry.in_use = false;
+    shard->free_slots.push_back(slot);
+}
+
+// Only called if the shard holds at least one entry
+static Uint32 clock_victim(struct read_cache_shard *shard)
+{
+    while (true)
+    {
+        Uint32 slot = shard->clock_hand;
+        shard->clock_hand = (shard->clock_hand + 1) % shard->entries.size();
+        struct read_cache_entry &entry = shard->entries[slot];
+        if (!entry.in_use)
+            continue;
+        if (!entry.referenced)
+            return slot;
+        entry.referenced = false;
+    }
+}
+
+static void clear_shard(struct read_cache_shard *shard)
+{
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->version++;
+    shard->slots.clear();
+    shard->entries.clear();
+    shard->free_slots.clear();
+    shard->clock_hand = 0;
+    shard->bytes = 0;
+}
+
+static void clear_read_cache()
+{
+    for (Uint32 i = 0; i < READ_CACHE_SHARDS; i++)
+        clear_shard(&read_cache[i]);
+}
+
+bool read_cache_enabled()
+{
+    return cache_enabled.load(std::memory_order_relaxed);
+}
+
+bool read_cache_get(std::string_view key, pink::RespWriter *response)
+{
+    Uint64 hash = hash_key(key);
+    struct read_cache_shard *shard = get_shard(hash);
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    sketch_increment(shard, hash);
+    // Checked under the mutex, clear_read_cache() follows disabling it
+    if (!read_cache_enabled())
+        return false;
+    auto it = shard->slots.find(key);
+    if (it == shard->slots.end())
+        return false;
+    struct read_cache_entry &entry = shard->entries[it->second];
+    entry.referenced = true;
+    response->Append(entry.reply);
+    return true;
+}
+
+Uint64 read_cache_version(std::string_view key)
+{
+    struct read_cache_shard *shard = get_shard(hash_key(key));
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    return shard->version;
+}
+
+void read_cache_put(std::string_view key, const std::string_view *value, Uint64 version)
+{
+    Uint64 hash = hash_key(key);
+    struct read_cache_shard *shard = get_shard(hash);
+    size_t reply_len = (value == nullptr) ?
+        strlen(REDIS_NO_SUCH_KEY) :
+        value->size() + 32;
+    if (entry_bytes(key, reply_len) > shard_max_bytes)
+        return;
+
+    std::string reply;
+    if (value == nullptr)
+    {
+        reply = REDIS_NO_SUCH_KEY;
+    }
+    else
+    {
+        reply.reserve(reply_len);
+        reply += '$';
+        reply += std::to_string(value->size());
+        reply += "\r\n";
+        reply.append(value->data(), value->size());
+        reply += "\r\n";
+    }
+
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    if (shard->version != version || !read_cache_enabled())
+        return;
+    auto it = shard->slots.find(key);
+    if (it != shard->slots.end())
+    {
+        // Another worker read it meanwhile, with no write in between
+        return;
+    }
+    size_t bytes = entry_bytes(key, reply.size());
+    if (shard->bytes + bytes > shard_max_bytes)
+    {
+        Uint32 victim = clock_victim(shard);
+        if (sketch_estimate(shard, hash) <=
+            sketch_estimate(shard, hash_key(shard->entries[victim].key)))
+        {
+            return;
+        }
+        evict_entry(shard, victim);
+        while (shard->bytes + bytes > shard_max_bytes)
+            evict_entry(shard, clock_victim(shard));
+    }
+    Uint32 slot;
+    if (!shard->free_slots.empty())
+    {
+        slot = shard->free_slots.back();
+        shard->free_slots.pop_back();
+    }
+    else
+    {
+        slot = shard->entries.size();
+        shard->entries.emplace_back();
+    }
+    struct read_cache_entry &entry = shard->entries[slot];
+    entry.key.assign(key.data(), key.size());
+    entry.reply = std::move(reply);
+    entry.referenced = false;
+    entry.in_use = true;
+    shard->bytes += bytes;
+    shard->slots.emplace(std::string_view(entry.key), slot);
+}
+
+void read_cache_invalidate(std::string_view key)
+{
+    // Enabling the cache again clears it
+    if (!read_cache_enabled())
+        return;
+    struct read_cache_shard *shard = get_shard(hash_key(key));
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->version++;
+    auto it = shard->slots.find(key);
+    if (it != shard->slots.end())
+        evict_entry(shard, it->second);
+}
+
+static int subscribe()
+{
+    NdbDictionary::Dictionary *dict = event_ndb->getDictionary();
+    const NdbDictionary::Table *tab = dict->getTable(KEY_TABLE_NAME);
+    if (tab == nullptr)
+    {
+        printf("Failed getting table for key table of STRING\n");
+        return -1;
+    }
+    NdbDictionary::Event event(READ_CACHE_EVENT_NAME, *tab);
+    event.addTableEvent(NdbDictionary::Event::TE_ALL);
+    const char *columns[] = {KEY_TABLE_COL_redis_key_id, KEY_TABLE_COL_redis_key};
+    event.addEventColumns(2, columns);
+    if (dict->createEvent(event) != 0 &&
+        dict->getNdbError().code != EVENT_EXISTS_ERROR)
+    {
+        printf("Failed to create event %s: %s\n",
+               READ_CACHE_EVENT_NAME,
+               dict->getNdbError().message);
+        return -1;
+    }
+    NdbEventOperation *op = event_ndb->createEventOperation(READ_CACHE_EVENT_NAME);
+    if (op == nullptr)
+    {
+        printf("Failed to create event operation: %s\n",
+               event_ndb->getNdbError().message);
+        return -1;
+    }
+    event_key_id = op->getValue(KEY_TABLE_COL_redis_key_id);
+    event_key = op->getValue(KEY_TABLE_COL_redis_key);
+    if (event_key_id == nullptr || event_key == nullptr || op->execute() != 0)
+    {
+        printf("Failed to subscribe to event %s: %s\n",
+               READ_CACHE_EVENT_NAME,
+               op->getNdbError().message);
+        event_ndb->dropEventOperation(op);
+        return -1;
+    }
+    event_op = op;
+    return 0;
+}
+
+static void unsubscribe()
+{
+    if (event_op == nullptr)
+        return;
+    event_ndb->dropEventOperation(event_op);
+    event_op = nullptr;
+}
+
+/*
+    Stops serving from the cache until the subscription is back, writes
+    made meanwhile would not invalidate it.
+*/
+static void disable_read_cache()
+{
+    cache_enabled.store(false);
+    clear_read_cache();
+    unsubscribe();
+}
+
+static void handle_event(NdbEventOperation *op)
+{
+    switch (op->getEventType2())
+    {
+    case NdbDictionary::Event::TE_INSERT:
+    case NdbDictionary::Event::TE_UPDATE:
+    case NdbDictionary::Event::TE_DELETE:
+    {
+        if (event_key_id->u_64_value() != STRING_REDIS_KEY_ID)
+            return;
+        const unsigned char *key = (const unsigned char *)event_key->aRef();
+        Uint32 key_len = key[0] + (key[1] << 8);
+        read_cache_invalidate(std::string_view((const char *)&key[2], key_len));
+        return;
+    }
+    case NdbDictionary::Event::TE_EMPTY:
+        return;
+    case NdbDictionary::Event::TE_INCONSISTENT:
+    case NdbDictionary::Event::TE_OUT_OF_MEMORY:
+        // Changes of this epoch were lost
+        printf("Read cache missed changes, clearing it\n");
+        clear_read_cache();
+        return;
+    case NdbDictionary::Event::TE_CLUSTER_FAILURE:
+    case NdbDictionary::Event::TE_DROP:
+        printf("Read cache lost its subscription, disabling it\n");
+        disable_read_cache();
+        return;
+    default:
+        return;
+    }
+}
+
+static void read_cache_event_main()
+{
+    while (!stopping.load())
+    {
+        if (event_op == nullptr)
+        {
+            sleep(1);
+            if (subscribe() == 0)
+            {
+                printf("Read cache subscribed again, enabling it\n");
+                // Replies read before the subscription must not be cached
+                clear_read_cache();
+                cache_enabled.store(true);
+            }
+            continue;
+        }
+        int ret_code = event_ndb->pollEvents2(100);
+        if (ret_code < 0)
+        {
+            printf("Failed to poll events: %s\n",
+                   event_ndb->getNdbError().message);
+            disable_read_cache();
+            continue;
+        }
+        NdbEventOperation *op;
+        while (event_op != nullptr && (op = event_ndb->nextEvent2()) != nullptr)
+        {
+            handle_event(op);
+        }
+    }
+}
+
+int start_read_cache(Ndb *ndb, size_t max_bytes)
+{
+    event_ndb = ndb;
+    shard_max_bytes = max_bytes / READ_CACHE_SHARDS;
+    if (subscribe() != 0)
+        return -1;
+    cache_enabled.store(true);
+    event_thread = std::thread(read_cache_event_main);
+    return 0;
+}
+
+void stop_read_cache()
+{
+    if (!event_thread.joinable())
+        return;
+    stopping.store(true);
+    event_thread.join();
+    cache_enabled.store(false);
+    unsubscribe();
+    clear_read_cache();
+}
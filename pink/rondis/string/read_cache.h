@@ -0,0 +1,69 @@
+#include <stddef.h>
+#include <string_view>
+#include "pink/include/redis_conn.h"
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#ifndef STRING_READ_CACHE_H
+#define STRING_READ_CACHE_H
+
+/*
+    Optional cache of GET replies, shared by all worker threads. Only
+    values that fit into the key row are cached, and keys that do not
+    exist as well. The cache is split into READ_CACHE_SHARDS shards, each
+    with its own mutex and an equal part of the memory the cache may use.
+*/
+#define READ_CACHE_SHARDS 64
+
+// Bytes accounted for each entry on top of its key and reply
+#define READ_CACHE_ENTRY_OVERHEAD 96
+
+/*
+    Counters per row of the frequency sketch of a shard (see
+    read_cache_put()), and the number of GETs of a shard after which all
+    of its counters are halved.
+*/
+#define READ_CACHE_SKETCH_WIDTH 4096
+#define READ_CACHE_SKETCH_PERIOD (8 * READ_CACHE_SKETCH_WIDTH)
+
+// The event on the STRING KEY TABLE that the cache subscribes to
+#define READ_CACHE_EVENT_NAME "rondis_string_keys"
+
+/*
+    Enables the cache with at most max_bytes of memory. A thread of its own
+    subscribes to the changes of the STRING KEY TABLE with ndb and drops
+    the keys written by any Rondis server, or the whole cache if changes
+    may have been missed. Every write of a value changes its key row, so
+    the value rows need no subscription. The cache is not enabled if the
+    subscription fails.
+*/
+int start_read_cache(Ndb *ndb, size_t max_bytes);
+
+void stop_read_cache();
+
+bool read_cache_enabled();
+
+// Appends the cached reply of a GET of key to the response
+bool read_cache_get(std::string_view key, pink::RespWriter *response);
+
+/*
+    Returns the version of the shard of key, taken before key is read from
+    RonDB. read_cache_put() does not cache the reply if the shard had a
+    write since then, as the reply may be older than the write.
+*/
+Uint64 read_cache_version(std::string_view key);
+
+/*
+    Caches the reply of a GET of key, value is nullptr if key does not
+    exist. A full shard only evicts an entry for it if key was looked up
+    more often recently than the entry (TinyLFU admission), so that keys
+    read once do not push out the hot ones.
+*/
+void read_cache_put(std::string_view key, const std::string_view *value, Uint64 version);
+
+/*
+    Drops key from the cache. Called after a write of key committed, so
+    that a client reads its own writes without waiting for the event.
+*/
+void read_cache_invalidate(std::string_view key);
+#endif
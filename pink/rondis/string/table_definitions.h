@@ -1,3 +1,4 @@
+#include <map>
 #include <ndbapi/NdbApi.hpp>
 #include <ndbapi/Ndb.hpp>
 
@@ -58,6 +59,25 @@ extern NdbRecord *entire_key_record;
 #define KEY_TABLE_COL_num_rows "num_rows"
 #define KEY_TABLE_COL_value_start "value_start"
 
+/*
+    Masks for NdbRecord operations on the key table, one bit per column
+    in the order of the table definition.
+*/
+#define KEY_TABLE_MASK_ALL_NON_PK 0x1FC
+#define KEY_TABLE_MASK_VALUE_ROWS 0x24 // rondb_key and num_rows
+
+/*
+    Values of value_data_type. A compressed value has no value rows:
+    value_start holds the compressed bytes and tot_value_len the length of
+    the value itself, see value_encoding.h. The counters of INCR are kept
+    as an Int64 in value_start, in the byte order of the data nodes, and
+    only turned into their decimal string when read.
+*/
+#define VALUE_DATA_TYPE_RAW 0
+#define VALUE_DATA_TYPE_DEFLATE 1
+#define VALUE_DATA_TYPE_INT64 2
+#define INT64_VALUE_LEN 8
+
 struct key_table
 {
     Uint32 null_bits;
@@ -0,0 +1,127 @@
+#include <math.h>
+#include <string.h>
+#include <zlib.h>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include "pink/include/redis_conn.h"
+#include "slash/include/slash_string.h"
+
+#include "../common.h"
+#include "table_definitions.h"
+#include "value_encoding.h"
+
+static double sample_entropy(std::string_view value)
+{
+    Uint32 counts[256] = {0};
+    size_t sample_len = std::min(value.size(), (size_t)COMPRESS_SAMPLE_LEN);
+    for (size_t i = 0; i < sample_len; i++)
+    {
+        counts[(unsigned char)value[i]]++;
+    }
+    double entropy = 0;
+    for (Uint32 i = 0; i < 256; i++)
+    {
+        if (counts[i] == 0)
+            continue;
+        double p = (double)counts[i] / sample_len;
+        entropy -= p * log2(p);
+    }
+    return entropy;
+}
+
+bool compress_value(std::string_view value, std::string *compressed)
+{
+    if (value.size() < COMPRESS_MIN_VALUE_LEN ||
+        value.size() > COMPRESS_MAX_VALUE_LEN ||
+        sample_entropy(value) > COMPRESS_MAX_ENTROPY)
+    {
+        return false;
+    }
+    uLongf compressed_len = compressBound(value.size());
+    compressed->resize(compressed_len);
+    if (compress2((Bytef *)compressed->data(),
+                  &compressed_len,
+                  (const Bytef *)value.data(),
+                  value.size(),
+                  Z_BEST_SPEED) != Z_OK ||
+        compressed_len > INLINE_VALUE_LEN ||
+        compressed_len > value.size() - value.size() / 8)
+    {
+        return false;
+    }
+    compressed->resize(compressed_len);
+    return true;
+}
+
+static bool decompress_inline_value(const struct key_table *key_row, char *dest)
+{
+    uLongf value_len = key_row->tot_value_len;
+    return uncompress((Bytef *)dest,
+                      &value_len,
+                      (const Bytef *)&key_row->value_start[2],
+                      get_length((char *)&key_row->value_start[0])) == Z_OK &&
+           value_len == key_row->tot_value_len;
+}
+
+// Writes the decimal string of a VALUE_DATA_TYPE_INT64 value to str
+static Uint32 int64_value_to_str(const struct key_table *key_row, char *str)
+{
+    Int64 value;
+    memcpy(&value, &key_row->value_start[2], sizeof(value));
+    return slash::ll2string(str, INT64_STRING_LEN, value);
+}
+
+int append_inline_value(pink::RespWriter *response, const struct key_table *key_row)
+{
+    if (key_row->value_data_type == VALUE_DATA_TYPE_INT64)
+    {
+        char str[INT64_STRING_LEN];
+        response->AppendBulk(std::string_view(str, int64_value_to_str(key_row, str)));
+        return 0;
+    }
+    if (key_row->value_data_type != VALUE_DATA_TYPE_DEFLATE)
+    {
+        // The key row is reused for other commands, so the value is copied
+        response->AppendBulk(std::string_view(&key_row->value_start[2],
+                                              key_row->tot_value_len));
+        return 0;
+    }
+    std::string *buf = response->buffer();
+    size_t reply_start = buf->size();
+    response->AppendBulkHeader(key_row->tot_value_len);
+    size_t value_start = buf->size();
+    buf->resize(value_start + key_row->tot_value_len);
+    if (!decompress_inline_value(key_row, &(*buf)[value_start]))
+    {
+        // Nothing after reply_start was sent yet
+        buf->resize(reply_start);
+        assign_generic_err_to_response(response, FAILED_DECOMPRESS_VALUE);
+        return -1;
+    }
+    response->Append("\r\n");
+    return 0;
+}
+
+bool get_inline_value(const struct key_table *key_row,
+                      std::string *buf,
+                      std::string_view *value)
+{
+    if (key_row->value_data_type == VALUE_DATA_TYPE_INT64)
+    {
+        buf->resize(INT64_STRING_LEN);
+        buf->resize(int64_value_to_str(key_row, buf->data()));
+        *value = *buf;
+        return true;
+    }
+    if (key_row->value_data_type != VALUE_DATA_TYPE_DEFLATE)
+    {
+        *value = std::string_view(&key_row->value_start[2], key_row->tot_value_len);
+        return true;
+    }
+    buf->resize(key_row->tot_value_len);
+    if (!decompress_inline_value(key_row, buf->data()))
+        return false;
+    *value = *buf;
+    return true;
+}
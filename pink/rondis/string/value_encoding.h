@@ -0,0 +1,48 @@
+#include <string>
+#include <string_view>
+#include "pink/include/redis_conn.h"
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#ifndef STRING_VALUE_ENCODING_H
+#define STRING_VALUE_ENCODING_H
+
+struct key_table;
+
+/*
+    SET compresses values of COMPRESS_MIN_VALUE_LEN to COMPRESS_MAX_VALUE_LEN
+    bytes with deflate (zlib) if they then fit into the key row, so that a
+    value that would need value rows is read in a single round trip.
+    Values whose bytes look random, i.e. whose sample of up to
+    COMPRESS_SAMPLE_LEN bytes has more than COMPRESS_MAX_ENTROPY bits of
+    entropy per byte, are not tried, and neither are values that shrink by
+    less than 1/8.
+*/
+#define COMPRESS_MIN_VALUE_LEN 1024
+#define COMPRESS_MAX_VALUE_LEN (8 * INLINE_VALUE_LEN)
+#define COMPRESS_SAMPLE_LEN 4096
+#define COMPRESS_MAX_ENTROPY 7.0
+
+// Room for the decimal string of an Int64 counter, see VALUE_DATA_TYPE_INT64
+#define INT64_STRING_LEN 32
+
+// Returns false if the value is to be stored as is
+bool compress_value(std::string_view value, std::string *compressed);
+
+/*
+    Appends the value of a key row without value rows to the response as a
+    bulk string, decompressing it right into the reply if it is stored
+    compressed and writing counters as decimal strings. Returns -1 with an
+    error reply if it cannot be decompressed.
+*/
+int append_inline_value(pink::RespWriter *response, const struct key_table *key_row);
+
+/*
+    Sets *value to the value of a key row without value rows. Compressed
+    values and counters are decoded into *buf. Returns false if a value
+    cannot be decompressed.
+*/
+bool get_inline_value(const struct key_table *key_row,
+                      std::string *buf,
+                      std::string_view *value);
+#endif
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include "pink/include/bg_thread.h"
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#include "value_reclaimer.h"
+#include "table_definitions.h"
+
+struct reclaim_task
+{
+    Uint64 rondb_key;
+    Uint32 num_rows;
+};
+
+static pink::BGThread *reclaimer = nullptr;
+static Ndb *reclaimer_ndb = nullptr;
+// Only used by the reclaimer thread, the key is copied when an operation is defined
+static struct value_table *reclaimer_row = nullptr;
+static std::atomic<Uint32> num_queued(0);
+static std::atomic<bool> stopping(false);
+// Keeps tasks from being scheduled while the reclaimer stops
+static std::mutex schedule_mutex;
+
+/*
+    Deletes the value rows from start_ordinal on, up to RECLAIM_BATCH_ROWS
+    of them. Rows that are gone already are skipped.
+*/
+static int delete_value_row_batch(Uint64 rondb_key,
+                                  Uint32 start_ordinal,
+                                  Uint32 end_ordinal)
+{
+    NdbTransaction *trans = reclaimer_ndb->startTransaction();
+    if (trans == nullptr)
+        return -1;
+    for (Uint32 ordinal = start_ordinal; ordinal < end_ordinal; ordinal++)
+    {
+        reclaimer_row->rondb_key = rondb_key;
+        reclaimer_row->ordinal = ordinal;
+        if (trans->deleteTuple(pk_value_record,
+                               (const char *)reclaimer_row,
+                               entire_value_record) == nullptr)
+        {
+            reclaimer_ndb->closeTransaction(trans);
+            return -1;
+        }
+    }
+    int ret_code = 0;
+    if (trans->execute(NdbTransaction::Commit, NdbOperation::AO_IgnoreError) != 0 &&
+        trans->getNdbError().classification != NdbError::NoDataFound)
+    {
+        ret_code = -1;
+    }
+    reclaimer_ndb->closeTransaction(trans);
+    return ret_code;
+}
+
+static void reclaim_task_main(void *arg)
+{
+    struct reclaim_task *task = static_cast<struct reclaim_task *>(arg);
+    Uint32 ordinal = 0;
+    Uint32 num_retries = 0;
+    while (ordinal < task->num_rows)
+    {
+        Uint32 end_ordinal = std::min(ordinal + RECLAIM_BATCH_ROWS, task->num_rows);
+        if (delete_value_row_batch(task->rondb_key, ordinal, end_ordinal) == 0)
+        {
+            ordinal = end_ordinal;
+            num_retries = 0;
+        }
+        else if (++num_retries > 10)
+        {
+            printf("Failed to delete value rows of rondb_key %llu: %s\n",
+                   (unsigned long long)task->rondb_key,
+                   reclaimer_ndb->getNdbError().message);
+            break;
+        }
+        // A stopping server reclaims the rest as fast as it can
+        if (!stopping.load())
+            usleep(RECLAIM_PAUSE_US);
+    }
+    num_queued--;
+    delete task;
+}
+
+int start_value_reclaimer(Ndb *ndb)
+{
+    reclaimer_ndb = ndb;
+    reclaimer_row = new struct value_table;
+    reclaimer = new pink::BGThread();
+    reclaimer->set_thread_name("ValueReclaimer");
+    if (reclaimer->StartThread() != 0)
+    {
+        printf("Failed to start the value reclaimer\n");
+        delete reclaimer;
+        reclaimer = nullptr;
+        return -1;
+    }
+    return 0;
+}
+
+void stop_value_reclaimer()
+{
+    if (reclaimer == nullptr)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(schedule_mutex);
+        stopping.store(true);
+    }
+    reclaimer->StopThread();
+    // The tasks still queued when the thread stopped
+    reclaimer->SwallowReadyTasks();
+    delete reclaimer;
+    reclaimer = nullptr;
+    delete reclaimer_row;
+    reclaimer_row = nullptr;
+}
+
+bool value_reclaimer_has_room()
+{
+    return reclaimer != nullptr && !stopping.load() &&
+           num_queued.load() < RECLAIM_QUEUE_MAX;
+}
+
+int reclaim_value_rows(Uint64 rondb_key, Uint32 num_rows)
+{
+    std::lock_guard<std::mutex> lock(schedule_mutex);
+    if (reclaimer == nullptr || stopping.load())
+    {
+        printf("Value reclaimer stopped, value rows of rondb_key %llu are left behind\n",
+               (unsigned long long)rondb_key);
+        return -1;
+    }
+    num_queued++;
+    reclaimer->Schedule(reclaim_task_main, new reclaim_task{rondb_key, num_rows});
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#ifndef STRING_VALUE_RECLAIMER_H
+#define STRING_VALUE_RECLAIMER_H
+
+/*
+    Value rows deleted per transaction by the reclaimer, and the pause
+    between two of these transactions.
+*/
+#define RECLAIM_BATCH_ROWS 64
+#define RECLAIM_PAUSE_US 1000
+
+// Values waiting for the reclaimer, beyond this DEL deletes them itself
+#define RECLAIM_QUEUE_MAX 100000
+
+/*
+    Deletes the value rows of deleted keys in the background (see DEL), so
+    that a large value does not take thousands of row deletes in the
+    transaction of the client. A pink::BGThread with an Ndb object of its
+    own deletes them in batches of RECLAIM_BATCH_ROWS, pausing in between
+    so that it does not hold up the commands of the workers.
+
+    The value rows are no longer reachable once their key row is deleted,
+    so deleting them later is not visible to clients. Values still queued
+    when the reclaimer stops are reclaimed before it does; after a crash
+    their value rows are left behind.
+*/
+int start_value_reclaimer(Ndb *ndb);
+
+void stop_value_reclaimer();
+
+/*
+    Returns true if the reclaimer takes more values. Checked before the key
+    rows are deleted, so the queue may go slightly above RECLAIM_QUEUE_MAX.
+*/
+bool value_reclaimer_has_room();
+
+/*
+    Queues the value rows of a value whose key row was deleted and
+    committed. Returns -1 without queueing them once the reclaimer stops.
+*/
+int reclaim_value_rows(Uint64 rondb_key, Uint32 num_rows);
+#endif
@@ -87,6 +87,23 @@ done
 # set_and_get "$KEY:xxl" "$xxl_file"
 # rm "$xxl_file"
 
+# Values up to about 2 MB are read with a single linked query, larger ones in batches
+for NUM_CHARS in 1000000 2500000; do
+    echo "Testing string with $NUM_CHARS characters..."
+    value_file=$(mktemp)
+    head -c $NUM_CHARS < /dev/zero | tr '\0' 'c' > "$value_file"
+    redis-cli -x SET "$KEY:$NUM_CHARS" < "$value_file" > /dev/null
+    expected_hash=$( (cat "$value_file"; echo) | sha256sum | awk '{print $1}')
+    actual_hash=$(redis-cli GET "$KEY:$NUM_CHARS" | sha256sum | awk '{print $1}')
+    rm "$value_file"
+    if [[ "$expected_hash" == "$actual_hash" ]]; then
+        echo "PASS: $KEY:$NUM_CHARS with value length $NUM_CHARS"
+    else
+        echo "FAIL: $KEY:$NUM_CHARS with value length $NUM_CHARS" >&2
+        exit 1
+    fi
+done
+
 echo "Testing non-ASCII string..."
 set_and_get "$KEY:nonascii" "こんにちは世界"  # Japanese for "Hello, World"
 
@@ -113,6 +130,12 @@ echo "Testing edge case large key length (Redis allows up to 512MB for the value
 edge_value=$(head -c 100000 < /dev/zero | tr '\0' 'b')
 set_and_get "$KEY:edge_large" "$edge_value"
 
+# Compressed so that it fits into the key row, then overwritten uncompressed
+echo "Testing compressible JSON value..."
+json_value=$(for i in $(seq 1 1500); do printf '{"id":%d,"name":"user_%d","active":true},' $i $i; done)
+set_and_get "$KEY:json" "$json_value"
+set_and_get "$KEY:json" "not compressed"
+
 incr_key="$KEY:incr${RANDOM}${RANDOM}"
 incr_output=$(redis-cli INCR "$incr_key")
 incr_result=$(redis-cli GET "$incr_key")
@@ -141,6 +164,20 @@ for i in {1..10}; do
     fi
 done
 
+counter_key="$KEY:counter${RANDOM}${RANDOM}"
+redis-cli INCRBY "$counter_key" 100 > /dev/null
+redis-cli DECR "$counter_key" > /dev/null
+decrby_output=$(redis-cli DECRBY "$counter_key" 150)
+counter_result=$(redis-cli GET "$counter_key")
+if [[ "$decrby_output" == -51 && "$counter_result" == -51 ]]; then
+    echo "PASS: Counting key $counter_key down to $counter_result"
+else
+    echo "FAIL: Counting key $counter_key"
+    echo "Expected: -51"
+    echo "Received: $decrby_output, GET $counter_result"
+    exit 1
+fi
+
 # Create multi-value rows in parallel
 run_client() {
     local client="$1"
@@ -0,0 +1,91 @@
+#!/bin/bash
+
+set -e
+
+# Change key suffix using script arguments
+KEY_SUFFIX=${1:-0}
+KEY="multi_key_$KEY_SUFFIX"
+
+function expect() {
+    local description="$1"
+    local expected="$2"
+    local actual="$3"
+
+    if [[ "$expected" == "$actual" ]]; then
+        echo "PASS: $description"
+    else
+        echo "FAIL: $description"
+        echo "Expected: $expected"
+        echo "Received: $actual"
+        exit 1
+    fi
+}
+
+generate_random_chars() {
+  local length=$1
+  local random_string=""
+
+  while [ "${#random_string}" -lt "$length" ]; do
+    random_string+=$(head /dev/urandom | LC_CTYPE=C tr -dc 'a-zA-Z0-9' | head -c "$length")
+  done
+
+  echo "${random_string:0:$length}"
+}
+
+# Test Cases
+
+# Start from a clean state, earlier runs may have left keys behind
+redis-cli DEL "$KEY:a" "$KEY:b" "$KEY:c" "$KEY:large" "$KEY:nx1" "$KEY:nx2" "$KEY:nx4" "$KEY:huge" > /dev/null
+
+echo "Testing MSET and MGET..."
+expect "MSET of 3 keys" "OK" "$(redis-cli MSET "$KEY:a" "value_a" "$KEY:b" "" "$KEY:c" "value_c")"
+expect "MGET of 3 keys and a missing one" \
+    "$(printf 'value_a\n\nvalue_c\n')" \
+    "$(redis-cli MGET "$KEY:a" "$KEY:b" "$KEY:c" "$KEY:missing")"
+
+echo "Testing MGET of a value with value rows..."
+large_value=$(generate_random_chars 70000)
+expect "SET of large value" "OK" "$(redis-cli SET "$KEY:large" "$large_value")"
+mget_output=$(redis-cli MGET "$KEY:a" "$KEY:large" "$KEY:c")
+expect "MGET with large value" \
+    "$(printf 'value_a\n%s\nvalue_c' "$large_value" | sha256sum)" \
+    "$(echo -n "$mget_output" | sha256sum)"
+
+echo "Testing MSET overwriting a value with value rows..."
+expect "MSET over large value" "OK" "$(redis-cli MSET "$KEY:large" "small" "$KEY:a" "new_a")"
+expect "MGET after MSET" "$(printf 'new_a\nsmall')" "$(redis-cli MGET "$KEY:a" "$KEY:large")"
+
+echo "Testing EXISTS..."
+expect "EXISTS counts duplicates" "3" "$(redis-cli EXISTS "$KEY:a" "$KEY:a" "$KEY:c" "$KEY:missing")"
+
+echo "Testing MSETNX..."
+expect "MSETNX of new keys" "1" "$(redis-cli MSETNX "$KEY:nx1" "1" "$KEY:nx2" "$large_value")"
+expect "MSETNX with an existing key" "0" "$(redis-cli MSETNX "$KEY:nx1" "2" "$KEY:nx3" "3")"
+expect "MSETNX did not write" "0" "$(redis-cli EXISTS "$KEY:nx3")"
+expect "MSETNX with a key given twice" "1" \
+    "$(redis-cli MSETNX "$KEY:nx4" "$large_value" "$KEY:nx4" "2")"
+expect "MSETNX kept the last value" "2" "$(redis-cli GET "$KEY:nx4")"
+expect "DEL of the key given twice" "1" "$(redis-cli DEL "$KEY:nx4")"
+
+echo "Testing DEL..."
+expect "SET of large value" "OK" "$(redis-cli SET "$KEY:large" "$large_value")"
+expect "DEL of 5 keys, one missing" "4" \
+    "$(redis-cli DEL "$KEY:a" "$KEY:large" "$KEY:nx2" "$KEY:nx1" "$KEY:missing")"
+expect "EXISTS after DEL" "0" "$(redis-cli EXISTS "$KEY:a" "$KEY:large" "$KEY:nx1" "$KEY:nx2")"
+expect "SET after DEL of large value" "OK" "$(redis-cli SET "$KEY:large" "$large_value")"
+expect "GET after DEL and SET" "$(echo -n "$large_value" | sha256sum)" \
+    "$(redis-cli GET "$KEY:large" | tr -d '\n' | sha256sum)"
+
+echo "Testing UNLINK of a value reclaimed in the background..."
+huge_file=$(mktemp)
+head -c 3000000 < /dev/zero | tr '\0' 'u' > "$huge_file"
+redis-cli -x SET "$KEY:huge" < "$huge_file" > /dev/null
+expect "UNLINK of huge value" "1" "$(redis-cli UNLINK "$KEY:huge" "$KEY:missing")"
+expect "EXISTS after UNLINK" "0" "$(redis-cli EXISTS "$KEY:huge")"
+redis-cli -x SET "$KEY:huge" < "$huge_file" > /dev/null
+expect "GET after UNLINK and SET" "$( (cat "$huge_file"; echo) | sha256sum)" \
+    "$(redis-cli GET "$KEY:huge" | sha256sum)"
+redis-cli DEL "$KEY:huge" > /dev/null
+rm "$huge_file"
+
+echo "All tests completed."
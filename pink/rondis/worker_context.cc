@@ -0,0 +1,115 @@
+#include <stdio.h>
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#include "worker_context.h"
+#include "rondb.h"
+#include "common.h"
+#include "string/interpreted_code.h"
+#include "string/table_definitions.h"
+
+struct worker_context *create_worker_context(int worker_id)
+{
+    Ndb *ndb = ndb_objects[worker_id];
+    NdbDictionary::Dictionary *dict = ndb->getDictionary();
+    if (dict == nullptr)
+    {
+        printf("Failed getting dictionary for worker %d; error: %s\n",
+               worker_id, ndb->getNdbError().message);
+        return nullptr;
+    }
+    const NdbDictionary::Table *key_tab = dict->getTable(KEY_TABLE_NAME);
+    const NdbDictionary::Table *value_tab = dict->getTable(VALUE_TABLE_NAME);
+    const NdbDictionary::Table *hset_key_tab = dict->getTable(HSET_KEY_TABLE_NAME);
+    if (key_tab == nullptr || value_tab == nullptr || hset_key_tab == nullptr)
+    {
+        printf("Failed getting tables for worker %d; error: %s\n",
+               worker_id, dict->getNdbError().message);
+        return nullptr;
+    }
+
+    struct worker_context *ctx = new worker_context();
+    ctx->worker_id = worker_id;
+    ctx->ndb = ndb;
+    ctx->key_tab = key_tab;
+    ctx->value_tab = value_tab;
+    ctx->hset_key_tab = hset_key_tab;
+    ctx->num_prepared = 0;
+    ctx->num_open_streams = 0;
+    ctx->write_key_commit_code = new NdbInterpretedCode(key_tab,
+                                                        &ctx->write_key_commit_buffer[0],
+                                                        WRITE_KEY_CODE_WORDS);
+    ctx->write_key_no_commit_code = new NdbInterpretedCode(key_tab,
+                                                           &ctx->write_key_no_commit_buffer[0],
+                                                           WRITE_KEY_CODE_WORDS);
+    ctx->incr_code = new NdbInterpretedCode(key_tab,
+                                            &ctx->incr_buffer[0],
+                                            INCR_CODE_WORDS);
+
+    pink::RespWriter response;
+    if (write_key_row_commit(&response, *ctx->write_key_commit_code, key_tab) != 0 ||
+        write_key_row_no_commit(&response, *ctx->write_key_no_commit_code, key_tab) != 0 ||
+        initNdbCodeIncr(&response, ctx->incr_code, key_tab, 1) != 0)
+    {
+        printf("Failed creating interpreted programs for worker %d: %s\n",
+               worker_id, response.buffer()->c_str());
+        destroy_worker_context(ctx);
+        return nullptr;
+    }
+    return ctx;
+}
+
+void destroy_worker_context(struct worker_context *ctx)
+{
+    for (const NdbQueryDef *query_def : ctx->linked_value_queries)
+    {
+        if (query_def != nullptr)
+            query_def->destroy();
+    }
+    delete ctx->write_key_commit_code;
+    delete ctx->write_key_no_commit_code;
+    delete ctx->incr_code;
+    delete ctx;
+}
+
+const NdbQueryDef *get_linked_value_query(struct worker_context *ctx,
+                                          Uint32 num_value_rows)
+{
+    if (num_value_rows > MAX_LINKED_VALUE_ROWS)
+        return nullptr;
+    if (ctx->linked_value_queries.size() <= num_value_rows)
+        ctx->linked_value_queries.resize(num_value_rows + 1, nullptr);
+    if (ctx->linked_value_queries[num_value_rows] != nullptr)
+        return ctx->linked_value_queries[num_value_rows];
+
+    NdbQueryBuilder *builder = NdbQueryBuilder::create();
+    if (builder == nullptr)
+        return nullptr;
+    const NdbQueryOperand *key_operands[] = {
+        builder->paramValue(),
+        builder->paramValue(),
+        nullptr};
+    const NdbQueryLookupOperationDef *key_op =
+        builder->readTuple(ctx->key_tab, key_operands);
+    bool failed = (key_op == nullptr);
+    for (Uint32 ordinal = 0; !failed && ordinal < num_value_rows; ordinal++)
+    {
+        // The value rows are looked up with the rondb_key of the key row
+        const NdbQueryOperand *value_operands[] = {
+            builder->linkedValue(key_op, KEY_TABLE_COL_rondb_key),
+            builder->constValue(ordinal),
+            nullptr};
+        failed = (builder->readTuple(ctx->value_tab, value_operands) == nullptr);
+    }
+    const NdbQueryDef *query_def = nullptr;
+    if (!failed)
+        query_def = builder->prepare(ctx->ndb);
+    if (query_def == nullptr)
+    {
+        printf("Failed preparing linked query with %u value rows; error: %s\n",
+               num_value_rows, builder->getNdbError().message);
+    }
+    builder->destroy();
+    ctx->linked_value_queries[num_value_rows] = query_def;
+    return query_def;
+}
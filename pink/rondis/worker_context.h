@@ -0,0 +1,92 @@
+#include <coroutine>
+#include <vector>
+#include <ndbapi/NdbApi.hpp>
+#include <ndbapi/Ndb.hpp>
+
+#include "string/table_definitions.h"
+
+#ifndef RONDIS_WORKER_CONTEXT_H
+#define RONDIS_WORKER_CONTEXT_H
+
+#define WRITE_KEY_CODE_WORDS 64
+#define INCR_CODE_WORDS 128
+
+/*
+    Values with up to this many value rows (about 2 MB) are read with a
+    single linked query, see get_linked_key_row().
+*/
+#define MAX_LINKED_VALUE_ROWS 72
+
+/*
+    Everything a worker thread needs to execute commands. It is set up once
+    when the worker is created, so that executing a command does neither
+    dictionary lookups nor compilation of interpreted programs.
+
+    The NdbRecords are shared by all workers and are hence not part of it
+    (see table_definitions.h).
+
+    A context is only used by the executor thread of its worker (see
+    executor.h), hence no locking is needed. The commands in flight on it
+    must not share buffers across a round trip, see coroutine.h.
+*/
+struct worker_context
+{
+    int worker_id;
+    Ndb *ndb;
+    const NdbDictionary::Table *key_tab;
+    const NdbDictionary::Table *value_tab;
+    const NdbDictionary::Table *hset_key_tab;
+
+    /*
+        Finalised interpreted programs. They are never modified after setup,
+        so all operations of the worker can refer to the same program, even
+        when several of them are in flight (see pipeline.h).
+    */
+    Uint32 write_key_commit_buffer[WRITE_KEY_CODE_WORDS];
+    Uint32 write_key_no_commit_buffer[WRITE_KEY_CODE_WORDS];
+    Uint32 incr_buffer[INCR_CODE_WORDS];
+    NdbInterpretedCode *write_key_commit_code;
+    NdbInterpretedCode *write_key_no_commit_code;
+    NdbInterpretedCode *incr_code;
+
+    /*
+        Linked queries reading a key row together with its value rows,
+        indexed by the number of value rows. Each is built the first time
+        a value with that many value rows is read.
+    */
+    std::vector<const NdbQueryDef *> linked_value_queries;
+
+    /*
+        Used when writing value rows. The value is copied when the
+        operation is defined, so the buffer is free again right after.
+    */
+    char varsize_param[EXTENSION_VALUE_LEN + 500];
+
+    // Transactions prepared by execute_async and not sent yet
+    Uint32 num_prepared;
+    // Tasks whose transaction completed, to be resumed
+    std::vector<std::coroutine_handle<>> ready;
+
+    // Transactions of SET uploads and GET downloads kept open between
+    // batches, see set_upload and get_download
+    Uint32 num_open_streams;
+};
+
+/*
+    Returns nullptr if the tables cannot be found or the interpreted
+    programs cannot be finalised.
+*/
+struct worker_context *create_worker_context(int worker_id);
+
+void destroy_worker_context(struct worker_context *ctx);
+
+/*
+    Returns the linked query that reads a key row by its primary key and
+    the value rows 0 to num_value_rows - 1 of its rondb_key. The parameters
+    of the query are the redis_key_id and the redis_key. Returns nullptr
+    if num_value_rows is above MAX_LINKED_VALUE_ROWS or the query cannot
+    be prepared.
+*/
+const NdbQueryDef *get_linked_value_query(struct worker_context *ctx,
+                                          Uint32 num_value_rows);
+#endif
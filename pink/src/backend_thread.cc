@@ -316,43 +316,38 @@ void BackendThread::NotifyClose(const int fd) {
 
 void BackendThread::ProcessNotifyEvents(const PinkFiredEvent* pfe) {
   if (pfe->mask & PinkEpoll::kRead) {
-    char bb[2048];
-    int32_t nread = read(pink_epoll_->notify_receive_fd(), bb, 2048);
-    if (nread == 0) {
-      return;
-    } else {
-      for (int32_t idx = 0; idx < nread; ++idx) {
-        PinkItem ti = pink_epoll_->notify_queue_pop();
-        int fd = ti.fd();
-        std::string ip_port = ti.ip_port();
-        slash::MutexLock l(&mu_);
-        if (ti.notify_type() == kNotiWrite) {
-          if (conns_.find(fd) == conns_.end()) {
-           //TODO: need clean and notify?
-            continue;
-          } else {
-            // connection exist
-            pink_epoll_->PinkModEvent(fd, 0, PinkEpoll::kRead | PinkEpoll::kWrite);
-          }
-          {
-          auto iter = to_send_.find(fd);
-          if (iter == to_send_.end()) {
-            continue;
-          }
-          // get msg from to_send_
-          std::vector<std::string>& msgs = iter->second;
-          for (auto& msg : msgs) {
-            conns_[fd]->WriteResp(msg);
-          }
-          to_send_.erase(iter);
-          }
-        } else if (ti.notify_type() == kNotiClose) {
-          log_info("received kNotiClose\n");
-          pink_epoll_->PinkDelEvent(fd, 0);
-          CloseFd(fd);
-          conns_.erase(fd);
-          connecting_fds_.erase(fd);
+    PinkItem ti;
+    for (int n = pink_epoll_->ConsumeNotify();
+         n > 0 && pink_epoll_->notify_queue_pop(&ti); n--) {
+      int fd = ti.fd();
+      std::string ip_port = ti.ip_port();
+      slash::MutexLock l(&mu_);
+      if (ti.notify_type() == kNotiWrite) {
+        if (conns_.find(fd) == conns_.end()) {
+         //TODO: need clean and notify?
+          continue;
+        } else {
+          // connection exist
+          pink_epoll_->PinkModEvent(fd, 0, PinkEpoll::kRead | PinkEpoll::kWrite);
+        }
+        {
+        auto iter = to_send_.find(fd);
+        if (iter == to_send_.end()) {
+          continue;
+        }
+        // get msg from to_send_
+        std::vector<std::string>& msgs = iter->second;
+        for (auto& msg : msgs) {
+          conns_[fd]->WriteResp(msg);
+        }
+        to_send_.erase(iter);
         }
+      } else if (ti.notify_type() == kNotiClose) {
+        log_info("received kNotiClose\n");
+        pink_epoll_->PinkDelEvent(fd, 0);
+        CloseFd(fd);
+        conns_.erase(fd);
+        connecting_fds_.erase(fd);
       }
     }
   }
@@ -0,0 +1,4 @@
+#include "pink/include/build_version.h"
+const char* pink_build_git_sha = "pink_build_git_sha:930237f6e32cd962960a6700cf3d791ffbe148b7";
+const char* pink_build_git_date = "pink_build_git_date:2026-10-17";
+const char* pink_build_compile_date = __DATE__;
@@ -20,7 +20,8 @@ DispatchThread::DispatchThread(int port,
       : ServerThread::ServerThread(port, cron_interval, handle),
         last_thread_(0),
         work_num_(work_num),
-        queue_limit_(queue_limit) {
+        queue_limit_(queue_limit),
+        reuse_port_(false) {
   worker_thread_ = new WorkerThread*[work_num_];
   for (int i = 0; i < work_num_; i++) {
     worker_thread_[i] = new WorkerThread(conn_factory, this, queue_limit, cron_interval);
@@ -34,7 +35,8 @@ DispatchThread::DispatchThread(const std::string &ip, int port,
       : ServerThread::ServerThread(ip, port, cron_interval, handle),
         last_thread_(0),
         work_num_(work_num),
-        queue_limit_(queue_limit) {
+        queue_limit_(queue_limit),
+        reuse_port_(false) {
   worker_thread_ = new WorkerThread*[work_num_];
   for (int i = 0; i < work_num_; i++) {
     worker_thread_[i] = new WorkerThread(conn_factory, this, queue_limit, cron_interval);
@@ -48,7 +50,8 @@ DispatchThread::DispatchThread(const std::set<std::string>& ips, int port,
       : ServerThread::ServerThread(ips, port, cron_interval, handle),
         last_thread_(0),
         work_num_(work_num),
-        queue_limit_(queue_limit) {
+        queue_limit_(queue_limit),
+        reuse_port_(false) {
   worker_thread_ = new WorkerThread*[work_num_];
   for (int i = 0; i < work_num_; i++) {
     worker_thread_[i] = new WorkerThread(conn_factory, this, queue_limit, cron_interval);
@@ -63,6 +66,10 @@ DispatchThread::~DispatchThread() {
 }
 
 int DispatchThread::StartThread() {
+  if (reuse_port_ && ips_.find("0.0.0.0") != ips_.end()) {
+    ips_.clear();
+    ips_.insert("0.0.0.0");
+  }
   for (int i = 0; i < work_num_; i++) {
     int ret = handle_->CreateWorkerSpecificData(
         &(worker_thread_[i]->private_data_));
@@ -70,6 +77,13 @@ int DispatchThread::StartThread() {
       return ret;
     }
 
+    if (reuse_port_) {
+      ret = worker_thread_[i]->Listen(ips_, port_);
+      if (ret != kSuccess) {
+        return ret;
+      }
+    }
+
     if (!thread_name().empty()) {
       worker_thread_[i]->set_thread_name("WorkerThread");
     }
@@ -107,6 +121,30 @@ void DispatchThread::set_keepalive_timeout(int timeout) {
   }
 }
 
+void DispatchThread::SetBatchWait(int wait_us) {
+  for (int i = 0; i < work_num_; ++i) {
+    worker_thread_[i]->set_batch_wait_us(wait_us);
+  }
+}
+
+void DispatchThread::SetReusePort(bool reuse_port) {
+  reuse_port_ = reuse_port;
+}
+
+int DispatchThread::InitHandle() {
+  if (reuse_port_) {
+    return kSuccess;
+  }
+  return ServerThread::InitHandle();
+}
+
+void DispatchThread::SetPollBackend(PollBackend backend) {
+  ServerThread::SetPollBackend(backend);
+  for (int i = 0; i < work_num_; ++i) {
+    worker_thread_[i]->set_poll_backend(backend);
+  }
+}
+
 int DispatchThread::conn_num() const {
   int conn_num = 0;
   for (int i = 0; i < work_num_; ++i) {
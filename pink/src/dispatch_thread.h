@@ -68,6 +68,12 @@ class DispatchThread : public ServerThread {
   void HandleNewConn(const int connfd, const std::string& ip_port) override;
 
   void SetQueueLimit(int queue_limit) override;
+
+  void SetPollBackend(PollBackend backend) override;
+
+  void SetBatchWait(int wait_us) override;
+
+  void SetReusePort(bool reuse_port) override;
  private:
   /*
    * Here we used auto poll to find the next work thread,
@@ -80,8 +86,12 @@ class DispatchThread : public ServerThread {
    */
   WorkerThread** worker_thread_;
   int queue_limit_;
+  bool reuse_port_;
   std::map<WorkerThread*, void*> localdata_;
 
+  // The workers listen themselves if reuse_port_ is set
+  int InitHandle() override;
+
   void HandleConnEvent(PinkFiredEvent *pfe) override {
     UNUSED(pfe);
   }
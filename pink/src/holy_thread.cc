@@ -167,7 +167,17 @@ void HolyThread::HandleConnEvent(PinkFiredEvent *pfe) {
         // kReadError kReadClose kFullError kParseError kDealError
         should_close = 1;
       } else if (in_conn->is_reply()) {
-        pink_epoll_->PinkModEvent(pfe->fd, 0, PinkEpoll::kWrite);
+        // Write the reply right away, EPOLLOUT is only armed if the
+        // socket cannot take all of it
+        WriteStatus write_status = in_conn->SendReply();
+        if (write_status == kWriteAll) {
+          in_conn->set_is_reply(false);
+        } else if (write_status == kWriteHalf) {
+          pink_epoll_->PinkModEvent(pfe->fd, 0, PinkEpoll::kWrite);
+          return;
+        } else if (write_status == kWriteError) {
+          should_close = 1;
+        }
       } else {
         return;
       }
@@ -185,7 +195,6 @@ void HolyThread::HandleConnEvent(PinkFiredEvent *pfe) {
     }
   }
   if ((pfe->mask & PinkEpoll::kError) || should_close) {
-    pink_epoll_->PinkDelEvent(pfe->fd, 0);
     CloseFd(in_conn);
     in_conn = nullptr;
 
@@ -251,6 +260,8 @@ void HolyThread::DoCronTask() {
 }
 
 void HolyThread::CloseFd(std::shared_ptr<PinkConn> conn) {
+  // An armed io_uring poll would keep the socket open after close()
+  pink_epoll_->PinkDelEvent(conn->fd(), 0);
   close(conn->fd());
   handle_->FdClosedHandle(conn->fd(), conn->ip_port());
 }
@@ -293,30 +304,24 @@ bool HolyThread::KillConn(const std::string& ip_port) {
 
 void HolyThread::ProcessNotifyEvents(const pink::PinkFiredEvent* pfe) {
   if (pfe->mask & PinkEpoll::kRead) {
-    char bb[2048];
-    int32_t nread = read(pink_epoll_->notify_receive_fd(), bb, 2048);
-    //  log_info("notify_received bytes %d\n", nread);
-    if (nread == 0) {
-      return;
-    } else {
-      for (int32_t idx = 0; idx < nread; ++idx) {
-        pink::PinkItem ti = pink_epoll_->notify_queue_pop();
-        std::string ip_port = ti.ip_port();
-        int fd = ti.fd();
-        if (ti.notify_type() == pink::kNotiWrite) {
-          pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kRead | PinkEpoll::kWrite);
-        } else if (ti.notify_type() == pink::kNotiClose) {
-          log_info("receive noti close\n");
-          std::shared_ptr<pink::PinkConn> conn = get_conn(fd);
-          if (conn == nullptr) {
-            continue;
-          }
-          CloseFd(conn);
-          conn = nullptr;
-          {
-            slash::WriteLock l(&rwlock_);
-            conns_.erase(fd);
-          }
+    pink::PinkItem ti;
+    for (int n = pink_epoll_->ConsumeNotify();
+         n > 0 && pink_epoll_->notify_queue_pop(&ti); n--) {
+      std::string ip_port = ti.ip_port();
+      int fd = ti.fd();
+      if (ti.notify_type() == pink::kNotiWrite) {
+        pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kRead | PinkEpoll::kWrite);
+      } else if (ti.notify_type() == pink::kNotiClose) {
+        log_info("receive noti close\n");
+        std::shared_ptr<pink::PinkConn> conn = get_conn(fd);
+        if (conn == nullptr) {
+          continue;
+        }
+        CloseFd(conn);
+        conn = nullptr;
+        {
+          slash::WriteLock l(&rwlock_);
+          conns_.erase(fd);
         }
       }
     }
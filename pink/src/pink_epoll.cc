@@ -8,19 +8,34 @@
 #ifdef __APPLE__
 #else
 #include <linux/version.h>
+#include <sys/eventfd.h>
 #endif
 #include <fcntl.h>
 
 #include "pink/include/pink_define.h"
+#include "pink/src/pink_io_uring.h"
 #include "slash/include/xdebug.h"
 
 namespace pink {
 
 static const int kPinkMaxClients = 10240;
+static const unsigned kIoUringEntries = 1024;
 
-PinkEpoll::PinkEpoll(int queue_limit) : queue_limit_(queue_limit) {
+PinkEpoll::PinkEpoll(int queue_limit, PollBackend backend)
+    : epfd_(-1), io_uring_(nullptr), queue_limit_(queue_limit),
+      notify_overflow_(0), notify_queue_size_(0), notify_pending_(false) {
+#ifdef PINK_HAVE_IO_URING
+  if (backend == kPollIoUring) {
+    io_uring_ = PinkIoUring::Create(kIoUringEntries);
+    if (io_uring_ == nullptr) {
+      log_warn("io_uring unavailable, using epoll");
+    }
+  }
+#endif
+
+  if (io_uring_ == nullptr) {
 #ifdef __APPLE__
-  epfd_ = ::kqueue();
+    epfd_ = ::kqueue();
 #else
 #if defined(EPOLL_CLOEXEC)
     epfd_ = epoll_create1(EPOLL_CLOEXEC);
@@ -28,21 +43,23 @@ PinkEpoll::PinkEpoll(int queue_limit) : queue_limit_(queue_limit) {
     epfd_ = epoll_create(1024);
 #endif
 #endif
-  fcntl(epfd_, F_SETFD, fcntl(epfd_, F_GETFD) | FD_CLOEXEC);
+    fcntl(epfd_, F_SETFD, fcntl(epfd_, F_GETFD) | FD_CLOEXEC);
 
-  if (epfd_ < 0) {
+    if (epfd_ < 0) {
 #ifdef __APPLE__
-    log_err("kqueue create fail");
+      log_err("kqueue create fail");
 #else
-    log_err("epoll create fail");
+      log_err("epoll create fail");
 #endif
-    exit(1);
+      exit(1);
+    }
+    events_.resize(kPinkMaxClients);
   }
-  events_.resize(kPinkMaxClients);
 
   firedevent_ = reinterpret_cast<PinkFiredEvent*>(malloc(
       sizeof(PinkFiredEvent) * kPinkMaxClients));
 
+#ifdef __APPLE__
   int fds[2];
   if (pipe(fds)) {
     exit(-1);
@@ -52,16 +69,38 @@ PinkEpoll::PinkEpoll(int queue_limit) : queue_limit_(queue_limit) {
 
   fcntl(notify_receive_fd_, F_SETFD, fcntl(notify_receive_fd_, F_GETFD) | FD_CLOEXEC);
   fcntl(notify_send_fd_, F_SETFD, fcntl(notify_send_fd_, F_GETFD) | FD_CLOEXEC);
+  fcntl(notify_receive_fd_, F_SETFL, fcntl(notify_receive_fd_, F_GETFL) | O_NONBLOCK);
+#else
+  notify_receive_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (notify_receive_fd_ < 0) {
+    exit(-1);
+  }
+  notify_send_fd_ = notify_receive_fd_;
+#endif
 
   PinkAddEvent(notify_receive_fd_, kRead);
 }
 
 PinkEpoll::~PinkEpoll() {
   free(firedevent_);
-  close(epfd_);
+#ifdef PINK_HAVE_IO_URING
+  delete io_uring_;
+#endif
+  if (epfd_ >= 0) {
+    close(epfd_);
+  }
+  if (notify_send_fd_ != notify_receive_fd_) {
+    close(notify_send_fd_);
+  }
+  close(notify_receive_fd_);
 }
 
 int PinkEpoll::PinkAddEvent(const int fd, const int mask) {
+#ifdef PINK_HAVE_IO_URING
+  if (io_uring_ != nullptr) {
+    return io_uring_->AddEvent(fd, mask);
+  }
+#endif
 #ifdef __APPLE__
   int cnt = 0;
   struct kevent change[2];
@@ -89,6 +128,11 @@ int PinkEpoll::PinkAddEvent(const int fd, const int mask) {
 }
 
 int PinkEpoll::PinkModEvent(const int fd, const int old_mask, const int mask) {
+#ifdef PINK_HAVE_IO_URING
+  if (io_uring_ != nullptr) {
+    return io_uring_->ModEvent(fd, old_mask | mask);
+  }
+#endif
 #ifdef __APPLE__
   int ret = PinkDelEvent(fd, kRead | kWrite);
   if (mask == 0) {
@@ -110,6 +154,11 @@ int PinkEpoll::PinkModEvent(const int fd, const int old_mask, const int mask) {
 }
 
 int PinkEpoll::PinkDelEvent(const int fd, [[maybe_unused]] int mask) {
+#ifdef PINK_HAVE_IO_URING
+  if (io_uring_ != nullptr) {
+    return io_uring_->DelEvent(fd);
+  }
+#endif
 #ifdef __APPLE__
   int cnt = 0;
   struct kevent change[2];
@@ -137,33 +186,70 @@ int PinkEpoll::PinkDelEvent(const int fd, [[maybe_unused]] int mask) {
 }
 
 bool PinkEpoll::Register(const PinkItem& it, bool force) {
-  bool success = false;
-  notify_queue_protector_.Lock();
-  if (force ||
-      queue_limit_ == kUnlimitedQueue ||
-      notify_queue_.size() < static_cast<size_t>(queue_limit_)) {
+  if (!force &&
+      queue_limit_ != kUnlimitedQueue &&
+      notify_queue_size_.load(std::memory_order_relaxed) >= queue_limit_) {
+    return false;
+  }
+  if (notify_overflow_.load(std::memory_order_acquire) > 0 ||
+      !notify_ring_.TryPush(it)) {
+    slash::MutexLock l(&notify_queue_protector_);
     notify_queue_.push(it);
-    success = true;
+    notify_overflow_.fetch_add(1);
   }
-  notify_queue_protector_.Unlock();
-  if (success) {
-    int ret_code = write(notify_send_fd_, "", 1);
-    if (ret_code < 0) success = false;
+  notify_queue_size_.fetch_add(1);
+
+  // Only the first item since the last ConsumeNotify() wakes the loop
+  if (notify_pending_.exchange(true)) {
+    return true;
   }
-  return success;
+#ifdef __APPLE__
+  int ret_code = write(notify_send_fd_, "", 1);
+#else
+  uint64_t one = 1;
+  int ret_code = write(notify_send_fd_, &one, sizeof(one));
+#endif
+  return ret_code >= 0;
 }
 
-PinkItem PinkEpoll::notify_queue_pop() {
-  PinkItem it;
-  notify_queue_protector_.Lock();
-  it = notify_queue_.front();
-  notify_queue_.pop();
-  notify_queue_protector_.Unlock();
-  return it;
+int PinkEpoll::ConsumeNotify() {
+#ifdef __APPLE__
+  char bb[2048];
+  while (read(notify_receive_fd_, bb, sizeof(bb)) > 0) {
+  }
+#else
+  uint64_t count;
+  int ret_code = read(notify_receive_fd_, &count, sizeof(count));
+  (void)ret_code;
+#endif
+  notify_pending_.exchange(false);
+  return notify_queue_size_.load();
+}
+
+bool PinkEpoll::notify_queue_pop(PinkItem* it) {
+  if (!notify_ring_.TryPop(it)) {
+    if (notify_overflow_.load(std::memory_order_acquire) == 0) {
+      return false;
+    }
+    slash::MutexLock l(&notify_queue_protector_);
+    if (notify_queue_.empty()) {
+      return false;
+    }
+    *it = std::move(notify_queue_.front());
+    notify_queue_.pop();
+    notify_overflow_.fetch_sub(1);
+  }
+  notify_queue_size_.fetch_sub(1);
+  return true;
 }
 
 int PinkEpoll::PinkPoll(const int timeout) {
   int num_events = 0;
+#ifdef PINK_HAVE_IO_URING
+  if (io_uring_ != nullptr) {
+    return io_uring_->Poll(firedevent_, PINK_MAX_CLIENTS, timeout);
+  }
+#endif
 #ifdef __APPLE__
   struct timespec* p_timeout = nullptr;
   struct timespec s_timeout;
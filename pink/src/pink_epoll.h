@@ -5,6 +5,7 @@
 
 #ifndef PINK_SRC_PINK_EPOLL_H_
 #define PINK_SRC_PINK_EPOLL_H_
+#include <atomic>
 #include <queue>
 #include <vector>
 #ifdef __APPLE__
@@ -15,11 +16,15 @@
 #include "sys/epoll.h"
 #endif
 
+#include "pink/include/pink_define.h"
 #include "pink/src/pink_item.h"
+#include "pink/src/pink_mpsc_queue.h"
 #include "slash/include/slash_mutex.h"
 
 namespace pink {
 
+class PinkIoUring;
+
 struct PinkFiredEvent {
   int fd;
   int mask;
@@ -32,7 +37,12 @@ class PinkEpoll {
   static const int kWrite = 2;
   static const int kError = 4;
 
-  PinkEpoll(int queue_limit = kUnlimitedQueue);
+  /*
+   * Falls back to epoll if kPollIoUring is asked for but the kernel
+   * does not support it
+   */
+  PinkEpoll(int queue_limit = kUnlimitedQueue,
+            PollBackend backend = kPollEpoll);
   ~PinkEpoll();
   int PinkAddEvent(const int fd, const int mask);
   int PinkDelEvent(const int fd, int mask);
@@ -42,16 +52,26 @@ class PinkEpoll {
 
   PinkFiredEvent *firedevent() const { return firedevent_; }
 
+  PollBackend backend() const {
+    return io_uring_ != nullptr ? kPollIoUring : kPollEpoll;
+  }
+
   int notify_receive_fd() {
     return notify_receive_fd_;
   }
   int notify_send_fd() {
     return notify_send_fd_;
   }
-  PinkItem notify_queue_pop();
+  /*
+   * Clears the wakeup of notify_receive_fd() and returns how many items
+   * to pop now. Items registered from here on wake the loop again.
+   */
+  int ConsumeNotify();
+  // Returns false if there is no item
+  bool notify_queue_pop(PinkItem* it);
 
   bool Register(const PinkItem& it, bool force);
-  bool Deregister(const PinkItem& it) { return false; }
+  bool Deregister(const PinkItem& /*it*/) { return false; }
 
  private:
   int epfd_;
@@ -61,16 +81,28 @@ class PinkEpoll {
   std::vector<struct epoll_event> events_;
 #endif
   PinkFiredEvent *firedevent_;
+  // Used instead of epfd_ if not nullptr
+  PinkIoUring *io_uring_;
 
   /*
    * The PbItem queue is the fd queue, receive from dispatch thread
    */
   int queue_limit_;
+  MpscQueue<PinkItem, 1024> notify_ring_;
+  /*
+   * Items that did not fit into notify_ring_. Once there are some, later
+   * items queue up behind them
+   */
   slash::Mutex notify_queue_protector_;
   std::queue<PinkItem> notify_queue_;
+  std::atomic<int> notify_overflow_;
+  std::atomic<int> notify_queue_size_;
+  // Set while a wakeup is written but not consumed yet
+  std::atomic<bool> notify_pending_;
 
   /*
-   * These two fd receive the notify from dispatch thread
+   * These two fd receive the notify from dispatch thread. Both are the
+   * same eventfd on linux
    */
   int notify_receive_fd_;
   int notify_send_fd_;
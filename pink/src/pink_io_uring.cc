@@ -0,0 +1,378 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pink/src/pink_io_uring.h"
+
+#ifdef PINK_HAVE_IO_URING
+
+#include <endian.h>
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <algorithm>
+
+#include "slash/include/xdebug.h"
+#include "pink/src/pink_epoll.h"
+
+namespace pink {
+
+// Marks the completions of POLL_REMOVE requests
+static const uint64_t kRemoveTag = ~0ULL;
+
+// Longest wait in Poll() while fds that fired could not be armed again
+static const int kRearmRetryMs = 1;
+
+static uint64_t PollTag(int fd, uint32_t gen) {
+  return (static_cast<uint64_t>(fd) << 32) | gen;
+}
+
+PinkIoUring* PinkIoUring::Create(unsigned entries) {
+  PinkIoUring* io_uring = new PinkIoUring();
+  if (io_uring->Init(entries) != 0) {
+    delete io_uring;
+    return nullptr;
+  }
+  return io_uring;
+}
+
+PinkIoUring::PinkIoUring()
+    : ring_fd_(-1),
+      skip_cqe_(false),
+      sq_ring_(MAP_FAILED),
+      sq_ring_len_(0),
+      cq_ring_(MAP_FAILED),
+      cq_ring_len_(0),
+      sqes_(static_cast<io_uring_sqe*>(MAP_FAILED)),
+      sqes_len_(0),
+      sq_tail_local_(0) {
+}
+
+PinkIoUring::~PinkIoUring() {
+  if (sqes_ != MAP_FAILED) {
+    munmap(sqes_, sqes_len_);
+  }
+  if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_len_);
+  }
+  if (sq_ring_ != MAP_FAILED) {
+    munmap(sq_ring_, sq_ring_len_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+int PinkIoUring::Init(unsigned entries) {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  params.flags = IORING_SETUP_CLAMP;
+  ring_fd_ = syscall(__NR_io_uring_setup, entries, &params);
+  if (ring_fd_ < 0) {
+    return -1;
+  }
+  // The wait needs a timeout and completions must never be dropped
+  if (!(params.features & IORING_FEAT_EXT_ARG) ||
+      !(params.features & IORING_FEAT_NODROP)) {
+    return -1;
+  }
+  skip_cqe_ = params.features & IORING_FEAT_CQE_SKIP;
+
+  sq_ring_len_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_len_ = params.cq_off.cqes +
+                 params.cq_entries * sizeof(struct io_uring_cqe);
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    sq_ring_len_ = std::max(sq_ring_len_, cq_ring_len_);
+    cq_ring_len_ = sq_ring_len_;
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_len_, PROT_READ | PROT_WRITE,
+                  MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    return -1;
+  }
+  if (params.features & IORING_FEAT_SINGLE_MMAP) {
+    cq_ring_ = sq_ring_;
+  } else {
+    cq_ring_ = mmap(nullptr, cq_ring_len_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+    if (cq_ring_ == MAP_FAILED) {
+      return -1;
+    }
+  }
+  sqes_len_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(nullptr, sqes_len_, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    return -1;
+  }
+  sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+  char* sq = static_cast<char*>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+  sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  sq_tail_local_ = *sq_tail_;
+
+  char* cq = static_cast<char*>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  return 0;
+}
+
+int PinkIoUring::Enter(unsigned to_submit, unsigned min_complete,
+                       unsigned flags, int timeout) {
+  if (!(flags & IORING_ENTER_GETEVENTS)) {
+    return syscall(__NR_io_uring_enter, ring_fd_, to_submit, 0, flags,
+                   nullptr, 0);
+  }
+  struct io_uring_getevents_arg arg;
+  struct __kernel_timespec ts;
+  memset(&arg, 0, sizeof(arg));
+  if (timeout >= 0) {
+    ts.tv_sec = timeout / 1000;
+    ts.tv_nsec = static_cast<long long>(timeout % 1000) * 1000000;
+    arg.ts = reinterpret_cast<uint64_t>(&ts);
+  }
+  return syscall(__NR_io_uring_enter, ring_fd_, to_submit, min_complete,
+                 flags | IORING_ENTER_EXT_ARG, &arg, sizeof(arg));
+}
+
+// Publishes the queued requests to the kernel, returns how many there are
+unsigned PinkIoUring::PublishSqes() {
+  __atomic_store_n(sq_tail_, sq_tail_local_, __ATOMIC_RELEASE);
+  return sq_tail_local_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE);
+}
+
+io_uring_sqe* PinkIoUring::GetSqe() {
+  if (sq_tail_local_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) ==
+      sq_entries_) {
+    // Full, hand what is queued to the kernel
+    Enter(PublishSqes(), 0, 0, 0);
+    if (sq_tail_local_ - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) ==
+        sq_entries_) {
+      return nullptr;
+    }
+  }
+  unsigned index = sq_tail_local_ & sq_mask_;
+  io_uring_sqe* sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sq_array_[index] = index;
+  sq_tail_local_++;
+  return sqe;
+}
+
+PinkIoUring::FdState* PinkIoUring::State(int fd) {
+  if (static_cast<size_t>(fd) >= fds_.size()) {
+    fds_.resize(fd + 1, FdState{0, 0, false, false});
+  }
+  return &fds_[fd];
+}
+
+int PinkIoUring::QueueArm(int fd, FdState* state) {
+  io_uring_sqe* sqe = GetSqe();
+  if (sqe == nullptr) {
+    return -1;
+  }
+  uint32_t events = 0;
+  if (state->mask & PinkEpoll::kRead) {
+    events |= POLLIN;
+  }
+  if (state->mask & PinkEpoll::kWrite) {
+    events |= POLLOUT;
+  }
+#if __BYTE_ORDER == __BIG_ENDIAN
+  events = (events << 16) | (events >> 16);
+#endif
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll32_events = events;
+  sqe->user_data = PollTag(fd, ++state->gen);
+  state->armed = true;
+  return 0;
+}
+
+int PinkIoUring::QueueRemove(int fd, FdState* state) {
+  io_uring_sqe* sqe = GetSqe();
+  if (sqe == nullptr) {
+    return -1;
+  }
+  sqe->opcode = IORING_OP_POLL_REMOVE;
+  sqe->fd = -1;
+  sqe->addr = PollTag(fd, state->gen);
+  sqe->user_data = kRemoveTag;
+  if (skip_cqe_) {
+    sqe->flags = IOSQE_CQE_SKIP_SUCCESS;
+  }
+  // A completion of the removed request is stale from now on
+  state->gen++;
+  state->armed = false;
+  return 0;
+}
+
+/*
+ * Called with mu_ held. The polling thread submits together with its next
+ * wait, which might be far away for everybody else.
+ */
+int PinkIoUring::UnlockAndSubmit(int ret) {
+  unsigned to_submit = PublishSqes();
+  bool foreign = std::this_thread::get_id() != poll_thread_;
+  mu_.Unlock();
+  if (foreign && to_submit > 0) {
+    Enter(to_submit, 0, 0, 0);
+  }
+  return ret;
+}
+
+int PinkIoUring::AddEvent(int fd, int mask) {
+  if (fd < 0) {
+    errno = EBADF;
+    return -1;
+  }
+  mu_.Lock();
+  FdState* state = State(fd);
+  if (state->armed && QueueRemove(fd, state) != 0) {
+    return UnlockAndSubmit(-1);
+  }
+  state->registered = true;
+  state->mask = mask;
+  if (mask != 0 && QueueArm(fd, state) != 0) {
+    return UnlockAndSubmit(-1);
+  }
+  return UnlockAndSubmit(0);
+}
+
+int PinkIoUring::ModEvent(int fd, int mask) {
+  if (fd < 0) {
+    errno = EBADF;
+    return -1;
+  }
+  mu_.Lock();
+  FdState* state = State(fd);
+  if (!state->registered) {
+    errno = ENOENT;
+    return UnlockAndSubmit(-1);
+  }
+  if (state->armed && state->mask == mask) {
+    // The request in flight already waits for the same
+    return UnlockAndSubmit(0);
+  }
+  if (state->armed && QueueRemove(fd, state) != 0) {
+    return UnlockAndSubmit(-1);
+  }
+  state->mask = mask;
+  if (mask != 0 && QueueArm(fd, state) != 0) {
+    return UnlockAndSubmit(-1);
+  }
+  return UnlockAndSubmit(0);
+}
+
+int PinkIoUring::DelEvent(int fd) {
+  if (fd < 0) {
+    errno = EBADF;
+    return -1;
+  }
+  mu_.Lock();
+  FdState* state = State(fd);
+  if (!state->registered) {
+    errno = ENOENT;
+    return UnlockAndSubmit(-1);
+  }
+  if (state->armed && QueueRemove(fd, state) != 0) {
+    return UnlockAndSubmit(-1);
+  }
+  state->registered = false;
+  state->mask = 0;
+  return UnlockAndSubmit(0);
+}
+
+int PinkIoUring::Poll(PinkFiredEvent* fired, int max_events, int timeout) {
+  mu_.Lock();
+  poll_thread_ = std::this_thread::get_id();
+  // Level triggered: a fd that is still ready completes again right away
+  size_t num_unarmed = 0;
+  for (size_t i = 0; i < fired_fds_.size(); i++) {
+    int fd = fired_fds_[i];
+    FdState* state = State(fd);
+    if (state->registered && !state->armed && state->mask != 0 &&
+        QueueArm(fd, state) != 0) {
+      // Kept for the next round, it would not be polled otherwise
+      fired_fds_[num_unarmed++] = fd;
+    }
+  }
+  fired_fds_.resize(num_unarmed);
+  if (num_unarmed > 0) {
+    log_warn("io_uring submission queue full, %zu fds not armed again",
+             num_unarmed);
+    // Do not wait long for the others before trying again
+    if (timeout < 0 || timeout > kRearmRetryMs) {
+      timeout = kRearmRetryMs;
+    }
+  }
+  unsigned to_submit = PublishSqes();
+  mu_.Unlock();
+
+  if (Enter(to_submit, timeout != 0 ? 1 : 0, IORING_ENTER_GETEVENTS,
+            timeout) < 0 && errno != ETIME && errno != EINTR) {
+    return 0;
+  }
+
+  int num_events = 0;
+  mu_.Lock();
+  unsigned head = *cq_head_;
+  unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+  for (; head != tail && num_events < max_events; head++) {
+    const io_uring_cqe* cqe = &cqes_[head & cq_mask_];
+    if (cqe->user_data == kRemoveTag) {
+      continue;
+    }
+    int fd = static_cast<int>(cqe->user_data >> 32);
+    uint32_t gen = static_cast<uint32_t>(cqe->user_data);
+    if (static_cast<size_t>(fd) >= fds_.size()) {
+      continue;
+    }
+    FdState* state = &fds_[fd];
+    if (!state->registered || !state->armed || state->gen != gen) {
+      continue;
+    }
+    state->armed = false;
+    fired_fds_.push_back(fd);
+    if (cqe->res == -ECANCELED) {
+      continue;
+    }
+
+    int mask = 0;
+    if (cqe->res < 0) {
+      mask |= PinkEpoll::kError;
+    } else {
+      if (cqe->res & POLLIN) {
+        mask |= PinkEpoll::kRead;
+      }
+      if (cqe->res & POLLOUT) {
+        mask |= PinkEpoll::kWrite;
+      }
+      if (cqe->res & (POLLERR | POLLHUP)) {
+        mask |= PinkEpoll::kError;
+      }
+    }
+    fired[num_events].fd = fd;
+    fired[num_events].mask = mask;
+    num_events++;
+  }
+  __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+  mu_.Unlock();
+  return num_events;
+}
+
+}  // namespace pink
+
+#endif  // PINK_HAVE_IO_URING
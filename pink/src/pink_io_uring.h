@@ -0,0 +1,111 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef PINK_SRC_PINK_IO_URING_H_
+#define PINK_SRC_PINK_IO_URING_H_
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define PINK_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifdef PINK_HAVE_IO_URING
+
+#include <stdint.h>
+
+#include <thread>
+#include <vector>
+
+#include "slash/include/slash_mutex.h"
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+
+namespace pink {
+
+struct PinkFiredEvent;
+
+/*
+ * Readiness polling on top of io_uring, used by PinkEpoll.
+ *
+ * Every registered fd has one level triggered poll request in flight.
+ * Interest changes and the re-arming of fired fds are only queued, they
+ * are submitted together with the next wait, so a round of the event
+ * loop costs one io_uring_enter instead of an epoll_wait plus one
+ * epoll_ctl per changed fd. Changes made by other threads than the
+ * polling one are submitted right away.
+ */
+class PinkIoUring {
+ public:
+  // Returns nullptr if the kernel does not support what is needed
+  static PinkIoUring* Create(unsigned entries);
+  ~PinkIoUring();
+
+  int AddEvent(int fd, int mask);
+  int ModEvent(int fd, int mask);
+  int DelEvent(int fd);
+
+  int Poll(PinkFiredEvent* fired, int max_events, int timeout);
+
+ private:
+  struct FdState {
+    int mask;
+    uint32_t gen;
+    bool registered;
+    bool armed;
+  };
+
+  PinkIoUring();
+  int Init(unsigned entries);
+
+  FdState* State(int fd);
+  io_uring_sqe* GetSqe();
+  int QueueArm(int fd, FdState* state);
+  int QueueRemove(int fd, FdState* state);
+  unsigned PublishSqes();
+  int UnlockAndSubmit(int ret);
+  int Enter(unsigned to_submit, unsigned min_complete, unsigned flags,
+            int timeout);
+
+  int ring_fd_;
+  bool skip_cqe_;
+
+  void* sq_ring_;
+  size_t sq_ring_len_;
+  void* cq_ring_;
+  size_t cq_ring_len_;
+  io_uring_sqe* sqes_;
+  size_t sqes_len_;
+
+  unsigned* sq_head_;
+  unsigned* sq_tail_;
+  unsigned* sq_array_;
+  unsigned sq_mask_;
+  unsigned sq_entries_;
+  // Tail of the requests queued so far, see PublishSqes()
+  unsigned sq_tail_local_;
+  unsigned* cq_head_;
+  unsigned* cq_tail_;
+  io_uring_cqe* cqes_;
+  unsigned cq_mask_;
+
+  // Guards the submission queue and fds_
+  slash::Mutex mu_;
+  std::vector<FdState> fds_;
+  // Fds that fired in the last round, armed again before the next wait
+  // and kept if the submission queue is full
+  std::vector<int> fired_fds_;
+  std::thread::id poll_thread_;
+
+  // No copying allowed
+  PinkIoUring(const PinkIoUring&);
+  void operator=(const PinkIoUring&);
+};
+
+}  // namespace pink
+
+#endif  // PINK_HAVE_IO_URING
+#endif  // PINK_SRC_PINK_IO_URING_H_
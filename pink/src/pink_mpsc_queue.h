@@ -0,0 +1,93 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef PINK_SRC_PINK_MPSC_QUEUE_H_
+#define PINK_SRC_PINK_MPSC_QUEUE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <utility>
+
+namespace pink {
+
+/*
+ * A bounded lock free queue for many producers and one consumer.
+ *
+ * Every cell carries a sequence number telling whether it is free for
+ * the producer of a given round or holds an item for the consumer. A
+ * producer claims a cell by advancing tail_, so producers only contend
+ * on that counter. Capacity must be a power of two.
+ */
+template <typename T, size_t Capacity>
+class MpscQueue {
+ public:
+  MpscQueue() : tail_(0), head_(0) {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity must be a power of two");
+    for (size_t i = 0; i < Capacity; i++) {
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  // Returns false if the queue is full
+  bool TryPush(const T& value) {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    Cell* cell;
+    for (;;) {
+      cell = &cells_[pos & (Capacity - 1)];
+      size_t seq = cell->seq.load(std::memory_order_acquire);
+      intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+      if (diff == 0) {
+        if (tail_.compare_exchange_weak(pos, pos + 1,
+                                        std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        return false;
+      } else {
+        pos = tail_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value = value;
+    cell->seq.store(pos + 1, std::memory_order_release);
+    return true;
+  }
+
+  /*
+   * Only from the consumer. Returns false if the queue is empty, or if the
+   * oldest item is still being written by its producer.
+   */
+  bool TryPop(T* value) {
+    Cell* cell = &cells_[head_ & (Capacity - 1)];
+    size_t seq = cell->seq.load(std::memory_order_acquire);
+    if (seq != head_ + 1) {
+      return false;
+    }
+    *value = std::move(cell->value);
+    cell->seq.store(head_ + Capacity, std::memory_order_release);
+    head_++;
+    return true;
+  }
+
+ private:
+  struct Cell {
+    std::atomic<size_t> seq;
+    T value;
+  };
+
+  Cell cells_[Capacity];
+  // Producers and the consumer on separate cache lines
+  alignas(64) std::atomic<size_t> tail_;
+  alignas(64) size_t head_;
+
+  // No copying allowed
+  MpscQueue(const MpscQueue&);
+  void operator=(const MpscQueue&);
+};
+
+}  // namespace pink
+
+#endif  // PINK_SRC_PINK_MPSC_QUEUE_H_
@@ -385,10 +385,9 @@ void *PubSubThread::ThreadMain() {
       pfe = (pink_epoll_->firedevent()) + i;
       if (pfe->fd == pink_epoll_->notify_receive_fd()) {        // New connection comming
         if (pfe->mask & PinkEpoll::kRead) {
-          int ret_code = read(pink_epoll_->notify_receive_fd(), triger, 1);
-          (void)ret_code;
-          {
-            PinkItem ti = pink_epoll_->notify_queue_pop();
+          PinkItem ti;
+          for (int n = pink_epoll_->ConsumeNotify();
+               n > 0 && pink_epoll_->notify_queue_pop(&ti); n--) {
             if (ti.notify_type() == kNotiClose) {
             } else if (ti.notify_type() == kNotiEpollout) {
               pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kWrite);
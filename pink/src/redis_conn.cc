@@ -6,6 +6,7 @@
 #include "pink/include/redis_conn.h"
 
 #include <stdlib.h>
+#include <string.h>
 #include <limits.h>
 
 #include <string>
@@ -24,17 +25,23 @@ RedisConn::RedisConn(const int fd,
                      const int rbuf_max_len)
     : PinkConn(fd, ip_port, thread, pink_epoll),
       handle_type_(handle_type),
+      parse_in_place_(false),
       rbuf_(nullptr),
       rbuf_len_(0),
       rbuf_max_len_(rbuf_max_len),
       msg_peak_(0),
       command_len_(0),
-      wbuf_pos_(0),
+      consumed_len_(0),
       last_read_pos_(-1),
-      bulk_len_(-1) {
+      bulk_len_(-1),
+      bulk_end_(-1) {
   RedisParserSettings settings;
   settings.DealMessage = ParserDealMessageCb;
   settings.Complete = ParserCompleteCb;
+  settings.DealMessageView = ParserDealMessageViewCb;
+  settings.CompleteView = ParserCompleteViewCb;
+  settings.StartBulkStream = ParserStartBulkStreamCb;
+  settings.DealBulkChunk = ParserDealBulkChunkCb;
   redis_parser_.RedisParserInit(REDIS_PARSER_REQUEST, settings);
   redis_parser_.data = this;
 }
@@ -73,14 +80,25 @@ ReadStatus RedisConn::ParseRedisParserStatus(RedisParserStatus status) {
 
 ReadStatus RedisConn::GetRequest() {
   ssize_t nread = 0;
+  if (consumed_len_ > 0) {
+    // The commands passed on by the last read are done with their arguments
+    int rest = last_read_pos_ + 1 - consumed_len_;
+    memmove(rbuf_, rbuf_ + consumed_len_, rest);
+    last_read_pos_ = rest - 1;
+    consumed_len_ = 0;
+  }
   int next_read_pos = last_read_pos_ + 1;
 
   int remain = rbuf_len_ - next_read_pos;  // Remain buffer size
   int new_size = 0;
-  if (remain == 0) {
+  if (parse_in_place_ && bulk_end_ > rbuf_len_) {
+    // The bulk string being parsed is kept in the buffer as a whole
+    new_size = bulk_end_;
+    remain = new_size - next_read_pos;
+  } else if (remain == 0) {
     new_size = rbuf_len_ + REDIS_IOBUF_LEN;
     remain += REDIS_IOBUF_LEN;
-  } else if (remain < bulk_len_) {
+  } else if (!parse_in_place_ && remain < bulk_len_) {
     new_size = next_read_pos + bulk_len_;
     remain = bulk_len_;
   }
@@ -118,61 +136,60 @@ ReadStatus RedisConn::GetRequest() {
   }
 
   int processed_len = 0;
-  RedisParserStatus ret = redis_parser_.ProcessInputBuffer(
-      rbuf_ + next_read_pos, nread, &processed_len);
+  RedisParserStatus ret;
+  if (parse_in_place_) {
+    // An incomplete command stays in the buffer until the rest is read
+    ret = redis_parser_.ProcessInputBufferInPlace(
+        rbuf_, last_read_pos_ + 1, &processed_len);
+  } else {
+    ret = redis_parser_.ProcessInputBuffer(
+        rbuf_ + next_read_pos, nread, &processed_len);
+  }
   ReadStatus read_status = ParseRedisParserStatus(ret);
   if (read_status == kReadAll || read_status == kReadHalf) {
     if (read_status == kReadAll) {
       command_len_ = 0;
     }
-    last_read_pos_ = -1;
+    if (!parse_in_place_ || read_status == kReadAll) {
+      last_read_pos_ = -1;
+    } else if (processed_len > 0) {
+      /*
+       * Passed on as complete commands or streamed to DealBulkChunk(),
+       * only the rest is kept. It is moved to the front of the buffer
+       * before the next read, until then the arguments stay valid.
+       */
+      consumed_len_ = processed_len;
+      command_len_ = last_read_pos_ + 1 - processed_len;
+    }
     bulk_len_ = redis_parser_.get_bulk_len();
+    bulk_end_ = redis_parser_.get_bulk_end();
+    if (read_status == kReadHalf &&
+        (is_awaiting_reply() || !response_.empty())) {
+      // Commands or a part of a streamed argument were passed on
+      read_status = kReadAll;
+    }
   }
-  if (!response_.empty()) {
+  // The response belongs to another thread until NotifyEpoll()
+  if (!is_awaiting_reply() && !response_.empty()) {
     set_is_reply(true);
   }
   return read_status; // OK || HALF || FULL_ERROR || PARSE_ERROR
 }
 
 WriteStatus RedisConn::SendReply() {
-  ssize_t nwritten = 0;
-  size_t wbuf_len = response_.size();
-  while (wbuf_len > 0) {
-    nwritten = write(fd(), response_.data() + wbuf_pos_, wbuf_len - wbuf_pos_);
-    if (nwritten <= 0) {
-      break;
-    }
-    wbuf_pos_ += nwritten;
-    if (wbuf_pos_ == wbuf_len) {
-      // Have sended all response data
-      if (wbuf_len > DEFAULT_WBUF_SIZE) {
-        std::string buf;
-        buf.reserve(DEFAULT_WBUF_SIZE);
-        response_.swap(buf);
-      }
-      response_.clear();
-
-      wbuf_len = 0;
-      wbuf_pos_ = 0;
+  WriteStatus status = response_.Flush(fd());
+  if (status == kWriteAll && handle_type_ == kAsynchronous) {
+    // Before the reply is passed on, NotifyEpoll() may follow right away
+    set_is_awaiting_reply(true);
+    if (!ContinueReply()) {
+      set_is_awaiting_reply(false);
     }
   }
-  if (nwritten == -1) {
-    if (errno == EAGAIN) {
-      return kWriteHalf;
-    } else {
-      // Here we should close the connection
-      return kWriteError;
-    }
-  }
-  if (wbuf_len == 0) {
-    return kWriteAll;
-  } else {
-    return kWriteHalf;
-  }
+  return status;
 }
 
 int RedisConn::WriteResp(const std::string& resp) {
-  response_.append(resp);
+  response_.Append(resp);
   set_is_reply(true);
   return 0;
 }
@@ -203,7 +220,54 @@ HandleType RedisConn::GetHandleType() {
   return handle_type_;
 }
 
+void RedisConn::SetParseInPlace(bool parse_in_place) {
+  parse_in_place_ = parse_in_place;
+}
+
+void RedisConn::SetBulkStreamThreshold(long threshold) {
+  redis_parser_.set_bulk_stream_threshold(threshold);
+}
+
 void RedisConn::ProcessRedisCmds(const std::vector<RedisCmdArgsType>& argvs, bool async, std::string* response) {
+  if (handle_type_ == kSynchronous) {
+    // DealMessage() was called as they were parsed
+    return;
+  }
+  for (const auto& argv : argvs) {
+    if (DealMessage(argv, response) != 0) {
+      SetClose(true);
+      break;
+    }
+  }
+  if (async) {
+    NotifyEpoll(true);
+  }
+}
+
+void RedisConn::ProcessRedisCmdViews(const std::vector<RedisCmdArgsViewType>& argvs, bool async, std::string* response) {
+  std::vector<RedisCmdArgsType> copied_argvs;
+  copied_argvs.reserve(argvs.size());
+  for (const auto& argv : argvs) {
+    copied_argvs.emplace_back(argv.begin(), argv.end());
+  }
+  ProcessRedisCmds(copied_argvs, async, response);
+}
+
+int RedisConn::DealMessageView(const RedisCmdArgsViewType& argv, std::string* response) {
+  RedisCmdArgsType copied_argv(argv.begin(), argv.end());
+  return DealMessage(copied_argv, response);
+}
+
+bool RedisConn::StartBulkStream(const RedisCmdArgsViewType& leading_args, long bulk_len) {
+  return false;
+}
+
+int RedisConn::DealBulkChunk(std::string_view chunk, bool last) {
+  return -1;
+}
+
+bool RedisConn::ContinueReply() {
+  return false;
 }
 
 void RedisConn::NotifyEpoll(bool success) {
@@ -214,7 +278,7 @@ void RedisConn::NotifyEpoll(bool success) {
 int RedisConn::ParserDealMessageCb(RedisParser* parser, const RedisCmdArgsType& argv) {
   RedisConn* conn = reinterpret_cast<RedisConn*>(parser->data);
   if (conn->GetHandleType() == HandleType::kSynchronous) {
-    return conn->DealMessage(argv, &(conn->response_));
+    return conn->DealMessage(argv, conn->response_.buffer());
   } else {
     return 0;
   }
@@ -223,8 +287,49 @@ int RedisConn::ParserDealMessageCb(RedisParser* parser, const RedisCmdArgsType&
 int RedisConn::ParserCompleteCb(RedisParser* parser, const std::vector<RedisCmdArgsType>& argvs) {
   RedisConn* conn = reinterpret_cast<RedisConn*>(parser->data);
   bool async = conn->GetHandleType() == HandleType::kAsynchronous;
-  conn->ProcessRedisCmds(argvs, async, &(conn->response_));
+  // Before the commands are passed on, NotifyEpoll() may follow right away
+  conn->set_is_awaiting_reply(async);
+  conn->ProcessRedisCmds(argvs, async, conn->response_.buffer());
+  return 0;
+}
+
+int RedisConn::ParserDealMessageViewCb(RedisParser* parser, const RedisCmdArgsViewType& argv) {
+  RedisConn* conn = reinterpret_cast<RedisConn*>(parser->data);
+  if (conn->GetHandleType() == HandleType::kSynchronous) {
+    return conn->DealMessageView(argv, conn->response_.buffer());
+  } else {
+    return 0;
+  }
+}
+
+int RedisConn::ParserCompleteViewCb(RedisParser* parser, const std::vector<RedisCmdArgsViewType>& argvs) {
+  RedisConn* conn = reinterpret_cast<RedisConn*>(parser->data);
+  if (conn->GetHandleType() == HandleType::kSynchronous) {
+    // DealMessageView() was called as they were parsed, nothing to copy
+    return 0;
+  }
+  bool async = conn->GetHandleType() == HandleType::kAsynchronous;
+  conn->set_is_awaiting_reply(async);
+  conn->ProcessRedisCmdViews(argvs, async, conn->response_.buffer());
   return 0;
 }
 
+bool RedisConn::ParserStartBulkStreamCb(RedisParser* parser, const RedisCmdArgsViewType& leading_args, long bulk_len) {
+  RedisConn* conn = reinterpret_cast<RedisConn*>(parser->data);
+  return conn->StartBulkStream(leading_args, bulk_len);
+}
+
+int RedisConn::ParserDealBulkChunkCb(RedisParser* parser, std::string_view chunk, bool last) {
+  RedisConn* conn = reinterpret_cast<RedisConn*>(parser->data);
+  bool async = !last && conn->GetHandleType() == HandleType::kAsynchronous;
+  // Before the part is passed on, NotifyEpoll() may follow right away
+  conn->set_is_awaiting_reply(async);
+  int ret = conn->DealBulkChunk(chunk, last);
+  if (ret == 1 && async) {
+    return 0;
+  }
+  conn->set_is_awaiting_reply(false);
+  return ret == 0 ? 0 : -1;
+}
+
 }  // namespace pink
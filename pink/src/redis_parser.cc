@@ -7,8 +7,11 @@
 
 #include <assert.h>     /* assert */
 
+#include <algorithm>
+
 #include "slash/include/slash_string.h"
 #include "slash/include/xdebug.h"
+#include "pink/src/resp_scan.h"
 
 namespace pink {
 
@@ -30,6 +33,7 @@ static int HexDigitToInt32(char ch) {
 
 static int split2args(const std::string& req_buf, RedisCmdArgsType& argv) {
   const char *p = req_buf.data();
+  const char *end = p + req_buf.size();
   std::string arg;
 
   while (1) {
@@ -112,10 +116,13 @@ static int split2args(const std::string& req_buf, RedisCmdArgsType& argv) {
             case '\'':
               insq = 1;
             break;
-            default:
-              // current = sdscatlen(current,p,1);
-              arg.append(1, *p);
+            default: {
+              // Take the whole unquoted run at once
+              const char *run_end = FindInlineDelimiter(p, end);
+              arg.append(p, run_end - p);
+              p = run_end - 1;
               break;
+            }
           }
         }
         if (*p) p++;
@@ -132,14 +139,9 @@ int RedisParser::FindNextSeparators() {
   if (cur_pos_ > length_ - 1) {
     return -1;
   }
-  int pos = cur_pos_;
-  while (pos <= length_ - 1) {
-    if (input_buf_[pos] == '\n') {
-      return pos;
-    }
-    pos++;
-  }
-  return -1;
+  const char* end = input_buf_ + length_;
+  const char* lf = FindLineFeed(input_buf_ + cur_pos_, end);
+  return lf == end ? -1 : static_cast<int>(lf - input_buf_);
 }
 
 int RedisParser::GetNextNum(int pos, long* value) {
@@ -149,12 +151,7 @@ int RedisParser::GetNextNum(int pos, long* value) {
   //      |    |
   //      *3\r\n
   // [cur_pos_ + 1, pos - cur_pos_ - 2]
-  if (slash::string2l(input_buf_ + cur_pos_ + 1,
-                            pos - cur_pos_ - 2,
-                            value)) {
-    return 0; // Success
-  }
-  return -1; // Failed
+  return ParseRespLength(input_buf_ + cur_pos_ + 1, pos - cur_pos_ - 2, value);
 }
 
 RedisParser::RedisParser()
@@ -165,13 +162,17 @@ RedisParser::RedisParser()
     bulk_len_(-1),
     redis_parser_type_(REDIS_PARSER_REQUEST),
     cur_pos_(0),
+    cmd_start_(0),
     input_buf_(NULL),
-    length_(0) {
+    length_(0),
+    in_place_(false),
+    bulk_stream_threshold_(0),
+    bulk_stream_remain_(-1) {
 }
 
 void RedisParser::SetParserStatus(RedisParserStatus status,
     RedisParserError error) {
-  if (status == kRedisParserHalf) {
+  if (status == kRedisParserHalf && !in_place_) {
     CacheHalfArgv();
   }
   status_code_ = status;
@@ -205,7 +206,7 @@ RedisParserStatus RedisParser::ProcessInlineBuffer() {
   pos = FindNextSeparators();
   if (pos == -1) {
     // change rbuf_len_ to length_
-    if (length_ > REDIS_INLINE_MAXLEN) {
+    if (length_ - cur_pos_ > REDIS_INLINE_MAXLEN) {
       SetParserStatus(kRedisParserError, kRedisParserFullError);
       return status_code_;
     } else {
@@ -224,6 +225,15 @@ RedisParserStatus RedisParser::ProcessInlineBuffer() {
     SetParserStatus(kRedisParserError, kRedisParserProtoError);
     return status_code_;
   }
+  if (in_place_) {
+    // The unescaped arguments are not part of the input
+    for (const auto& arg : argv_) {
+      arg_refs_.push_back({static_cast<int>(inline_args_.size()),
+                           static_cast<int>(arg.size()), true});
+      inline_args_.append(arg);
+    }
+    argv_.clear();
+  }
   SetParserStatus(kRedisParserDone);
   return status_code_;
 }
@@ -265,17 +275,26 @@ RedisParserStatus RedisParser::ProcessMultibulkBuffer() {
           return status_code_;
         }
         cur_pos_ = pos + 1;
+        StartBulkStream();
       }
       if (pos == -1 || cur_pos_ > length_ - 1) {
         SetParserStatus(kRedisParserHalf);
         return status_code_;
       }
     }
-    if ((length_ - 1) - cur_pos_ + 1 < bulk_len_ + 2) {
+    if (bulk_stream_remain_ != -1) {
+      if (ProcessBulkStream() != kRedisParserDone) {
+        return status_code_;
+      }
+    } else if ((length_ - 1) - cur_pos_ + 1 < bulk_len_ + 2) {
       // Data not enough
       break;
     } else {
-      argv_.emplace_back(input_buf_ + cur_pos_, bulk_len_);
+      if (in_place_) {
+        arg_refs_.push_back({cur_pos_, static_cast<int>(bulk_len_), false});
+      } else {
+        argv_.emplace_back(input_buf_ + cur_pos_, bulk_len_);
+      }
       cur_pos_ = cur_pos_ + bulk_len_ + 2;
       bulk_len_ = -1;
       multibulk_len_--;
@@ -291,6 +310,64 @@ RedisParserStatus RedisParser::ProcessMultibulkBuffer() {
   }
 }
 
+/*
+ * Only the last argument of the first command in the input is streamed.
+ * The arguments before it are copied to inline_args_, so that the input
+ * can be dropped as it is streamed.
+ */
+bool RedisParser::StartBulkStream() {
+  if (!in_place_ || bulk_stream_threshold_ <= 0 ||
+      bulk_len_ <= bulk_stream_threshold_ || multibulk_len_ != 1 ||
+      !cmd_ends_.empty() || parser_settings_.StartBulkStream == NULL ||
+      parser_settings_.DealBulkChunk == NULL) {
+    return false;
+  }
+  RedisCmdArgsViewType leading_args;
+  GetArgViews(0, arg_refs_.size(), &leading_args);
+  if (!parser_settings_.StartBulkStream(this, leading_args, bulk_len_)) {
+    return false;
+  }
+  for (auto& ref : arg_refs_) {
+    if (!ref.in_inline_args) {
+      int offset = static_cast<int>(inline_args_.size());
+      inline_args_.append(input_buf_ + ref.offset, ref.len);
+      ref = {offset, ref.len, true};
+    }
+  }
+  bulk_stream_remain_ = bulk_len_;
+  return true;
+}
+
+/*
+ * Hands the part of the streamed argument that is in the input to
+ * DealBulkChunk. Returns kRedisParserDone once the whole argument and
+ * its \r\n were parsed.
+ */
+RedisParserStatus RedisParser::ProcessBulkStream() {
+  long available = length_ - cur_pos_;
+  if (bulk_stream_remain_ > 0 && available > 0) {
+    long chunk_len = std::min(available, bulk_stream_remain_);
+    std::string_view chunk(input_buf_ + cur_pos_, chunk_len);
+    cur_pos_ += chunk_len;
+    bulk_stream_remain_ -= chunk_len;
+    if (parser_settings_.DealBulkChunk(this, chunk,
+                                       bulk_stream_remain_ == 0) != 0) {
+      SetParserStatus(kRedisParserError, kRedisParserDealError);
+      return status_code_;
+    }
+  }
+  if (bulk_stream_remain_ > 0 || length_ - cur_pos_ < 2) {
+    SetParserStatus(kRedisParserHalf);
+    return status_code_;
+  }
+  cur_pos_ += 2;
+  arg_refs_.push_back({0, 0, true});
+  bulk_stream_remain_ = -1;
+  bulk_len_ = -1;
+  multibulk_len_--;
+  return kRedisParserDone;
+}
+
 void RedisParser::PrintCurrentStatus() {
   log_info("status_code %d error_code %d", status_code_, error_code_);
   log_info("multibulk_len_ %ld bulk_len %ld redis_type %d redis_parser_type %d", multibulk_len_, bulk_len_, redis_type_, redis_parser_type_);
@@ -312,11 +389,15 @@ RedisParserStatus RedisParser::ProcessInputBuffer(
   if (status_code_ == kRedisParserInitDone ||
       status_code_ == kRedisParserHalf ||
       status_code_ == kRedisParserDone) {
-    // TODO AZ: avoid copy
-    std::string tmp_str(input_buf, length);
-    input_str_ = half_argv_ + tmp_str;
-    input_buf_ = input_str_.c_str();
-    length_ = length + half_argv_.size();
+    if (half_argv_.empty()) {
+      input_buf_ = input_buf;
+      length_ = length;
+    } else {
+      input_str_.assign(half_argv_);
+      input_str_.append(input_buf, length);
+      input_buf_ = input_str_.c_str();
+      length_ = input_str_.size();
+    }
     if (redis_parser_type_ == REDIS_PARSER_REQUEST) {
       ProcessRequestBuffer();
     } else if (redis_parser_type_ == REDIS_PARSER_RESPONSE) {
@@ -335,6 +416,105 @@ RedisParserStatus RedisParser::ProcessInputBuffer(
   return status_code_;
 }
 
+RedisParserStatus RedisParser::ProcessInputBufferInPlace(
+    const char* input_buf, int length, int* parsed_len) {
+  if (redis_parser_type_ != REDIS_PARSER_REQUEST) {
+    SetParserStatus(kRedisParserError, kRedisParserInitError);
+    return status_code_;
+  }
+  if (status_code_ == kRedisParserInitDone ||
+      status_code_ == kRedisParserHalf ||
+      status_code_ == kRedisParserDone) {
+    in_place_ = true;
+    input_buf_ = input_buf;
+    length_ = length;
+    ProcessRequestBuffer();
+    if (status_code_ == kRedisParserHalf && bulk_stream_remain_ != -1) {
+      // Only the rest of the input is passed again with more data
+      *parsed_len = cur_pos_;
+      cur_pos_ = 0;
+      cmd_start_ = 0;
+      input_buf_ = NULL;
+      length_ = 0;
+    } else if (status_code_ == kRedisParserHalf) {
+      // Only the incomplete command is passed again with more data
+      *parsed_len = cmd_start_;
+      if (cmd_start_ > 0 && CompleteBeforeHalfCommand() != 0) {
+        SetParserStatus(kRedisParserError, kRedisParserCompleteError);
+        return status_code_;
+      }
+      input_buf_ = NULL;
+      length_ = 0;
+    } else {
+      *parsed_len = cur_pos_;
+      ResetRedisParser();
+    }
+    return status_code_;
+  }
+  SetParserStatus(kRedisParserError, kRedisParserInitError);
+  return status_code_;
+}
+
+void RedisParser::GetArgViews(size_t begin, size_t end,
+                              RedisCmdArgsViewType* argv) {
+  argv->reserve(end - begin);
+  for (size_t i = begin; i < end; i++) {
+    const ArgRef& ref = arg_refs_[i];
+    const char* base = ref.in_inline_args ? inline_args_.data() : input_buf_;
+    argv->emplace_back(base + ref.offset, ref.len);
+  }
+}
+
+int RedisParser::DeliverCommand() {
+  size_t begin = cmd_ends_.empty() ? 0 : cmd_ends_.back();
+  if (arg_refs_.size() == begin) {
+    return 0;
+  }
+  cmd_ends_.push_back(arg_refs_.size());
+  if (parser_settings_.DealMessageView) {
+    RedisCmdArgsViewType argv;
+    GetArgViews(begin, arg_refs_.size(), &argv);
+    return parser_settings_.DealMessageView(this, argv);
+  }
+  return 0;
+}
+
+int RedisParser::CompleteCommands() {
+  int ret = 0;
+  if (parser_settings_.CompleteView) {
+    std::vector<RedisCmdArgsViewType> argvs(cmd_ends_.size());
+    size_t begin = 0;
+    for (size_t i = 0; i < cmd_ends_.size(); i++) {
+      GetArgViews(begin, cmd_ends_[i], &argvs[i]);
+      begin = cmd_ends_[i];
+    }
+    ret = parser_settings_.CompleteView(this, argvs);
+  }
+  arg_refs_.clear();
+  cmd_ends_.clear();
+  inline_args_.clear();
+  return ret;
+}
+
+/*
+ * Completes the commands before the incomplete one at cmd_start_ and
+ * moves the offsets of the incomplete one to the start of the input, as
+ * the input before it is not passed again.
+ */
+int RedisParser::CompleteBeforeHalfCommand() {
+  size_t begin = cmd_ends_.empty() ? 0 : cmd_ends_.back();
+  std::vector<ArgRef> half_args(arg_refs_.begin() + begin, arg_refs_.end());
+  arg_refs_.resize(begin);
+  int ret = cmd_ends_.empty() ? 0 : CompleteCommands();
+  for (auto& ref : half_args) {
+    ref.offset -= cmd_start_;
+  }
+  arg_refs_ = std::move(half_args);
+  cur_pos_ -= cmd_start_;
+  cmd_start_ = 0;
+  return ret;
+}
+
 // TODO AZ
 RedisParserStatus RedisParser::ProcessResponseBuffer() {
   SetParserStatus(kRedisParserDone);
@@ -345,6 +525,7 @@ RedisParserStatus RedisParser::ProcessRequestBuffer() {
   RedisParserStatus ret;
   while (cur_pos_ <= length_ - 1) {
     if (!redis_type_) {
+      cmd_start_ = cur_pos_;
       if (input_buf_[cur_pos_] == '*') {
         redis_type_ = REDIS_REQ_MULTIBULK;
       } else {
@@ -366,20 +547,30 @@ RedisParserStatus RedisParser::ProcessRequestBuffer() {
       // Unknown requeset type;
       return kRedisParserError;
     }
-    if (!argv_.empty()) {
-      argvs_.push_back(argv_);
+    if (in_place_) {
+      if (DeliverCommand() != 0) {
+        SetParserStatus(kRedisParserError, kRedisParserDealError);
+        return status_code_;
+      }
+    } else if (!argv_.empty()) {
       if (parser_settings_.DealMessage) {
         if (parser_settings_.DealMessage(this, argv_) != 0) {
           SetParserStatus(kRedisParserError, kRedisParserDealError);
           return status_code_;
         }
       }
+      argvs_.push_back(std::move(argv_));
     }
     argv_.clear();
     // Reset
     ResetCommandStatus();
   }
-  if (parser_settings_.Complete) {
+  if (in_place_) {
+    if (CompleteCommands() != 0) {
+      SetParserStatus(kRedisParserError, kRedisParserCompleteError);
+      return status_code_;
+    }
+  } else if (parser_settings_.Complete) {
     if (parser_settings_.Complete(this, argvs_) != 0) {
       SetParserStatus(kRedisParserError, kRedisParserCompleteError);
       return status_code_;
@@ -394,14 +585,19 @@ void RedisParser::ResetCommandStatus() {
   redis_type_ = 0;
   multibulk_len_ = 0;
   bulk_len_ = -1;
+  bulk_stream_remain_ = -1;
   half_argv_.clear();
 }
 
 void RedisParser::ResetRedisParser() {
   cur_pos_ = 0;
+  cmd_start_ = 0;
   input_buf_ = NULL;
   input_str_.clear();
   length_ = 0;
+  arg_refs_.clear();
+  cmd_ends_.clear();
+  inline_args_.clear();
 }
 
 }  // namespace pink
@@ -0,0 +1,205 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pink/src/resp_scan.h"
+
+#include <string.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include "slash/include/slash_string.h"
+
+namespace pink {
+
+typedef const char* (*ScanFunc)(const char* begin, const char* end);
+
+static inline bool IsInlineDelimiter(char ch) {
+  return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n' ||
+         ch == '\0' || ch == '"' || ch == '\'';
+}
+
+static const char* FindLineFeedScalar(const char* begin, const char* end) {
+  const char* p = static_cast<const char*>(memchr(begin, '\n', end - begin));
+  return p == NULL ? end : p;
+}
+
+static const char* FindInlineDelimiterScalar(const char* begin,
+                                             const char* end) {
+  while (begin < end && !IsInlineDelimiter(*begin)) {
+    begin++;
+  }
+  return begin;
+}
+
+#if defined(__x86_64__)
+
+/*
+ * RESP headers are a few bytes long, so the kernels look at the first
+ * block right away instead of aligning first, and leave the tail that
+ * does not fill a block to the scalar loop.
+ */
+__attribute__((target("sse4.2")))
+static const char* FindLineFeedSSE42(const char* begin, const char* end) {
+  const __m128i lf = _mm_set1_epi8('\n');
+  while (end - begin >= 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(block, lf));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 16;
+  }
+  return FindLineFeedScalar(begin, end);
+}
+
+__attribute__((target("sse4.2")))
+static const char* FindInlineDelimiterSSE42(const char* begin,
+                                            const char* end) {
+  // Explicit length, since '\0' is one of the delimiters
+  const __m128i delimiters = _mm_setr_epi8(' ', '\t', '\r', '\n', '\0',
+                                           '"', '\'', 0, 0, 0, 0, 0, 0, 0,
+                                           0, 0);
+  while (end - begin >= 16) {
+    __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(begin));
+    int index = _mm_cmpestri(delimiters, 7, block, 16,
+                             _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY |
+                             _SIDD_LEAST_SIGNIFICANT);
+    if (index < 16) {
+      return begin + index;
+    }
+    begin += 16;
+  }
+  return FindInlineDelimiterScalar(begin, end);
+}
+
+__attribute__((target("avx2")))
+static const char* FindLineFeedAVX2(const char* begin, const char* end) {
+  const __m256i lf = _mm256_set1_epi8('\n');
+  while (end - begin >= 32) {
+    __m256i block =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    unsigned mask = _mm256_movemask_epi8(_mm256_cmpeq_epi8(block, lf));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 32;
+  }
+  return FindLineFeedSSE42(begin, end);
+}
+
+/*
+ * The delimiters are classified by nibble: one table gives the high
+ * nibbles a delimiter can have ('\0', '\t', '\n', '\r' are 0x0?, the
+ * blank and the quotes 0x2?), the other the low nibbles for each class.
+ * A byte is a delimiter when both lookups share a bit.
+ */
+__attribute__((target("avx2")))
+static const char* FindInlineDelimiterAVX2(const char* begin,
+                                           const char* end) {
+  const __m256i low_table = _mm256_setr_epi8(
+      3, 0, 2, 0, 0, 0, 0, 2, 0, 1, 1, 0, 0, 1, 0, 0,
+      3, 0, 2, 0, 0, 0, 0, 2, 0, 1, 1, 0, 0, 1, 0, 0);
+  const __m256i high_table = _mm256_setr_epi8(
+      1, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+      1, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+  const __m256i zero = _mm256_setzero_si256();
+  while (end - begin >= 32) {
+    __m256i block =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(begin));
+    __m256i low = _mm256_shuffle_epi8(low_table,
+                                      _mm256_and_si256(block, nibble));
+    __m256i high = _mm256_shuffle_epi8(
+        high_table, _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble));
+    __m256i hits = _mm256_cmpeq_epi8(_mm256_and_si256(low, high), zero);
+    unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(hits));
+    if (mask != 0) {
+      return begin + __builtin_ctz(mask);
+    }
+    begin += 32;
+  }
+  return FindInlineDelimiterSSE42(begin, end);
+}
+
+#endif  // defined(__x86_64__)
+
+static RespScanKernel BestKernel() {
+#if defined(__x86_64__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return kRespScanAVX2;
+  }
+  if (__builtin_cpu_supports("sse4.2")) {
+    return kRespScanSSE42;
+  }
+#endif
+  return kRespScanScalar;
+}
+
+static RespScanKernel kernel_in_use = kRespScanScalar;
+static ScanFunc find_line_feed = FindLineFeedScalar;
+static ScanFunc find_inline_delimiter = FindInlineDelimiterScalar;
+
+RespScanKernel SetRespScanKernel(RespScanKernel kernel) {
+  RespScanKernel best = BestKernel();
+  if (kernel > best) {
+    kernel = best;
+  }
+  switch (kernel) {
+#if defined(__x86_64__)
+    case kRespScanAVX2:
+      find_line_feed = FindLineFeedAVX2;
+      find_inline_delimiter = FindInlineDelimiterAVX2;
+      break;
+    case kRespScanSSE42:
+      find_line_feed = FindLineFeedSSE42;
+      find_inline_delimiter = FindInlineDelimiterSSE42;
+      break;
+#endif
+    default:
+      kernel = kRespScanScalar;
+      find_line_feed = FindLineFeedScalar;
+      find_inline_delimiter = FindInlineDelimiterScalar;
+      break;
+  }
+  kernel_in_use = kernel;
+  return kernel;
+}
+
+// Chooses the widest kernel when the library is loaded
+static RespScanKernel initial_kernel = SetRespScanKernel(kRespScanAVX2);
+
+RespScanKernel GetRespScanKernel() {
+  return kernel_in_use;
+}
+
+const char* FindLineFeed(const char* begin, const char* end) {
+  return find_line_feed(begin, end);
+}
+
+const char* FindInlineDelimiter(const char* begin, const char* end) {
+  return find_inline_delimiter(begin, end);
+}
+
+int ParseRespLength(const char* s, int len, long* value) {
+  // Lengths in requests are short and positive, anything else is rare
+  if (len <= 0 || len > 18 || s[0] < '1' || s[0] > '9') {
+    return slash::string2l(s, len, value) ? 0 : -1;
+  }
+  long v = 0;
+  for (int i = 0; i < len; i++) {
+    unsigned digit = static_cast<unsigned char>(s[i]) - '0';
+    if (digit > 9) {
+      return -1;
+    }
+    v = v * 10 + digit;
+  }
+  *value = v;
+  return 0;
+}
+
+}  // namespace pink
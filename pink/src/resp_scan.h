@@ -0,0 +1,46 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef PINK_SRC_RESP_SCAN_H_
+#define PINK_SRC_RESP_SCAN_H_
+
+namespace pink {
+
+/*
+ * Scanning kernels of the RESP parser. The widest kernel the CPU supports
+ * is chosen when the library is loaded.
+ */
+enum RespScanKernel {
+  kRespScanScalar = 0,
+  kRespScanSSE42 = 1,
+  kRespScanAVX2 = 2,
+};
+
+// Returns the first '\n' in [begin, end), or end if there is none
+const char* FindLineFeed(const char* begin, const char* end);
+
+/*
+ * Returns the first byte in [begin, end) that ends an unquoted argument
+ * of an inline command (blank, quote or '\0'), or end if there is none.
+ */
+const char* FindInlineDelimiter(const char* begin, const char* end);
+
+/*
+ * Parses the number of a RESP length header such as "$3". Accepts the
+ * same input as slash::string2l(). Returns 0 on success.
+ */
+int ParseRespLength(const char* s, int len, long* value);
+
+RespScanKernel GetRespScanKernel();
+
+/*
+ * For tests and benchmarks. Kernels the CPU does not support are
+ * replaced by the widest one it does. Returns the kernel in use.
+ */
+RespScanKernel SetRespScanKernel(RespScanKernel kernel);
+
+}  // namespace pink
+
+#endif  // PINK_SRC_RESP_SCAN_H_
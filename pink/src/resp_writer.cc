@@ -0,0 +1,155 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pink/include/resp_writer.h"
+
+#include <errno.h>
+#include <limits.h>
+
+#include "slash/include/slash_string.h"
+
+namespace pink {
+
+// Shorter data is copied, an extra iovec costs more than the copy
+static const size_t kMinRefLen = 1024;
+
+static void AppendNumber(std::string* buf, char prefix, long long value) {
+  char num_buf[32];
+  num_buf[0] = prefix;
+  int len = slash::ll2string(num_buf + 1, sizeof(num_buf) - 3, value) + 1;
+  num_buf[len++] = '\r';
+  num_buf[len++] = '\n';
+  buf->append(num_buf, len);
+}
+
+RespWriter::RespWriter()
+    : sealed_len_(0),
+      ref_len_(0),
+      sent_(0) {
+}
+
+void RespWriter::AppendInteger(long long value) {
+  AppendNumber(&buf_, ':', value);
+}
+
+void RespWriter::AppendBulkHeader(size_t len) {
+  AppendNumber(&buf_, '$', len);
+}
+
+void RespWriter::AppendArrayHeader(size_t len) {
+  AppendNumber(&buf_, '*', len);
+}
+
+void RespWriter::AppendBulk(std::string_view data) {
+  buf_.reserve(buf_.size() + data.size() + 32);
+  AppendBulkHeader(data.size());
+  buf_.append(data.data(), data.size());
+  buf_.append("\r\n", 2);
+}
+
+void RespWriter::SealBuffer() {
+  if (buf_.size() > sealed_len_) {
+    segments_.push_back({nullptr, sealed_len_, buf_.size() - sealed_len_});
+    sealed_len_ = buf_.size();
+  }
+}
+
+void RespWriter::AppendRef(const char* data, size_t len) {
+  if (len < kMinRefLen) {
+    buf_.append(data, len);
+    return;
+  }
+  SealBuffer();
+  if (!segments_.empty()) {
+    Segment& last = segments_.back();
+    if (last.data != nullptr && last.data + last.len == data) {
+      last.len += len;
+      ref_len_ += len;
+      return;
+    }
+  }
+  segments_.push_back({data, 0, len});
+  ref_len_ += len;
+}
+
+void RespWriter::Retain(std::shared_ptr<const void> owner) {
+  owners_.push_back(std::move(owner));
+}
+
+void RespWriter::Append(RespWriter* other) {
+  for (const Segment& segment : other->segments_) {
+    if (segment.data != nullptr) {
+      AppendRef(segment.data, segment.len);
+    } else {
+      buf_.append(other->buf_.data() + segment.offset, segment.len);
+    }
+  }
+  buf_.append(other->buf_.data() + other->sealed_len_,
+              other->buf_.size() - other->sealed_len_);
+  for (auto& owner : other->owners_) {
+    owners_.push_back(std::move(owner));
+  }
+  other->Clear();
+}
+
+void RespWriter::Clear() {
+  if (buf_.size() > DEFAULT_WBUF_SIZE) {
+    std::string buf;
+    buf.reserve(DEFAULT_WBUF_SIZE);
+    buf_.swap(buf);
+  }
+  buf_.clear();
+  sealed_len_ = 0;
+  ref_len_ = 0;
+  segments_.clear();
+  owners_.clear();
+  sent_ = 0;
+}
+
+WriteStatus RespWriter::Flush(int fd) {
+  size_t total_len = size();
+  while (sent_ < total_len) {
+    // Skip what was written by earlier calls
+    size_t skip = sent_;
+    iov_.clear();
+    auto add_iov = [&](const char* data, size_t len) {
+      if (skip >= len) {
+        skip -= len;
+        return;
+      }
+      iov_.push_back({const_cast<char*>(data) + skip, len - skip});
+      skip = 0;
+    };
+    for (const Segment& segment : segments_) {
+      if (iov_.size() == IOV_MAX) {
+        break;
+      }
+      add_iov(segment.data != nullptr ? segment.data
+                                      : buf_.data() + segment.offset,
+              segment.len);
+    }
+    if (iov_.size() < IOV_MAX) {
+      add_iov(buf_.data() + sealed_len_, buf_.size() - sealed_len_);
+    }
+
+    ssize_t nwritten = writev(fd, iov_.data(), iov_.size());
+    if (nwritten == -1) {
+      if (errno == EAGAIN) {
+        return kWriteHalf;
+      } else {
+        // Here we should close the connection
+        return kWriteError;
+      }
+    } else if (nwritten == 0) {
+      return kWriteHalf;
+    }
+    sent_ += nwritten;
+  }
+  // Have sended all response data
+  Clear();
+  return kWriteAll;
+}
+
+}  // namespace pink
@@ -61,6 +61,17 @@ class ServerSocket {
     return recv_timeout_;
   }
 
+  /*
+   * Lets several sockets listen to the same addr, the kernel spreads the
+   * incoming connections over them. Set before Listen
+   */
+  void set_reuse_port(bool reuse_port) {
+    reuse_port_ = reuse_port;
+  }
+  bool reuse_port() const {
+    return reuse_port_;
+  }
+
   int sockfd() const {
     return sockfd_;
   }
@@ -83,6 +94,7 @@ class ServerSocket {
   int tcp_send_buffer_;
   int tcp_recv_buffer_;
   bool keep_alive_;
+  bool reuse_port_;
   bool listening_;
   bool is_block_;
 
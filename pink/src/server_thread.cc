@@ -132,6 +132,11 @@ int ServerThread::StartThread() {
   return Thread::StartThread();
 }
 
+void ServerThread::SetPollBackend(PollBackend backend) {
+  delete pink_epoll_;
+  pink_epoll_ = new PinkEpoll(PinkEpoll::kUnlimitedQueue, backend);
+}
+
 int ServerThread::InitHandle() {
   int ret = 0;
   ServerSocket* socket_p;
@@ -157,6 +162,44 @@ int ServerThread::InitHandle() {
   return kSuccess;
 }
 
+int ServerThread::AcceptConn(int listen_fd, std::string* ip_port) {
+  struct sockaddr_in cliaddr;
+  socklen_t clilen = sizeof(struct sockaddr);
+  char port_buf[32];
+  char ip_addr[INET_ADDRSTRLEN] = "";
+
+  int connfd = accept(listen_fd, (struct sockaddr *) &cliaddr, &clilen);
+  if (connfd == -1) {
+    log_warn("accept error, errno numberis %d, error reason %s",
+             errno, strerror(errno));
+    return -1;
+  }
+  fcntl(connfd, F_SETFD, fcntl(connfd, F_GETFD) | FD_CLOEXEC);
+
+  // not use nagel to avoid tcp 40ms delay
+  if (SetTcpNoDelay(connfd) == -1) {
+    log_warn("setsockopt error, errno numberis %d, error reason %s",
+             errno, strerror(errno));
+    close(connfd);
+    return -1;
+  }
+
+  // Just ip
+  *ip_port =
+    inet_ntop(AF_INET, &cliaddr.sin_addr, ip_addr, sizeof(ip_addr));
+
+  if (!handle_->AccessHandle(*ip_port) ||
+      !handle_->AccessHandle(connfd, *ip_port)) {
+    close(connfd);
+    return -1;
+  }
+
+  ip_port->append(":");
+  snprintf(port_buf, sizeof(port_buf), "%d", ntohs(cliaddr.sin_port));
+  ip_port->append(port_buf);
+  return connfd;
+}
+
 void ServerThread::DoCronTask() {
 }
 
@@ -168,8 +211,6 @@ void *ServerThread::ThreadMain() {
   int nfds;
   PinkFiredEvent *pfe;
   Status s;
-  struct sockaddr_in cliaddr;
-  socklen_t clilen = sizeof(struct sockaddr);
   int fd, connfd;
 
   struct timeval when;
@@ -184,8 +225,6 @@ void *ServerThread::ThreadMain() {
   }
 
   std::string ip_port;
-  char port_buf[32];
-  char ip_addr[INET_ADDRSTRLEN] = "";
 
   while (!should_stop()) {
     if (cron_interval_ > 0) {
@@ -220,35 +259,10 @@ void *ServerThread::ThreadMain() {
        */
       if (server_fds_.find(fd) != server_fds_.end()) {
         if (pfe->mask & PinkEpoll::kRead) {
-          connfd = accept(fd, (struct sockaddr *) &cliaddr, &clilen);
+          connfd = AcceptConn(fd, &ip_port);
           if (connfd == -1) {
-            log_warn("accept error, errno numberis %d, error reason %s",
-                     errno, strerror(errno));
             continue;
           }
-          fcntl(connfd, F_SETFD, fcntl(connfd, F_GETFD) | FD_CLOEXEC);
-
-          // not use nagel to avoid tcp 40ms delay
-          if (SetTcpNoDelay(connfd) == -1) {
-            log_warn("setsockopt error, errno numberis %d, error reason %s",
-                     errno, strerror(errno));
-            close(connfd);
-            continue;
-          }
-
-          // Just ip
-          ip_port =
-            inet_ntop(AF_INET, &cliaddr.sin_addr, ip_addr, sizeof(ip_addr));
-
-          if (!handle_->AccessHandle(ip_port) ||
-              !handle_->AccessHandle(connfd, ip_port)) {
-            close(connfd);
-            continue;
-          }
-
-          ip_port.append(":");
-          snprintf(port_buf, sizeof(port_buf), "%d", ntohs(cliaddr.sin_port));
-          ip_port.append(port_buf);
 
           /*
            * Handle new connection,
@@ -0,0 +1,172 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pink/src/pink_epoll.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+
+namespace {
+
+using pink::PinkEpoll;
+using pink::PinkFiredEvent;
+
+// EXPECT_EQ takes references, which the class constants have no storage for
+const int kRead = PinkEpoll::kRead;
+const int kWrite = PinkEpoll::kWrite;
+
+class PinkEpollTest : public ::testing::TestWithParam<pink::PollBackend> {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, O_NONBLOCK));
+    epoll_ = new PinkEpoll(PinkEpoll::kUnlimitedQueue, GetParam());
+  }
+
+  void TearDown() override {
+    delete epoll_;
+    if (fds_[0] != -1) {
+      close(fds_[0]);
+    }
+    close(fds_[1]);
+  }
+
+  // Returns the mask fd fired with, 0 if it did not
+  int Poll(int fd, int timeout) {
+    int nfds = epoll_->PinkPoll(timeout);
+    for (int i = 0; i < nfds; i++) {
+      PinkFiredEvent* pfe = epoll_->firedevent() + i;
+      if (pfe->fd == fd) {
+        return pfe->mask;
+      }
+    }
+    return 0;
+  }
+
+  int fds_[2];
+  PinkEpoll* epoll_;
+};
+
+TEST_P(PinkEpollTest, LevelTriggered) {
+  ASSERT_EQ(0, epoll_->PinkAddEvent(fds_[0], PinkEpoll::kRead));
+  EXPECT_EQ(0, Poll(fds_[0], 0));
+
+  ASSERT_EQ(2, write(fds_[1], "ab", 2));
+  EXPECT_EQ(kRead, Poll(fds_[0], 1000));
+  // Still readable, so it fires again
+  EXPECT_EQ(kRead, Poll(fds_[0], 1000));
+
+  char buf[2];
+  ASSERT_EQ(2, read(fds_[0], buf, sizeof(buf)));
+  EXPECT_EQ(0, Poll(fds_[0], 10));
+}
+
+TEST_P(PinkEpollTest, ModAndDel) {
+  ASSERT_EQ(0, epoll_->PinkAddEvent(fds_[0], PinkEpoll::kRead));
+  ASSERT_EQ(0, epoll_->PinkModEvent(fds_[0], 0, PinkEpoll::kWrite));
+  EXPECT_EQ(kWrite, Poll(fds_[0], 1000));
+
+  ASSERT_EQ(0, epoll_->PinkModEvent(fds_[0], 0, PinkEpoll::kRead));
+  EXPECT_EQ(0, Poll(fds_[0], 10));
+
+  ASSERT_EQ(0, epoll_->PinkDelEvent(fds_[0], 0));
+  ASSERT_EQ(1, write(fds_[1], "a", 1));
+  EXPECT_EQ(0, Poll(fds_[0], 10));
+}
+
+TEST_P(PinkEpollTest, PeerClose) {
+  ASSERT_EQ(0, epoll_->PinkAddEvent(fds_[0], PinkEpoll::kRead));
+  shutdown(fds_[1], SHUT_RDWR);
+  EXPECT_NE(0, Poll(fds_[0], 1000) & PinkEpoll::kRead);
+}
+
+TEST_P(PinkEpollTest, PeerCloseAfterLocalClose) {
+  ASSERT_EQ(0, fcntl(fds_[1], F_SETFL, O_NONBLOCK));
+  ASSERT_EQ(0, epoll_->PinkAddEvent(fds_[0], PinkEpoll::kRead));
+  EXPECT_EQ(0, Poll(fds_[0], 0));
+
+  ASSERT_EQ(0, epoll_->PinkDelEvent(fds_[0], 0));
+  close(fds_[0]);
+  fds_[0] = -1;
+  // The polling thread submits the removal with its next wait
+  Poll(-1, 0);
+
+  struct pollfd peer = {fds_[1], POLLIN, 0};
+  ASSERT_EQ(1, poll(&peer, 1, 1000));
+  char buf[1];
+  EXPECT_EQ(0, read(fds_[1], buf, sizeof(buf)));
+}
+
+TEST_P(PinkEpollTest, DelFromOtherThread) {
+  ASSERT_EQ(0, epoll_->PinkAddEvent(fds_[0], PinkEpoll::kRead));
+  EXPECT_EQ(0, Poll(fds_[0], 0));
+
+  std::thread other([this] {
+    epoll_->PinkDelEvent(fds_[0], 0);
+  });
+  other.join();
+  ASSERT_EQ(1, write(fds_[1], "a", 1));
+  EXPECT_EQ(0, Poll(fds_[0], 10));
+}
+
+TEST_P(PinkEpollTest, Notify) {
+  ASSERT_TRUE(epoll_->Register(pink::PinkItem(), true));
+  EXPECT_EQ(kRead, Poll(epoll_->notify_receive_fd(), 1000));
+}
+
+// More items than the ring holds, from several threads at once
+TEST_P(PinkEpollTest, NotifyQueue) {
+  const int kThreads = 4;
+  const int kItems = 1000;
+  std::vector<std::thread> producers;
+  for (int t = 0; t < kThreads; t++) {
+    producers.emplace_back([this, t] {
+      for (int i = 0; i < kItems; i++) {
+        ASSERT_TRUE(epoll_->Register(
+            pink::PinkItem(i, std::to_string(t), pink::kNotiEpollin), true));
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+
+  // One wakeup for all of them
+  EXPECT_EQ(kRead, Poll(epoll_->notify_receive_fd(), 1000));
+  ASSERT_EQ(kThreads * kItems, epoll_->ConsumeNotify());
+  EXPECT_EQ(0, Poll(epoll_->notify_receive_fd(), 0));
+
+  // The items of every producer come in order
+  std::vector<int> next(kThreads, 0);
+  pink::PinkItem item;
+  for (int n = 0; n < kThreads * kItems; n++) {
+    ASSERT_TRUE(epoll_->notify_queue_pop(&item));
+    int t = std::stoi(item.ip_port());
+    EXPECT_EQ(next[t]++, item.fd());
+  }
+  EXPECT_FALSE(epoll_->notify_queue_pop(&item));
+}
+
+TEST_P(PinkEpollTest, NotifyQueueLimit) {
+  delete epoll_;
+  epoll_ = new PinkEpoll(2, GetParam());
+  EXPECT_TRUE(epoll_->Register(pink::PinkItem(), false));
+  EXPECT_TRUE(epoll_->Register(pink::PinkItem(), false));
+  EXPECT_FALSE(epoll_->Register(pink::PinkItem(), false));
+  EXPECT_TRUE(epoll_->Register(pink::PinkItem(), true));
+}
+
+INSTANTIATE_TEST_CASE_P(Backends, PinkEpollTest,
+                        ::testing::Values(pink::kPollEpoll,
+                                          pink::kPollIoUring));
+
+}  // namespace
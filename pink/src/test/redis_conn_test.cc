@@ -0,0 +1,305 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pink/include/redis_conn.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "pink/include/server_thread.h"
+#include "pink/src/pink_epoll.h"
+#include "pink/src/pink_item.h"
+#include "pink/src/worker_thread.h"
+
+namespace {
+
+using pink::HandleType;
+using pink::RedisCmdArgsType;
+
+const char kCommand[] = "*3\r\n$3\r\nSET\r\n$1\r\nk\r\n$5\r\nvalue\r\n";
+const char kOk[] = "+OK\r\n";
+const char kPart[] = "+PART\r\n";
+
+// Hand-offs to other threads that did not call NotifyEpoll() yet
+std::atomic<int> in_flight(0);
+
+std::string Repeat(const std::string& str, int times) {
+  std::string result;
+  for (int i = 0; i < times; i++) {
+    result += str;
+  }
+  return result;
+}
+
+/*
+ * Replies +OK to every command. "CONT n" is continued by n more parts
+ * through ContinueReply() and "SLOW ms" takes that long in another
+ * thread. With hand_off, kAsynchronous commands are executed by another
+ * thread, as a server like Rondis does.
+ */
+class TestConn : public pink::RedisConn {
+ public:
+  TestConn(int fd, pink::Thread* thread, pink::PinkEpoll* pink_epoll,
+           HandleType handle_type, bool hand_off)
+      : RedisConn(fd, "127.0.0.1:0", thread, pink_epoll, handle_type),
+        hand_off_(hand_off),
+        num_dealt_(0),
+        continued_parts_(0) {
+    SetParseInPlace(true);
+  }
+
+  int DealMessage(const RedisCmdArgsType& argv,
+                  std::string* response) override {
+    num_dealt_++;
+    if (argv.size() == 2 && argv[0] == "CONT") {
+      continued_parts_ = std::stoi(argv[1]);
+    }
+    response->append(kOk);
+    return 0;
+  }
+
+  void ProcessRedisCmds(const std::vector<RedisCmdArgsType>& argvs, bool async,
+                        std::string* response) override {
+    if (!async || !hand_off_) {
+      RedisConn::ProcessRedisCmds(argvs, async, response);
+      return;
+    }
+    in_flight++;
+    std::thread([this, argvs, response] {
+      if (argvs[0].size() == 2 && argvs[0][0] == "SLOW") {
+        usleep(std::stoi(argvs[0][1]) * 1000);
+      }
+      RedisConn::ProcessRedisCmds(argvs, true, response);
+      in_flight--;
+    }).detach();
+  }
+
+  bool ContinueReply() override {
+    if (continued_parts_ == 0) {
+      return false;
+    }
+    continued_parts_--;
+    in_flight++;
+    std::thread([this] {
+      resp_writer()->Append(kPart);
+      NotifyEpoll(true);
+      in_flight--;
+    }).detach();
+    return true;
+  }
+
+  int num_dealt() const {
+    return num_dealt_;
+  }
+
+ private:
+  bool hand_off_;
+  std::atomic<int> num_dealt_;
+  std::atomic<int> continued_parts_;
+};
+
+// Reads from fd until expected_len bytes arrived or nothing comes for a second
+std::string ReadReplies(int fd, size_t expected_len) {
+  std::string replies;
+  char buf[4096];
+  struct pollfd pfd = {fd, POLLIN, 0};
+  while (replies.size() < expected_len && poll(&pfd, 1, 1000) == 1) {
+    ssize_t nread = read(fd, buf, sizeof(buf));
+    if (nread <= 0) {
+      break;
+    }
+    replies.append(buf, nread);
+  }
+  return replies;
+}
+
+class RedisConnTest : public ::testing::TestWithParam<HandleType> {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, O_NONBLOCK));
+    epoll_ = new pink::PinkEpoll();
+    conn_ = new TestConn(fds_[0], nullptr, epoll_, GetParam(), false);
+  }
+
+  void TearDown() override {
+    delete conn_;
+    delete epoll_;
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  void Send(const std::string& data) {
+    ASSERT_EQ(static_cast<ssize_t>(data.size()),
+              write(fds_[1], data.data(), data.size()));
+  }
+
+  // What the worker thread does once a read is complete
+  void SendReply() {
+    if (GetParam() == pink::kAsynchronous) {
+      ASSERT_TRUE(conn_->is_awaiting_reply());
+      pink::PinkItem item;
+      ASSERT_EQ(1, epoll_->ConsumeNotify());
+      ASSERT_TRUE(epoll_->notify_queue_pop(&item));
+      EXPECT_EQ(fds_[0], item.fd());
+      EXPECT_EQ(pink::kNotiEpolloutAndEpollin, item.notify_type());
+      conn_->set_is_awaiting_reply(false);
+      conn_->set_is_reply(true);
+    }
+    ASSERT_TRUE(conn_->is_reply());
+    EXPECT_EQ(pink::kWriteAll, conn_->SendReply());
+    conn_->set_is_reply(false);
+    EXPECT_FALSE(conn_->is_awaiting_reply());
+  }
+
+  int fds_[2];
+  pink::PinkEpoll* epoll_;
+  TestConn* conn_;
+};
+
+}  // namespace
+
+TEST_P(RedisConnTest, OneReplyPerCommand) {
+  const int kCommands = 10;
+  Send(Repeat(kCommand, kCommands));
+  EXPECT_EQ(pink::kReadAll, conn_->GetRequest());
+  SendReply();
+  std::string expected = Repeat(kOk, kCommands);
+  EXPECT_EQ(expected, ReadReplies(fds_[1], expected.size() + 1));
+  EXPECT_EQ(kCommands, conn_->num_dealt());
+}
+
+TEST_P(RedisConnTest, PartialCommandCompletedByLaterRead) {
+  const int kCommands = 3;
+  std::string command(kCommand);
+  Send(Repeat(command, kCommands) + command.substr(0, 10));
+  // The complete commands are replied to right away
+  EXPECT_EQ(pink::kReadAll, conn_->GetRequest());
+  SendReply();
+  std::string expected = Repeat(kOk, kCommands);
+  EXPECT_EQ(expected, ReadReplies(fds_[1], expected.size() + 1));
+
+  Send(command.substr(10));
+  EXPECT_EQ(pink::kReadAll, conn_->GetRequest());
+  SendReply();
+  EXPECT_EQ(kOk, ReadReplies(fds_[1], strlen(kOk) + 1));
+  EXPECT_EQ(kCommands + 1, conn_->num_dealt());
+}
+
+INSTANTIATE_TEST_CASE_P(HandleTypes, RedisConnTest,
+                        ::testing::Values(pink::kSynchronous,
+                                          pink::kAsynchronous,
+                                          pink::kPipelined));
+
+namespace {
+
+class TestConnFactory : public pink::ConnFactory {
+ public:
+  explicit TestConnFactory(HandleType handle_type)
+      : handle_type_(handle_type) {}
+
+  std::shared_ptr<pink::PinkConn> NewPinkConn(
+      int connfd, const std::string& ip_port, pink::Thread* thread,
+      void* worker_private_data, pink::PinkEpoll* pink_epoll) const override {
+    (void)ip_port;
+    (void)worker_private_data;
+    return std::make_shared<TestConn>(connfd, thread, pink_epoll,
+                                      handle_type_, true);
+  }
+
+ private:
+  HandleType handle_type_;
+};
+
+/*
+ * A worker thread serving one end of a socketpair. The server thread is
+ * never started, the worker only takes its handle.
+ */
+class WorkerThreadReplyTest : public ::testing::TestWithParam<HandleType> {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    factory_ = new TestConnFactory(GetParam());
+    server_ = pink::NewDispatchThread(0, 1, factory_, 100);
+    worker_ = new pink::WorkerThread(factory_, server_, 1000, 100);
+    ASSERT_EQ(0, worker_->StartThread());
+    ASSERT_TRUE(worker_->MoveConnIn(
+        pink::PinkItem(fds_[0], "127.0.0.1:0", pink::kNotiConnect), true));
+  }
+
+  void TearDown() override {
+    while (in_flight.load() > 0) {
+      usleep(1000);
+    }
+    // Closes fds_[0]
+    worker_->StopThread();
+    delete worker_;
+    delete server_;
+    delete factory_;
+    close(fds_[1]);
+  }
+
+  void Send(const std::string& data) {
+    ASSERT_EQ(static_cast<ssize_t>(data.size()),
+              write(fds_[1], data.data(), data.size()));
+  }
+
+  int fds_[2];
+  TestConnFactory* factory_;
+  pink::ServerThread* server_;
+  pink::WorkerThread* worker_;
+};
+
+}  // namespace
+
+TEST_P(WorkerThreadReplyTest, OneReplyPerCommand) {
+  const int kCommands = 1000;
+  std::string input = Repeat(kCommand, kCommands);
+  // Reads that end inside of commands
+  for (size_t pos = 0; pos < input.size(); pos += 777) {
+    Send(input.substr(pos, 777));
+  }
+  std::string expected = Repeat(kOk, kCommands);
+  EXPECT_EQ(expected, ReadReplies(fds_[1], expected.size() + 1));
+}
+
+TEST_P(WorkerThreadReplyTest, ContinuedReply) {
+  if (GetParam() != pink::kAsynchronous) {
+    return;
+  }
+  Send("*2\r\n$4\r\nCONT\r\n$1\r\n2\r\n");
+  std::string expected = std::string(kOk) + kPart + kPart;
+  EXPECT_EQ(expected, ReadReplies(fds_[1], expected.size() + 1));
+
+  // The connection is read again once the reply is done
+  Send(kCommand);
+  EXPECT_EQ(kOk, ReadReplies(fds_[1], strlen(kOk) + 1));
+}
+
+TEST_P(WorkerThreadReplyTest, NotClosedWhileAwaitingReply) {
+  if (GetParam() != pink::kAsynchronous) {
+    return;
+  }
+  worker_->set_keepalive_timeout(1);
+  // Idle for longer than the keepalive timeout while it is handed off
+  Send("*2\r\n$4\r\nSLOW\r\n$4\r\n3000\r\n");
+  struct pollfd pfd = {fds_[1], POLLIN, 0};
+  ASSERT_EQ(1, poll(&pfd, 1, 5000));
+  EXPECT_EQ(kOk, ReadReplies(fds_[1], strlen(kOk) + 1));
+}
+
+INSTANTIATE_TEST_CASE_P(HandleTypes, WorkerThreadReplyTest,
+                        ::testing::Values(pink::kSynchronous,
+                                          pink::kAsynchronous,
+                                          pink::kPipelined));
@@ -0,0 +1,352 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pink/include/redis_parser.h"
+
+#include <string.h>
+
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "pink/src/resp_scan.h"
+#include "slash/include/slash_string.h"
+
+namespace {
+
+struct ParsedCommands {
+  std::vector<pink::RedisCmdArgsType> dealt;
+  std::vector<pink::RedisCmdArgsType> completed;
+};
+
+pink::RedisCmdArgsType ToStrings(const pink::RedisCmdArgsViewType& argv) {
+  return pink::RedisCmdArgsType(argv.begin(), argv.end());
+}
+
+int DealMessageView(pink::RedisParser* parser,
+                    const pink::RedisCmdArgsViewType& argv) {
+  static_cast<ParsedCommands*>(parser->data)->dealt.push_back(ToStrings(argv));
+  return 0;
+}
+
+int CompleteView(pink::RedisParser* parser,
+                 const std::vector<pink::RedisCmdArgsViewType>& argvs) {
+  ParsedCommands* parsed = static_cast<ParsedCommands*>(parser->data);
+  for (const auto& argv : argvs) {
+    parsed->completed.push_back(ToStrings(argv));
+  }
+  return 0;
+}
+
+class RedisParserInPlaceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pink::RedisParserSettings settings;
+    settings.DealMessageView = DealMessageView;
+    settings.CompleteView = CompleteView;
+    parser_.RedisParserInit(REDIS_PARSER_REQUEST, settings);
+    parser_.data = &parsed_;
+  }
+
+  pink::RedisParser parser_;
+  ParsedCommands parsed_;
+};
+
+}  // namespace
+
+TEST_F(RedisParserInPlaceTest, WholeCommands) {
+  std::string input = "*3\r\n$3\r\nSET\r\n$1\r\na\r\n$2\r\nab\r\n"
+                      "*2\r\n$3\r\nGET\r\n$1\r\na\r\n";
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserDone,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(static_cast<int>(input.size()), parsed_len);
+  ASSERT_EQ(2u, parsed_.completed.size());
+  EXPECT_EQ(pink::RedisCmdArgsType({"SET", "a", "ab"}), parsed_.completed[0]);
+  EXPECT_EQ(pink::RedisCmdArgsType({"GET", "a"}), parsed_.completed[1]);
+  EXPECT_EQ(parsed_.completed, parsed_.dealt);
+}
+
+TEST_F(RedisParserInPlaceTest, CommandSplitAcrossReads) {
+  std::string input = "*2\r\n$3\r\nGET\r\n$1\r\na\r\n"
+                      "*3\r\n$3\r\nSET\r\n$3\r\nabc\r\n$10\r\n01234";
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  // The complete command is passed on, the incomplete one is kept
+  EXPECT_EQ(20, parsed_len);
+  ASSERT_EQ(1u, parsed_.completed.size());
+  EXPECT_EQ(pink::RedisCmdArgsType({"GET", "a"}), parsed_.completed[0]);
+
+  // Moving the input must not matter, the parser only keeps offsets
+  std::string moved_input = input.substr(parsed_len) + "56789\r\n";
+  EXPECT_EQ(pink::kRedisParserDone,
+            parser_.ProcessInputBufferInPlace(moved_input.data(),
+                                              moved_input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(static_cast<int>(moved_input.size()), parsed_len);
+  ASSERT_EQ(2u, parsed_.completed.size());
+  EXPECT_EQ(pink::RedisCmdArgsType({"GET", "a"}), parsed_.completed[0]);
+  EXPECT_EQ(pink::RedisCmdArgsType({"SET", "abc", "0123456789"}),
+            parsed_.completed[1]);
+  EXPECT_EQ(parsed_.completed, parsed_.dealt);
+}
+
+TEST_F(RedisParserInPlaceTest, CommandsBeforeHalfCommandCompleted) {
+  const int kCommands = 100;
+  std::string command = "*3\r\n$3\r\nSET\r\n$1\r\nk\r\n$5\r\nvalue\r\n";
+  std::string input;
+  for (int i = 0; i < kCommands; i++) {
+    input += command;
+  }
+  input += command.substr(0, command.size() / 2);
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(static_cast<int>(command.size()) * kCommands, parsed_len);
+  EXPECT_EQ(static_cast<size_t>(kCommands), parsed_.completed.size());
+
+  // The same again after a read that still ends inside a command
+  input = input.substr(parsed_len) + command.substr(command.size() / 2) +
+          command + command.substr(0, 3);
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(static_cast<int>(command.size()) * 2, parsed_len);
+
+  input = input.substr(parsed_len) + command.substr(3);
+  EXPECT_EQ(pink::kRedisParserDone,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  ASSERT_EQ(static_cast<size_t>(kCommands) + 3, parsed_.completed.size());
+  for (const auto& argv : parsed_.completed) {
+    EXPECT_EQ(pink::RedisCmdArgsType({"SET", "k", "value"}), argv);
+  }
+  EXPECT_EQ(parsed_.completed, parsed_.dealt);
+}
+
+TEST_F(RedisParserInPlaceTest, SplitInLengthHeader) {
+  std::string input = "*2\r\n$3\r\nGET\r\n$1";
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  input += "0\r\n0123456789\r\n";
+  EXPECT_EQ(pink::kRedisParserDone,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  ASSERT_EQ(1u, parsed_.completed.size());
+  EXPECT_EQ(pink::RedisCmdArgsType({"GET", "0123456789"}),
+            parsed_.completed[0]);
+}
+
+TEST_F(RedisParserInPlaceTest, InlineCommand) {
+  std::string input = "SET key \"a\\x41b\"\r\n";
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserDone,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  ASSERT_EQ(1u, parsed_.completed.size());
+  EXPECT_EQ(pink::RedisCmdArgsType({"SET", "key", "aAb"}),
+            parsed_.completed[0]);
+}
+
+TEST_F(RedisParserInPlaceTest, BulkEnd) {
+  std::string input = "*2\r\n$3\r\nGET\r\n$10\r\n0123";
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  // 18 bytes of headers, 10 bytes of payload and \r\n
+  EXPECT_EQ(30, parser_.get_bulk_end());
+}
+
+namespace {
+
+struct StreamedCommands {
+  ParsedCommands parsed;
+  bool accept = true;
+  std::vector<pink::RedisCmdArgsType> started;
+  std::vector<long> bulk_lens;
+  std::vector<std::string> chunks;
+  std::vector<bool> last_flags;
+};
+
+int StreamDealMessageView(pink::RedisParser* parser,
+                          const pink::RedisCmdArgsViewType& argv) {
+  StreamedCommands* streamed = static_cast<StreamedCommands*>(parser->data);
+  streamed->parsed.dealt.push_back(ToStrings(argv));
+  return 0;
+}
+
+int StreamCompleteView(pink::RedisParser* parser,
+                       const std::vector<pink::RedisCmdArgsViewType>& argvs) {
+  StreamedCommands* streamed = static_cast<StreamedCommands*>(parser->data);
+  for (const auto& argv : argvs) {
+    streamed->parsed.completed.push_back(ToStrings(argv));
+  }
+  return 0;
+}
+
+bool StartBulkStream(pink::RedisParser* parser,
+                     const pink::RedisCmdArgsViewType& leading_args,
+                     long bulk_len) {
+  StreamedCommands* streamed = static_cast<StreamedCommands*>(parser->data);
+  streamed->started.push_back(ToStrings(leading_args));
+  streamed->bulk_lens.push_back(bulk_len);
+  return streamed->accept;
+}
+
+int DealBulkChunk(pink::RedisParser* parser, std::string_view chunk,
+                  bool last) {
+  StreamedCommands* streamed = static_cast<StreamedCommands*>(parser->data);
+  streamed->chunks.emplace_back(chunk);
+  streamed->last_flags.push_back(last);
+  return 0;
+}
+
+class RedisParserBulkStreamTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    pink::RedisParserSettings settings;
+    settings.DealMessageView = StreamDealMessageView;
+    settings.CompleteView = StreamCompleteView;
+    settings.StartBulkStream = StartBulkStream;
+    settings.DealBulkChunk = DealBulkChunk;
+    parser_.RedisParserInit(REDIS_PARSER_REQUEST, settings);
+    parser_.set_bulk_stream_threshold(10);
+    parser_.data = &streamed_;
+  }
+
+  pink::RedisParser parser_;
+  StreamedCommands streamed_;
+};
+
+}  // namespace
+
+TEST_F(RedisParserBulkStreamTest, ArgumentStreamedAcrossReads) {
+  std::string input = "*3\r\n$3\r\nSET\r\n$1\r\nk\r\n$20\r\n0123456789";
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  // Everything was streamed or copied, the input can be dropped
+  EXPECT_EQ(static_cast<int>(input.size()), parsed_len);
+  ASSERT_EQ(1u, streamed_.started.size());
+  EXPECT_EQ(pink::RedisCmdArgsType({"SET", "k"}), streamed_.started[0]);
+  EXPECT_EQ(std::vector<long>({20}), streamed_.bulk_lens);
+  EXPECT_EQ(-1, parser_.get_bulk_end());
+
+  // The \r of the end of the argument is kept for the next call
+  input = "abcdefghij\r";
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(10, parsed_len);
+  EXPECT_TRUE(streamed_.parsed.completed.empty());
+
+  input = "\r\n*2\r\n$3\r\nGET\r\n$1\r\nk\r\n";
+  EXPECT_EQ(pink::kRedisParserDone,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(static_cast<int>(input.size()), parsed_len);
+  EXPECT_EQ(std::vector<std::string>({"0123456789", "abcdefghij"}),
+            streamed_.chunks);
+  EXPECT_EQ(std::vector<bool>({false, true}), streamed_.last_flags);
+  ASSERT_EQ(2u, streamed_.parsed.completed.size());
+  EXPECT_EQ(pink::RedisCmdArgsType({"SET", "k", ""}),
+            streamed_.parsed.completed[0]);
+  EXPECT_EQ(pink::RedisCmdArgsType({"GET", "k"}),
+            streamed_.parsed.completed[1]);
+  EXPECT_EQ(streamed_.parsed.completed, streamed_.parsed.dealt);
+}
+
+TEST_F(RedisParserBulkStreamTest, OnlyFirstCommandStreamed) {
+  std::string input = "*2\r\n$3\r\nGET\r\n$1\r\na\r\n"
+                      "*3\r\n$3\r\nSET\r\n$1\r\nk\r\n$20\r\n0123456789";
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(20, parsed_len);
+  EXPECT_TRUE(streamed_.started.empty());
+  EXPECT_EQ(static_cast<long>(input.size()) - 20 + 12,
+            parser_.get_bulk_end());
+}
+
+TEST_F(RedisParserBulkStreamTest, DeclinedArgumentKeptInInput) {
+  streamed_.accept = false;
+  std::string input = "*3\r\n$3\r\nSET\r\n$1\r\nk\r\n$20\r\n0123456789";
+  int parsed_len = -1;
+  EXPECT_EQ(pink::kRedisParserHalf,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(0, parsed_len);
+  input += "abcdefghij\r\n";
+  EXPECT_EQ(pink::kRedisParserDone,
+            parser_.ProcessInputBufferInPlace(input.data(), input.size(),
+                                              &parsed_len));
+  EXPECT_EQ(std::vector<long>({20}), streamed_.bulk_lens);
+  EXPECT_TRUE(streamed_.chunks.empty());
+  ASSERT_EQ(1u, streamed_.parsed.completed.size());
+  EXPECT_EQ(pink::RedisCmdArgsType({"SET", "k", "0123456789abcdefghij"}),
+            streamed_.parsed.completed[0]);
+}
+
+namespace {
+
+const pink::RespScanKernel kKernels[] = {
+  pink::kRespScanScalar, pink::kRespScanSSE42, pink::kRespScanAVX2
+};
+
+}  // namespace
+
+TEST(RespScanTest, KernelsAgree) {
+  // Delimiters at every offset around the 16 and 32 byte block edges
+  const char delimiters[] = {'\n', ' ', '\t', '\r', '\0', '"', '\''};
+  pink::RespScanKernel original = pink::GetRespScanKernel();
+  for (pink::RespScanKernel kernel : kKernels) {
+    pink::SetRespScanKernel(kernel);
+    for (int len = 0; len < 70; len++) {
+      for (char delimiter : delimiters) {
+        for (int at = 0; at <= len; at++) {
+          std::string buf(len, 'x');
+          if (at < len) {
+            buf[at] = delimiter;
+          }
+          const char* begin = buf.data();
+          const char* end = begin + len;
+          const char* expected_lf =
+            (at < len && delimiter == '\n') ? begin + at : end;
+          EXPECT_EQ(expected_lf, pink::FindLineFeed(begin, end));
+          EXPECT_EQ(begin + at, pink::FindInlineDelimiter(begin, end));
+        }
+      }
+    }
+  }
+  pink::SetRespScanKernel(original);
+}
+
+TEST(RespScanTest, ParseRespLength) {
+  const char* valid[] = {"0", "3", "10", "512", "-1", "-0",
+                         "123456789012345678", "9223372036854775807"};
+  const char* invalid[] = {"", "3a", "a3", "03", " 3", "+3",
+                           "9223372036854775808"};
+  for (const char* s : valid) {
+    long value = 0;
+    long expected = 0;
+    ASSERT_TRUE(slash::string2l(s, strlen(s), &expected)) << s;
+    EXPECT_EQ(0, pink::ParseRespLength(s, strlen(s), &value)) << s;
+    EXPECT_EQ(expected, value) << s;
+  }
+  for (const char* s : invalid) {
+    long value = 0;
+    EXPECT_EQ(slash::string2l(s, strlen(s), &value) ? 0 : -1,
+              pink::ParseRespLength(s, strlen(s), &value)) << s;
+  }
+}
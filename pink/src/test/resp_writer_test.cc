@@ -0,0 +1,123 @@
+// Copyright (c) 2015-present, Qihoo, Inc.  All rights reserved.
+// This source code is licensed under the BSD-style license found in the
+// LICENSE file in the root directory of this source tree. An additional grant
+// of patent rights can be found in the PATENTS file in the same directory.
+
+#include "pink/include/resp_writer.h"
+
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "gmock/gmock.h"
+
+namespace {
+
+class RespWriterTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ASSERT_EQ(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds_));
+    ASSERT_EQ(0, fcntl(fds_[0], F_SETFL, O_NONBLOCK));
+  }
+
+  void TearDown() override {
+    close(fds_[0]);
+    close(fds_[1]);
+  }
+
+  std::string ReadAll(size_t len) {
+    std::string result(len, '\0');
+    size_t pos = 0;
+    while (pos < len) {
+      ssize_t nread = read(fds_[1], &result[pos], len - pos);
+      if (nread <= 0) {
+        break;
+      }
+      pos += nread;
+    }
+    result.resize(pos);
+    return result;
+  }
+
+  int fds_[2];
+  pink::RespWriter writer_;
+};
+
+}  // namespace
+
+TEST_F(RespWriterTest, Formatting) {
+  writer_.AppendArrayHeader(3);
+  writer_.AppendInteger(-42);
+  writer_.AppendBulk("abc");
+  writer_.Append("+OK\r\n");
+  writer_.buffer()->append("$-1\r\n");
+  std::string expected = "*3\r\n:-42\r\n$3\r\nabc\r\n+OK\r\n$-1\r\n";
+  EXPECT_EQ(expected.size(), writer_.size());
+  EXPECT_EQ(pink::kWriteAll, writer_.Flush(fds_[0]));
+  EXPECT_TRUE(writer_.empty());
+  EXPECT_EQ(expected, ReadAll(expected.size()));
+}
+
+TEST_F(RespWriterTest, ReferencedSegmentsKeepOrder) {
+  auto payload = std::make_shared<std::string>(5000, 'p');
+  writer_.AppendBulkHeader(payload->size() * 2);
+  writer_.AppendRef(payload->data(), 3000);
+  writer_.AppendRef(payload->data() + 3000, 2000);
+  writer_.AppendRef(payload->data(), payload->size());
+  writer_.Retain(payload);
+  writer_.Append("\r\n");
+  std::string expected = "$10000\r\n" + std::string(10000, 'p') + "\r\n";
+
+  // Moving the reply keeps the references and the owner
+  pink::RespWriter pipelined;
+  pipelined.Append(":1\r\n");
+  pipelined.Append(&writer_);
+  EXPECT_TRUE(writer_.empty());
+  std::weak_ptr<std::string> weak_payload = payload;
+  payload.reset();
+  EXPECT_FALSE(weak_payload.expired());
+
+  EXPECT_EQ(expected.size() + 4, pipelined.size());
+  EXPECT_EQ(pink::kWriteAll, pipelined.Flush(fds_[0]));
+  EXPECT_TRUE(weak_payload.expired());
+  EXPECT_EQ(":1\r\n" + expected, ReadAll(expected.size() + 4));
+}
+
+TEST_F(RespWriterTest, PartialWrites) {
+  int sndbuf = 4096;
+  ASSERT_EQ(0, setsockopt(fds_[0], SOL_SOCKET, SO_SNDBUF, &sndbuf,
+                          sizeof(sndbuf)));
+  std::string payload(1 << 20, 'x');
+  for (size_t i = 0; i < payload.size(); i++) {
+    payload[i] = 'a' + i % 26;
+  }
+  for (int i = 0; i < 8; i++) {
+    writer_.AppendBulkHeader(payload.size() / 8);
+    writer_.AppendRef(payload.data() + i * payload.size() / 8,
+                      payload.size() / 8);
+    writer_.Append("\r\n");
+  }
+  size_t total_len = writer_.size();
+
+  std::string received;
+  pink::WriteStatus status;
+  while ((status = writer_.Flush(fds_[0])) == pink::kWriteHalf) {
+    char buf[65536];
+    ssize_t nread = read(fds_[1], buf, sizeof(buf));
+    ASSERT_GT(nread, 0);
+    received.append(buf, nread);
+  }
+  EXPECT_EQ(pink::kWriteAll, status);
+  received += ReadAll(total_len - received.size());
+
+  std::string expected;
+  for (int i = 0; i < 8; i++) {
+    expected += "$131072\r\n" +
+                payload.substr(i * payload.size() / 8, payload.size() / 8) +
+                "\r\n";
+  }
+  EXPECT_EQ(expected, received);
+}
@@ -10,19 +10,25 @@
 #include "pink/include/pink_conn.h"
 #include "pink/src/pink_item.h"
 #include "pink/src/pink_epoll.h"
+#include "pink/src/server_socket.h"
 
 namespace pink {
 
 
 WorkerThread::WorkerThread(ConnFactory *conn_factory,
                            ServerThread* server_thread,
-                           int queue_limit_,
+                           int queue_limit,
                            int cron_interval)
       : private_data_(nullptr),
         server_thread_(server_thread),
         conn_factory_(conn_factory),
         cron_interval_(cron_interval),
-        keepalive_timeout_(kDefaultKeepAliveTime) {
+        queue_limit_(queue_limit),
+        conn_num_(0),
+        handoff_cv_(&handoff_mu_),
+        handoff_open_(false),
+        keepalive_timeout_(kDefaultKeepAliveTime),
+        batch_wait_us_(0) {
   /*
    * install the protobuf handler here
    */
@@ -30,60 +36,157 @@ WorkerThread::WorkerThread(ConnFactory *conn_factory,
 }
 
 WorkerThread::~WorkerThread() {
+  CloseListeners();
   delete(pink_epoll_);
 }
 
+void WorkerThread::set_poll_backend(PollBackend backend) {
+  delete(pink_epoll_);
+  pink_epoll_ = new PinkEpoll(queue_limit_, backend);
+}
+
 int WorkerThread::conn_num() const {
-  slash::ReadLock l(&rwlock_);
-  return conns_.size();
+  return conn_num_.load();
 }
 
 std::vector<ServerThread::ConnInfo> WorkerThread::conns_info() const {
   std::vector<ServerThread::ConnInfo> result;
   slash::ReadLock l(&rwlock_);
   for (auto& conn : conns_) {
+    if (conn == nullptr) {
+      continue;
+    }
     result.push_back({
-                      conn.first,
-                      conn.second->ip_port(),
-                      conn.second->last_interaction()
+                      conn->fd(),
+                      conn->ip_port(),
+                      conn->last_interaction()
                      });
   }
   return result;
 }
 
-std::shared_ptr<PinkConn> WorkerThread::MoveConnOut(int fd) {
+bool WorkerThread::InWorkerThread() {
+  return is_running() && pthread_equal(pthread_self(), thread_id());
+}
+
+void WorkerThread::InsertConn(const std::shared_ptr<PinkConn>& conn) {
   slash::WriteLock l(&rwlock_);
-  std::shared_ptr<PinkConn> conn = nullptr;
-  auto iter = conns_.find(fd);
-  if (iter != conns_.end()) {
-    int fd = iter->first;
-    conn = iter->second;
-    pink_epoll_->PinkDelEvent(fd, 0);
-    conns_.erase(iter);
+  if (static_cast<size_t>(conn->fd()) >= conns_.size()) {
+    conns_.resize(conn->fd() + 1);
+  }
+  if (conns_[conn->fd()] == nullptr) {
+    conn_num_++;
+  }
+  conns_[conn->fd()] = conn;
+}
+
+std::shared_ptr<PinkConn> WorkerThread::EraseConn(int fd) {
+  std::shared_ptr<PinkConn> conn;
+  slash::WriteLock l(&rwlock_);
+  if (static_cast<size_t>(fd) < conns_.size() && conns_[fd] != nullptr) {
+    conn = std::move(conns_[fd]);
+    conn_num_--;
   }
   return conn;
 }
 
+/*
+ * From the worker thread itself the connection stays in conns_ until the
+ * event that is handled is done with it. Other threads wait until the
+ * worker thread has handed it out.
+ */
+std::shared_ptr<PinkConn> WorkerThread::MoveConnOut(int fd) {
+  if (InWorkerThread()) {
+    if (static_cast<size_t>(fd) >= conns_.size() || conns_[fd] == nullptr) {
+      return nullptr;
+    }
+    pink_epoll_->PinkDelEvent(fd, 0);
+    moved_out_.push_back({fd, conns_[fd].get()});
+    return conns_[fd];
+  }
+
+  {
+    slash::ReadLock l(&rwlock_);
+    if (static_cast<size_t>(fd) >= conns_.size() || conns_[fd] == nullptr) {
+      return nullptr;
+    }
+  }
+  slash::MutexLock l(&handoff_mu_);
+  if (!handoff_open_) {
+    std::shared_ptr<PinkConn> conn = EraseConn(fd);
+    if (conn != nullptr) {
+      pink_epoll_->PinkDelEvent(fd, 0);
+    }
+    return conn;
+  }
+  MoveOutRequest request = {fd, false, nullptr};
+  move_out_requests_.push_back(&request);
+  pink_epoll_->Register(PinkItem(fd, "", kNotiHandoff), true);
+  while (!request.done) {
+    handoff_cv_.Wait();
+  }
+  return request.conn;
+}
+
 bool WorkerThread::MoveConnIn(std::shared_ptr<PinkConn> conn, const NotifyType& notify_type, bool force) {
   PinkItem it(conn->fd(), conn->ip_port(), notify_type);
+  slash::MutexLock l(&handoff_mu_);
+  if (!handoff_open_) {
+    bool success = MoveConnIn(it, force);
+    if (success) {
+      InsertConn(conn);
+    }
+    return success;
+  }
+  incoming_conns_.push_back(conn);
   bool success = MoveConnIn(it, force);
-  if (success) {
-    slash::WriteLock l(&rwlock_);
-    conns_[conn->fd()] = conn;
+  if (!success) {
+    incoming_conns_.pop_back();
   }
   return success;
 }
 
+// Serves what other threads handed over, see MoveConnIn and MoveConnOut
+void WorkerThread::ProcessHandoffs() {
+  slash::MutexLock l(&handoff_mu_);
+  for (const auto& conn : incoming_conns_) {
+    InsertConn(conn);
+  }
+  incoming_conns_.clear();
+  if (move_out_requests_.empty()) {
+    return;
+  }
+  for (MoveOutRequest* request : move_out_requests_) {
+    request->conn = EraseConn(request->fd);
+    if (request->conn != nullptr) {
+      pink_epoll_->PinkDelEvent(request->fd, 0);
+    }
+    request->done = true;
+  }
+  move_out_requests_.clear();
+  handoff_cv_.SignalAll();
+}
+
+void WorkerThread::ReleaseMovedOut() {
+  for (const auto& moved : moved_out_) {
+    if (static_cast<size_t>(moved.first) < conns_.size() &&
+        conns_[moved.first].get() == moved.second) {
+      EraseConn(moved.first);
+    }
+  }
+  moved_out_.clear();
+}
+
 bool WorkerThread::MoveConnIn(const PinkItem& it, bool force) {
   return pink_epoll_->Register(it, force);
 }
 
 void *WorkerThread::ThreadMain() {
   int nfds;
-  PinkFiredEvent *pfe = NULL;
-  char bb[2048];
-  PinkItem ti;
-  std::shared_ptr<PinkConn> in_conn = nullptr;
+  {
+    slash::MutexLock l(&handoff_mu_);
+    handoff_open_ = true;
+  }
 
   struct timeval when;
   gettimeofday(&when, NULL);
@@ -113,122 +216,272 @@ void *WorkerThread::ThreadMain() {
 
     nfds = pink_epoll_->PinkPoll(timeout);
 
-    for (int i = 0; i < nfds; i++) {
-      pfe = (pink_epoll_->firedevent()) + i;
-      if (pfe->fd == pink_epoll_->notify_receive_fd()) {
-        if (pfe->mask & PinkEpoll::kRead) {
-          int32_t nread = read(pink_epoll_->notify_receive_fd(), bb, 2048);
-          if (nread == 0) {
-            continue;
-          } else if (nread == -1) {
-            log_warn("Read error on notify_receive_fd for fd");
-            continue;
-          } else {
-            for (int32_t idx = 0; idx < nread; ++idx) {
-              PinkItem ti = pink_epoll_->notify_queue_pop();
-              if (ti.notify_type() == kNotiConnect) {
-                std::shared_ptr<PinkConn> tc = conn_factory_->NewPinkConn(
-                    ti.fd(), ti.ip_port(),
-                    server_thread_, private_data_, pink_epoll_);
-                if (!tc || !tc->SetNonblock()) {
-                  continue;
-                }
+    HandleFiredEvents(nfds, now);
+
+    if (nfds > 1 && batch_wait_us_ > 0) {
+      WaitForBatch(now);
+    }
+    server_thread_->handle_->WorkerBatchHandle(private_data_);
+    FlushPendingReplies();
+  }  // while (!should_stop())
+
+  Cleanup();
+  return NULL;
+}
+
+int WorkerThread::Listen(const std::set<std::string>& ips, int port) {
+  for (const auto& ip : ips) {
+    ServerSocket* socket_p = new ServerSocket(port);
+    server_sockets_.push_back(socket_p);
+    socket_p->set_reuse_port(true);
+    int ret = socket_p->Listen(ip);
+    if (ret != kSuccess) {
+      return ret;
+    }
+    pink_epoll_->PinkAddEvent(
+        socket_p->sockfd(), PinkEpoll::kRead | PinkEpoll::kError);
+    listen_fds_.insert(socket_p->sockfd());
+  }
+  return kSuccess;
+}
+
+void WorkerThread::CloseListeners() {
+  for (auto socket_p : server_sockets_) {
+    delete socket_p;
+  }
+  server_sockets_.clear();
+  listen_fds_.clear();
+}
+
+void WorkerThread::AddConn(int fd, const std::string& ip_port) {
+  std::shared_ptr<PinkConn> tc = conn_factory_->NewPinkConn(
+      fd, ip_port, server_thread_, private_data_, pink_epoll_);
+  if (!tc || !tc->SetNonblock()) {
+    return;
+  }
 
 #ifdef __ENABLE_SSL
-                // Create SSL failed
-                if (server_thread_->security() &&
-                  !tc->CreateSSL(server_thread_->ssl_ctx())) {
-                  CloseFd(tc);
-                  continue;
-                }
+  // Create SSL failed
+  if (server_thread_->security() &&
+    !tc->CreateSSL(server_thread_->ssl_ctx())) {
+    CloseFd(tc);
+    return;
+  }
 #endif
 
-                {
-                  slash::WriteLock l(&rwlock_);
-                  conns_[ti.fd()] = tc;
-                }
-                pink_epoll_->PinkAddEvent(ti.fd(), PinkEpoll::kRead);
-              } else if (ti.notify_type() == kNotiClose) {
-                // should close?
-              } else if (ti.notify_type() == kNotiEpollout) {
-                pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kWrite);
-              } else if (ti.notify_type() == kNotiEpollin) {
-                pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kRead);
-              } else if (ti.notify_type() == kNotiEpolloutAndEpollin) {
-                pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kRead | PinkEpoll::kWrite);
-              } else if (ti.notify_type() == kNotiWait) {
-                // do not register events
-                pink_epoll_->PinkAddEvent(ti.fd(), 0);
-              }
+  InsertConn(tc);
+  pink_epoll_->PinkAddEvent(fd, PinkEpoll::kRead);
+}
+
+void WorkerThread::HandleFiredEvents(int nfds, const struct timeval& now) {
+  PinkFiredEvent *pfe = NULL;
+
+  for (int i = 0; i < nfds; i++) {
+    pfe = (pink_epoll_->firedevent()) + i;
+    if (pfe->fd == pink_epoll_->notify_receive_fd()) {
+      if (pfe->mask & PinkEpoll::kRead) {
+        PinkItem ti;
+        int n = pink_epoll_->ConsumeNotify();
+        ProcessHandoffs();
+        for (; n > 0 && pink_epoll_->notify_queue_pop(&ti); n--) {
+          if (ti.notify_type() == kNotiConnect) {
+            AddConn(ti.fd(), ti.ip_port());
+          } else if (ti.notify_type() == kNotiClose) {
+            ResumeAsyncConn(ti.fd(), false);
+          } else if (ti.notify_type() == kNotiEpollout) {
+            pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kWrite);
+          } else if (ti.notify_type() == kNotiEpollin) {
+            pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kRead);
+          } else if (ti.notify_type() == kNotiEpolloutAndEpollin) {
+            if (!ResumeAsyncConn(ti.fd(), true)) {
+              pink_epoll_->PinkModEvent(ti.fd(), 0, PinkEpoll::kRead | PinkEpoll::kWrite);
             }
+          } else if (ti.notify_type() == kNotiWait) {
+            // do not register events
+            pink_epoll_->PinkAddEvent(ti.fd(), 0);
           }
-        } else {
-          continue;
         }
       } else {
-        in_conn = NULL;
-        int should_close = 0;
-        if (pfe == NULL) {
-          continue;
+        continue;
+      }
+    } else if (listen_fds_.find(pfe->fd) != listen_fds_.end()) {
+      if (pfe->mask & PinkEpoll::kRead) {
+        std::string ip_port;
+        int connfd = server_thread_->AcceptConn(pfe->fd, &ip_port);
+        if (connfd != -1) {
+          AddConn(connfd, ip_port);
         }
+      }
+    } else {
+      int should_close = 0;
+      if (pfe == NULL) {
+        continue;
+      }
 
-        {
-          slash::ReadLock l(&rwlock_);
-          std::map<int, std::shared_ptr<PinkConn>>::iterator iter = conns_.find(pfe->fd);
-          if (iter == conns_.end()) {
+      // Valid until the event is handled, see MoveConnOut()
+      if (static_cast<size_t>(pfe->fd) >= conns_.size() ||
+          conns_[pfe->fd] == nullptr) {
+        pink_epoll_->PinkDelEvent(pfe->fd, 0);
+        continue;
+      }
+      const std::shared_ptr<PinkConn>& in_conn = conns_[pfe->fd];
+
+      if (IsPendingReply(pfe->fd) && !(pfe->mask & PinkEpoll::kError)) {
+        continue;
+      }
+
+      if ((pfe->mask & PinkEpoll::kWrite) && in_conn->is_reply()) {
+        WriteStatus write_status = in_conn->SendReply();
+        in_conn->set_last_interaction(now);
+        if (write_status == kWriteAll) {
+          in_conn->set_is_reply(false);
+          if (in_conn->is_awaiting_reply()) {
+            // The reply goes on, see RedisConn::ContinueReply()
             pink_epoll_->PinkDelEvent(pfe->fd, 0);
             continue;
           }
-          in_conn = iter->second;
-        }
-
-        if ((pfe->mask & PinkEpoll::kWrite) && in_conn->is_reply()) {
-          WriteStatus write_status = in_conn->SendReply();
-          in_conn->set_last_interaction(now);
-          if (write_status == kWriteAll) {
-            pink_epoll_->PinkModEvent(pfe->fd, 0, PinkEpoll::kRead);
-            in_conn->set_is_reply(false);
-            if (in_conn->IsClose()) {
-              // If the application wants to close the connection
-              should_close = 1;
-            }
-          } else if (write_status == kWriteHalf) {
-            continue;
-          } else {
+          pink_epoll_->PinkModEvent(pfe->fd, 0, PinkEpoll::kRead);
+          if (in_conn->IsClose()) {
+            // If the application wants to close the connection
             should_close = 1;
           }
+        } else if (write_status == kWriteHalf) {
+          continue;
+        } else {
+          should_close = 1;
         }
+      }
 
-        if (!should_close && (pfe->mask & PinkEpoll::kRead)) {
-          ReadStatus read_status = in_conn->GetRequest();
-          in_conn->set_last_interaction(now);
-          if (read_status == kReadAll) {
-            pink_epoll_->PinkModEvent(pfe->fd, 0, PinkEpoll::kWrite);
-            // Wait for the conn complete asynchronous task and
-            // Mod Event to EPOLLOUT
-          } else if (read_status == kReadHalf) {
-            continue;
+      if (!should_close && (pfe->mask & PinkEpoll::kRead)) {
+        ReadStatus read_status = in_conn->GetRequest();
+        in_conn->set_last_interaction(now);
+        if (read_status == kReadAll) {
+          if (in_conn->is_reply()) {
+            should_close = !TrySendReply(in_conn);
           } else {
-            should_close = 1;
+            // The reply is deferred to WorkerBatchHandle or an async task
+            if (static_cast<size_t>(pfe->fd) >= pending_reply_fds_.size()) {
+              pending_reply_fds_.resize(pfe->fd + 1);
+            }
+            pending_reply_fds_[pfe->fd] = true;
+            pending_replies_.push_back(in_conn);
           }
+        } else if (read_status == kReadHalf) {
+          continue;
+        } else {
+          should_close = 1;
         }
+      }
 
-        if ((pfe->mask & PinkEpoll::kError) || should_close) {
-          pink_epoll_->PinkDelEvent(pfe->fd, 0);
-          CloseFd(in_conn);
-          in_conn = NULL;
-          {
-            slash::WriteLock l(&rwlock_);
-            conns_.erase(pfe->fd);
-          }
-          should_close = 0;
-        }
-      }  // connection event
-    }  // for (int i = 0; i < nfds; i++)
-  }  // while (!should_stop())
+      if ((pfe->mask & PinkEpoll::kError) || should_close) {
+        CloseFd(EraseConn(pfe->fd));
+        should_close = 0;
+      }
+    }  // connection event
+  }  // for (int i = 0; i < nfds; i++)
+  ReleaseMovedOut();
+}
 
-  Cleanup();
-  return NULL;
+/*
+ * Keep polling without blocking until batch_wait_us_ has passed, so that
+ * requests arriving on other connections in the meantime are handled
+ * before WorkerBatchHandle is invoked.
+ */
+void WorkerThread::WaitForBatch(const struct timeval& now) {
+  struct timeval deadline;
+  gettimeofday(&deadline, NULL);
+  deadline.tv_usec += batch_wait_us_;
+  deadline.tv_sec += deadline.tv_usec / 1000000;
+  deadline.tv_usec %= 1000000;
+
+  struct timeval current = deadline;
+  do {
+    int nfds = pink_epoll_->PinkPoll(0);
+    HandleFiredEvents(nfds, now);
+    gettimeofday(&current, NULL);
+  } while (!should_stop() &&
+           (current.tv_sec < deadline.tv_sec ||
+            (current.tv_sec == deadline.tv_sec &&
+             current.tv_usec < deadline.tv_usec)));
+}
+
+bool WorkerThread::IsPendingReply(int fd) const {
+  return static_cast<size_t>(fd) < pending_reply_fds_.size() &&
+         pending_reply_fds_[fd];
+}
+
+/*
+ * Writes the reply right away instead of waiting for EPOLLOUT, which is
+ * only armed if the socket cannot take the whole reply. Returns false if
+ * the connection should be closed.
+ */
+bool WorkerThread::TrySendReply(const std::shared_ptr<PinkConn>& conn) {
+  WriteStatus write_status = conn->SendReply();
+  if (write_status == kWriteAll) {
+    conn->set_is_reply(false);
+    if (conn->is_awaiting_reply()) {
+      // The reply goes on, not polled until ResumeAsyncConn()
+      pink_epoll_->PinkDelEvent(conn->fd(), 0);
+      return true;
+    }
+    // If the application wants to close the connection
+    return !conn->IsClose();
+  } else if (write_status == kWriteHalf) {
+    pink_epoll_->PinkModEvent(conn->fd(), 0, PinkEpoll::kWrite);
+    return true;
+  }
+  return false;
+}
+
+void WorkerThread::FlushPendingReplies() {
+  // Moved out in WorkerBatchHandle
+  ReleaseMovedOut();
+  for (const auto& conn : pending_replies_) {
+    pending_reply_fds_[conn->fd()] = false;
+    if (static_cast<size_t>(conn->fd()) >= conns_.size() ||
+        conns_[conn->fd()] != conn) {
+      // Closed or moved out in the meantime
+      continue;
+    }
+    if (conn->is_awaiting_reply()) {
+      // Not polled until ResumeAsyncConn()
+      pink_epoll_->PinkDelEvent(conn->fd(), 0);
+    } else if (!conn->is_reply()) {
+      // Wait for the conn complete asynchronous task
+      pink_epoll_->PinkModEvent(conn->fd(), 0, PinkEpoll::kWrite);
+    } else if (!TrySendReply(conn)) {
+      CloseFd(EraseConn(conn->fd()));
+    }
+  }
+  pending_replies_.clear();
+}
+
+/*
+ * Called when the thread that executed the commands of a connection in
+ * kAsynchronous mode notifies that its reply is ready. Returns false if
+ * the connection is not waiting for one.
+ */
+bool WorkerThread::ResumeAsyncConn(int fd, bool success) {
+  if (static_cast<size_t>(fd) >= conns_.size() || conns_[fd] == nullptr ||
+      !conns_[fd]->is_awaiting_reply()) {
+    return false;
+  }
+  std::shared_ptr<PinkConn> conn = conns_[fd];
+  conn->set_is_awaiting_reply(false);
+  if (success && IsPendingReply(fd)) {
+    // Notified before it was parked, FlushPendingReplies() sends the reply
+    conn->set_is_reply(true);
+    return true;
+  }
+  if (success) {
+    pink_epoll_->PinkAddEvent(fd, PinkEpoll::kRead);
+    conn->set_is_reply(true);
+    if (TrySendReply(conn)) {
+      return true;
+    }
+  }
+  CloseFd(EraseConn(fd));
+  return true;
 }
 
 void WorkerThread::DoCronTask() {
@@ -241,38 +494,40 @@ void WorkerThread::DoCronTask() {
 
     // Check whether close all connection
     slash::MutexLock kl(&killer_mutex_);
-    if (deleting_conn_ipport_.count(kKillAllConnsTask)) {
-      for (auto& conn : conns_) {
-        to_close.push_back(conn.second);
-      }
-      conns_.clear();
+    bool kill_all = deleting_conn_ipport_.count(kKillAllConnsTask) > 0;
+    if (kill_all) {
       deleting_conn_ipport_.clear();
-      return;
     }
 
-    std::map<int, std::shared_ptr<PinkConn>>::iterator iter = conns_.begin();
-    while (iter != conns_.end()) {
-      std::shared_ptr<PinkConn> conn = iter->second;
+    for (auto& conn : conns_) {
+      if (conn == nullptr) {
+        continue;
+      }
+      if (conn->is_awaiting_reply()) {
+        // Its buffers are in use, it is closed once its reply is sent
+        if (kill_all || deleting_conn_ipport_.erase(conn->ip_port())) {
+          conn->SetClose(true);
+        }
+        continue;
+      }
       // Check connection should be closed
-      if (deleting_conn_ipport_.count(conn->ip_port())) {
-        to_close.push_back(conn);
+      if (kill_all || deleting_conn_ipport_.count(conn->ip_port())) {
         deleting_conn_ipport_.erase(conn->ip_port());
-        iter = conns_.erase(iter);
+        to_close.push_back(std::move(conn));
+        conn_num_--;
         continue;
       }
 
       // Check keepalive timeout connection
       if (keepalive_timeout_ > 0 &&
           (now.tv_sec - conn->last_interaction().tv_sec > keepalive_timeout_)) {
-        to_timeout.push_back(conn);
-        iter = conns_.erase(iter);
+        to_timeout.push_back(std::move(conn));
+        conn_num_--;
         continue;
       }
 
       // Maybe resize connection buffer
       conn->TryResizeBuffer();
-
-      ++iter;
     }
   }
   for (const auto & conn : to_close) {
@@ -288,8 +543,8 @@ bool WorkerThread::TryKillConn(const std::string& ip_port) {
   bool find = false;
   if (ip_port != kKillAllConnsTask) {
     slash::ReadLock l(&rwlock_);
-    for (auto& iter : conns_) {
-      if (iter.second->ip_port() == ip_port) {
+    for (auto& conn : conns_) {
+      if (conn != nullptr && conn->ip_port() == ip_port) {
         find = true;
         break;
       }
@@ -303,7 +558,9 @@ bool WorkerThread::TryKillConn(const std::string& ip_port) {
   return false;
 }
 
-void WorkerThread::CloseFd(std::shared_ptr<PinkConn> conn) {
+void WorkerThread::CloseFd(const std::shared_ptr<PinkConn>& conn) {
+  // An armed io_uring poll would keep the socket open after close()
+  pink_epoll_->PinkDelEvent(conn->fd(), 0);
   if (close(conn->fd()) != 0) {
     log_warn("Closing fd failed");
   }
@@ -311,16 +568,25 @@ void WorkerThread::CloseFd(std::shared_ptr<PinkConn> conn) {
 }
 
 void WorkerThread::Cleanup() {
-  std::map<int, std::shared_ptr<PinkConn>> to_close;
+  ReleaseMovedOut();
+  ProcessHandoffs();
+  {
+    slash::MutexLock l(&handoff_mu_);
+    handoff_open_ = false;
+  }
+  std::vector<std::shared_ptr<PinkConn>> to_close;
   {
     slash::WriteLock l(&rwlock_);
     to_close = std::move(conns_);
     conns_.clear();
+    conn_num_ = 0;
   }
-  for (const auto& iter : to_close) {
-    CloseFd(iter.second);
+  for (const auto& conn : to_close) {
+    if (conn != nullptr) {
+      CloseFd(conn);
+    }
   }
-
+  CloseListeners();
 }
 
 };  // namespace pink
@@ -8,7 +8,7 @@
 
 #include <string>
 #include <functional>
-#include <map>
+#include <utility>
 #include <atomic>
 #include <vector>
 #include <set>
@@ -28,11 +28,12 @@ class PinkEpoll;
 struct PinkFiredEvent;
 class PinkConn;
 class ConnFactory;
+class ServerSocket;
 
 class WorkerThread : public Thread {
  public:
   explicit WorkerThread(ConnFactory *conn_factory, ServerThread* server_thread,
-                        int queue_limit_, int cron_interval = 0);
+                        int queue_limit, int cron_interval = 0);
 
   virtual ~WorkerThread();
 
@@ -40,6 +41,19 @@ class WorkerThread : public Thread {
     keepalive_timeout_ = timeout;
   }
 
+  void set_batch_wait_us(int wait_us) {
+    batch_wait_us_ = wait_us;
+  }
+
+  // Replaces pink_epoll(), so only before StartThread()
+  void set_poll_backend(PollBackend backend);
+
+  /*
+   * Listens on own SO_REUSEPORT sockets and accepts the connections
+   * arriving there. Call before StartThread()
+   */
+  int Listen(const std::set<std::string>& ips, int port);
+
   int conn_num() const;
 
   std::vector<ServerThread::ConnInfo> conns_info() const;
@@ -55,8 +69,13 @@ class WorkerThread : public Thread {
   }
   bool TryKillConn(const std::string& ip_port);
 
-  mutable slash::RWMutex rwlock_; /* For external statistics */
-  std::map<int, std::shared_ptr<PinkConn>> conns_;
+  /*
+   * The connections indexed by fd. Only the worker thread changes them,
+   * under rwlock_ for the readers in other threads, and reads them
+   * without locking.
+   */
+  mutable slash::RWMutex rwlock_;
+  std::vector<std::shared_ptr<PinkConn>> conns_;
 
   void* private_data_;
 
@@ -64,7 +83,25 @@ class WorkerThread : public Thread {
   ServerThread* server_thread_;
   ConnFactory *conn_factory_;
   int cron_interval_;
+  int queue_limit_;
+  std::atomic<int> conn_num_;
 
+  /*
+   * Other threads hand connections over here instead of changing conns_,
+   * see MoveConnIn() and MoveConnOut(). Only open while ThreadMain runs.
+   */
+  struct MoveOutRequest {
+    int fd;
+    bool done;
+    std::shared_ptr<PinkConn> conn;
+  };
+  slash::Mutex handoff_mu_;
+  slash::CondVar handoff_cv_;
+  bool handoff_open_;
+  std::vector<std::shared_ptr<PinkConn>> incoming_conns_;
+  std::vector<MoveOutRequest*> move_out_requests_;
+  // Moved out by the worker thread itself, see MoveConnOut()
+  std::vector<std::pair<int, PinkConn*>> moved_out_;
 
   /*
    * The epoll handler
@@ -72,15 +109,42 @@ class WorkerThread : public Thread {
   PinkEpoll *pink_epoll_;
 
   std::atomic<int> keepalive_timeout_;  // keepalive second
+  std::atomic<int> batch_wait_us_;
+
+  /*
+   * Connections whose request was read in this epoll iteration but whose
+   * reply was not ready yet. They are not read again before their reply
+   * is flushed after WorkerBatchHandle(...).
+   */
+  std::vector<std::shared_ptr<PinkConn>> pending_replies_;
+  // Indexed by fd, set for the connections in pending_replies_
+  std::vector<bool> pending_reply_fds_;
+
+  // Own listening sockets, see Listen()
+  std::vector<ServerSocket*> server_sockets_;
+  std::set<int> listen_fds_;
 
   virtual void *ThreadMain() override;
   void DoCronTask();
+  void HandleFiredEvents(int nfds, const struct timeval& now);
+  void AddConn(int fd, const std::string& ip_port);
+  bool InWorkerThread();
+  void InsertConn(const std::shared_ptr<PinkConn>& conn);
+  std::shared_ptr<PinkConn> EraseConn(int fd);
+  void ProcessHandoffs();
+  void ReleaseMovedOut();
+  void CloseListeners();
+  void WaitForBatch(const struct timeval& now);
+  bool IsPendingReply(int fd) const;
+  bool TrySendReply(const std::shared_ptr<PinkConn>& conn);
+  void FlushPendingReplies();
+  bool ResumeAsyncConn(int fd, bool success);
 
   slash::Mutex killer_mutex_;
   std::set<std::string> deleting_conn_ipport_;
 
   // clean conns
-  void CloseFd(std::shared_ptr<PinkConn> conn);
+  void CloseFd(const std::shared_ptr<PinkConn>& conn);
   void Cleanup();
 };  // class WorkerThread
 